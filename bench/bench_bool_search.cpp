@@ -0,0 +1,133 @@
+#include "index/inverted_index.h"
+#include "search/bool_search.h"
+#include "common/utils.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <set>
+
+// Прежний BoolSearch: постинги превращались в std::set на каждый операнд
+static std::vector<int> legacy_search(const InvertedIndex& index,
+                                      const std::vector<std::string>& terms,
+                                      const std::vector<BoolOperator>& operators) {
+    auto doc_ids = index.get_postings(terms[0]);
+    std::set<int> result(doc_ids.begin(), doc_ids.end());
+    
+    for (size_t i = 0; i < operators.size() && i + 1 < terms.size(); ++i) {
+        auto next_docs = index.get_postings(terms[i + 1]);
+        std::set<int> next(next_docs.begin(), next_docs.end());
+        std::set<int> combined;
+        
+        switch (operators[i]) {
+            case BoolOperator::AND:
+                std::set_intersection(result.begin(), result.end(), next.begin(), next.end(),
+                                      std::inserter(combined, combined.begin()));
+                break;
+            case BoolOperator::OR:
+                std::set_union(result.begin(), result.end(), next.begin(), next.end(),
+                               std::inserter(combined, combined.begin()));
+                break;
+            case BoolOperator::NOT:
+                std::set_difference(result.begin(), result.end(), next.begin(), next.end(),
+                                    std::inserter(combined, combined.begin()));
+                break;
+        }
+        result.swap(combined);
+    }
+    return std::vector<int>(result.begin(), result.end());
+}
+
+struct QueryClass {
+    const char* name;
+    std::vector<std::vector<std::string>> queries;
+    BoolOperator op;
+};
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Использование: " << argv[0] << " <index_file> [iterations]" << std::endl;
+        return 1;
+    }
+    
+    int iterations = argc >= 3 ? std::stoi(argv[2]) : 20;
+    
+    InvertedIndex index;
+    if (!index.load_from_file(argv[1])) {
+        return 1;
+    }
+    
+    // Термы по убыванию документной частоты
+    std::vector<std::pair<size_t, std::string>> by_df;
+    for (const auto& entry : index.get_terms()) {
+        by_df.push_back({entry.second.size(), entry.first});
+    }
+    std::sort(by_df.rbegin(), by_df.rend());
+    
+    size_t docs = index.get_documents_count();
+    std::vector<std::string> dense, sparse;
+    for (const auto& term : by_df) {
+        if (term.first * 10 >= docs && dense.size() < 40) dense.push_back(term.second);
+        if (term.first >= 5 && term.first <= 50 && sparse.size() < 40) sparse.push_back(term.second);
+    }
+    if (dense.size() < 2 || sparse.size() < 2) {
+        std::cerr << "Слишком маленький индекс для замера" << std::endl;
+        return 1;
+    }
+    
+    QueryClass classes[] = {
+        {"dense AND dense", {}, BoolOperator::AND},
+        {"dense OR dense", {}, BoolOperator::OR},
+        {"dense NOT dense", {}, BoolOperator::NOT},
+        {"dense AND sparse", {}, BoolOperator::AND},
+        {"sparse OR sparse", {}, BoolOperator::OR},
+    };
+    for (size_t i = 0; i < dense.size(); ++i) {
+        const std::string& next_dense = dense[(i + 1) % dense.size()];
+        classes[0].queries.push_back({dense[i], next_dense});
+        classes[1].queries.push_back({dense[i], next_dense});
+        classes[2].queries.push_back({dense[i], next_dense});
+        classes[3].queries.push_back({dense[i], sparse[i % sparse.size()]});
+    }
+    for (size_t i = 0; i < sparse.size(); ++i) {
+        classes[4].queries.push_back({sparse[i], sparse[(i + 1) % sparse.size()]});
+    }
+    
+    std::cout << "\nДокументов: " << docs << ", плотных термов: " << dense.size()
+              << ", редких: " << sparse.size() << ", итераций: " << iterations << std::endl;
+    std::cout << "мкс на запрос           std::set    roaring   ускорение" << std::endl;
+    
+    BoolSearch search(index);
+    for (const auto& query_class : classes) {
+        std::vector<BoolOperator> operators = {query_class.op};
+        size_t legacy_found = 0, found = 0;
+        
+        utils::Timer timer;
+        for (int it = 0; it < iterations; ++it) {
+            for (const auto& terms : query_class.queries) {
+                legacy_found += legacy_search(index, terms, operators).size();
+            }
+        }
+        double legacy_ms = timer.elapsed_ms();
+        
+        timer.reset();
+        for (int it = 0; it < iterations; ++it) {
+            for (const auto& terms : query_class.queries) {
+                found += search.search_query(terms, operators).doc_ids.size();
+            }
+        }
+        double roaring_ms = timer.elapsed_ms();
+        
+        if (found != legacy_found) {
+            std::cerr << "Расхождение результатов в классе " << query_class.name << std::endl;
+            return 1;
+        }
+        
+        double runs = static_cast<double>(iterations) * query_class.queries.size();
+        double legacy_us = legacy_ms * 1000 / runs;
+        double roaring_us = roaring_ms * 1000 / runs;
+        std::printf("%-22s %10.1f %10.1f %10.1fx\n", query_class.name,
+                    legacy_us, roaring_us, legacy_us / roaring_us);
+    }
+    
+    return 0;
+}
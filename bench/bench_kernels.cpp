@@ -0,0 +1,254 @@
+#include "microbench.h"
+#include "tokenizer/tokenizer.h"
+#include "stemmer/stemmer.h"
+#include "index/inverted_index.h"
+#include "search/bool_search.h"
+#include "common/corpus_format.h"
+#include "common/line_reader.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Замеры горячих функций по отдельности на фикстуре из первых
+// документов stems.txt: токенизатор, стеммер, операции над множествами
+// документов, кодек списков постингов.
+
+namespace {
+
+struct Fixture {
+    std::vector<std::string> lines;
+    std::vector<std::string> words;
+    size_t line_bytes = 0;
+    size_t word_bytes = 0;
+    InvertedIndex index;
+};
+
+bool load_fixture(const std::string& filename, size_t max_docs, Fixture& fixture) {
+    utils::LineReader reader;
+    if (!reader.open(filename)) return false;
+
+    std::string_view line;
+    corpus::TermsView doc;
+    std::vector<std::string> terms;
+    size_t docs = 0;
+    while (docs < max_docs && reader.next(line)) {
+        if (!corpus::parse_terms_line(line, doc)) continue;
+
+        terms.assign(doc.terms.begin(), doc.terms.end());
+        fixture.index.add_document(doc.doc_id, std::string(doc.title), std::string(doc.source), terms);
+
+        std::string text;
+        for (const auto& term : terms) {
+            if (!text.empty()) text += ' ';
+            text += term;
+            fixture.words.push_back(term);
+            fixture.word_bytes += term.size();
+        }
+        fixture.line_bytes += text.size();
+        fixture.lines.push_back(std::move(text));
+        docs++;
+    }
+
+    if (fixture.words.empty()) {
+        std::cerr << "В фикстуре нет документов: " << filename << std::endl;
+        return false;
+    }
+    fixture.index.build_doc_sets();
+    return true;
+}
+
+// Пары термов для операций над множествами: оба частых, частый и
+// редкий, оба редких
+struct TermPairs {
+    std::vector<std::pair<std::string, std::string>> dense_dense;
+    std::vector<std::pair<std::string, std::string>> dense_sparse;
+    std::vector<std::pair<std::string, std::string>> sparse_sparse;
+};
+
+TermPairs make_pairs(const InvertedIndex& index) {
+    std::vector<std::pair<size_t, std::string>> by_df;
+    for (const auto& entry : index.get_terms()) {
+        by_df.push_back({entry.second.size(), entry.first});
+    }
+    std::sort(by_df.rbegin(), by_df.rend());
+
+    size_t docs = index.get_documents_count();
+    std::vector<std::string> dense, sparse;
+    for (const auto& term : by_df) {
+        if (term.first * 10 >= docs && dense.size() < 32) dense.push_back(term.second);
+        if (term.first >= 3 && term.first <= 30 && sparse.size() < 32) sparse.push_back(term.second);
+    }
+
+    TermPairs pairs;
+    for (size_t i = 0; i < dense.size(); ++i) {
+        pairs.dense_dense.push_back({dense[i], dense[(i + 1) % dense.size()]});
+        if (!sparse.empty()) pairs.dense_sparse.push_back({dense[i], sparse[i % sparse.size()]});
+    }
+    for (size_t i = 0; i < sparse.size(); ++i) {
+        pairs.sparse_sparse.push_back({sparse[i], sparse[(i + 1) % sparse.size()]});
+    }
+    return pairs;
+}
+
+void add_set_operations(microbench::Runner& runner, const InvertedIndex& index,
+                        const std::string& name,
+                        const std::vector<std::pair<std::string, std::string>>& pairs) {
+    if (pairs.empty()) return;
+
+    std::vector<std::pair<const RoaringBitmap*, const RoaringBitmap*>> sets;
+    for (const auto& [a, b] : pairs) {
+        sets.push_back({index.get_doc_set(a), index.get_doc_set(b)});
+    }
+
+    runner.add("roaring/intersect/" + name, sets.size(), 0, [sets] {
+        for (const auto& [a, b] : sets) {
+            RoaringBitmap result = RoaringBitmap::intersect(*a, *b);
+            microbench::do_not_optimize(result);
+        }
+    });
+    runner.add("roaring/unite/" + name, sets.size(), 0, [sets] {
+        for (const auto& [a, b] : sets) {
+            RoaringBitmap result = RoaringBitmap::unite(*a, *b);
+            microbench::do_not_optimize(result);
+        }
+    });
+    runner.add("roaring/subtract/" + name, sets.size(), 0, [sets] {
+        for (const auto& [a, b] : sets) {
+            RoaringBitmap result = RoaringBitmap::subtract(*a, *b);
+            microbench::do_not_optimize(result);
+        }
+    });
+    std::vector<std::vector<std::string>> queries;
+    for (const auto& [a, b] : pairs) queries.push_back({a, b});
+    runner.add("search/and/" + name, queries.size(), 0, [&index, queries] {
+        BoolSearch search(index);
+        std::vector<BoolOperator> operators = {BoolOperator::AND};
+        for (const auto& terms : queries) {
+            SearchResult result = search.search_query(terms, operators);
+            microbench::do_not_optimize(result);
+        }
+    });
+}
+
+void print_usage(const char* program) {
+    std::cout << "Использование: " << program << " [фильтр] [опции]" << std::endl;
+    std::cout << "  --fixture FILE     stems.txt для фикстур (data/processed/stems.txt)" << std::endl;
+    std::cout << "  --docs N           документов в фикстуре (1000)" << std::endl;
+    std::cout << "  --repetitions N    повторов замера (5)" << std::endl;
+    std::cout << "  --min-time MS      длительность одного замера (50)" << std::endl;
+    std::cout << "Пример: " << program << " roaring/intersect" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    microbench::Options options;
+    std::string fixture_file = "data/processed/stems.txt";
+    size_t max_docs = 1000;
+
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--fixture") == 0 && has_value) {
+            fixture_file = argv[++i];
+        } else if (std::strcmp(argv[i], "--docs") == 0 && has_value) {
+            max_docs = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--repetitions") == 0 && has_value) {
+            options.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && has_value) {
+            options.min_time_ms = std::atof(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            options.filter = argv[i];
+        }
+    }
+
+    Fixture fixture;
+    if (!load_fixture(fixture_file, max_docs, fixture)) {
+        return 1;
+    }
+    std::cout << "Фикстура: " << fixture.lines.size() << " документов, " << fixture.words.size()
+              << " слов, " << fixture.line_bytes << " байт, термов в индексе: "
+              << fixture.index.get_index_size() << std::endl;
+    std::cout << "Повторов: " << options.repetitions << ", замер не короче "
+              << options.min_time_ms << " мс" << std::endl << std::endl;
+
+    microbench::Runner runner;
+
+    Tokenizer tokenizer;
+    runner.add("tokenizer/tokenize", fixture.lines.size(), fixture.line_bytes, [&] {
+        for (const auto& line : fixture.lines) {
+            auto tokens = tokenizer.tokenize(line);
+            microbench::do_not_optimize(tokens);
+        }
+    });
+    const token_scanner::Backend backends[] = {
+        token_scanner::Backend::SCALAR, token_scanner::Backend::SSE2, token_scanner::Backend::AVX2
+    };
+    for (auto backend : backends) {
+        if (!token_scanner::is_supported(backend)) continue;
+
+        runner.add(std::string("tokenizer/tokenize_view/") + token_scanner::backend_name(backend),
+                   fixture.lines.size(), fixture.line_bytes, [&, backend] {
+            tokenizer.set_backend(backend);
+            for (const auto& line : fixture.lines) {
+                const auto& tokens = tokenizer.tokenize_view(line);
+                microbench::do_not_optimize(tokens.data());
+            }
+        });
+    }
+
+    PorterStemmerRu stemmer;
+    runner.add("stemmer/stem", fixture.words.size(), fixture.word_bytes, [&] {
+        for (const auto& word : fixture.words) {
+            std::string stem = stemmer.stem(word);
+            microbench::do_not_optimize(stem);
+        }
+    });
+    runner.add("stemmer/stem_view", fixture.words.size(), fixture.word_bytes, [&] {
+        for (const auto& word : fixture.words) {
+            std::string_view stem = stemmer.stem_view(word);
+            microbench::do_not_optimize(stem);
+        }
+    });
+
+    TermPairs pairs = make_pairs(fixture.index);
+    add_set_operations(runner, fixture.index, "dense_dense", pairs.dense_dense);
+    add_set_operations(runner, fixture.index, "dense_sparse", pairs.dense_sparse);
+    add_set_operations(runner, fixture.index, "sparse_sparse", pairs.sparse_sparse);
+
+    // Кодек: все списки постингов фикстуры подряд, как в секции термов
+    std::string encoded;
+    size_t postings_total = 0;
+    for (const auto& entry : fixture.index.get_terms()) {
+        posting_codec::encode(encoded, entry.second);
+        postings_total += entry.second.size();
+    }
+    const size_t lists = fixture.index.get_index_size();
+
+    std::string buffer;
+    runner.add("postings/encode", postings_total, encoded.size(), [&] {
+        buffer.clear();
+        for (const auto& entry : fixture.index.get_terms()) {
+            posting_codec::encode(buffer, entry.second);
+        }
+        microbench::do_not_optimize(buffer.data());
+    });
+    runner.add("postings/decode", postings_total, encoded.size(), [&] {
+        const char* p = encoded.data();
+        const char* end = p + encoded.size();
+        std::vector<Posting> postings;
+        for (size_t i = 0; i < lists; ++i) {
+            postings.clear();
+            if (!posting_codec::decode(p, end, postings)) std::abort();
+        }
+        microbench::do_not_optimize(postings);
+    });
+
+    runner.run(options);
+    return 0;
+}
@@ -0,0 +1,472 @@
+#include "index/inverted_index.h"
+#include "search/bool_search.h"
+#include "common/trace.h"
+#include "common/utils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// Сквозной замер конвейера на синтетическом корпусе:
+// gen_corpus -> crawler -> tokenizer -> stemmer -> build_index -> запросы.
+//
+// Каждая стадия — отдельный процесс: время и пиковая память (ru_maxrss
+// из wait4) относятся только к ней. Запросы выполняются в дочернем
+// процессе этой же программы. Результаты пишутся в JSON, чтобы сравнивать
+// версии между собой.
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    std::vector<size_t> sizes = {10000, 100000, 1000000, 10000000};
+    std::string bin_dir;
+    std::string work_dir = "bench_work";
+    std::string output_file = "bench_results.json";
+    int threads = 0;
+    size_t queries = 2000;
+    bool keep = false;
+
+    // Параметры генератора
+    size_t words_per_document = 120;
+    size_t vocabulary = 50000;
+    std::string zipf_exponent = "1.0";
+    std::string latin_share = "0.3";
+    uint64_t seed = 42;
+};
+
+struct StageResult {
+    std::string name;
+    bool ok = false;
+    double seconds = 0;
+    double cpu_seconds = 0;
+    uint64_t input_bytes = 0;
+    uint64_t peak_rss_kb = 0;
+};
+
+struct QueryResult {
+    bool ok = false;
+    double load_seconds = 0;
+    size_t queries = 0;
+    double total_seconds = 0;
+    double p50_us = 0, p90_us = 0, p99_us = 0, p999_us = 0, max_us = 0;
+    uint64_t found = 0;
+    uint64_t peak_rss_kb = 0;
+};
+
+struct RunResult {
+    size_t documents = 0;
+    std::vector<StageResult> stages;
+    QueryResult query;
+};
+
+double seconds_between(const timeval& t) {
+    return t.tv_sec + t.tv_usec / 1e6;
+}
+
+// Ждёт дочерний процесс и забирает его ресурсы. ru_maxrss в Linux — в КБ.
+bool wait_child(pid_t pid, StageResult& result) {
+    int status = 0;
+    rusage usage {};
+    if (wait4(pid, &status, 0, &usage) < 0) {
+        std::perror("wait4");
+        return false;
+    }
+    result.cpu_seconds = seconds_between(usage.ru_utime) + seconds_between(usage.ru_stime);
+    result.peak_rss_kb = static_cast<uint64_t>(usage.ru_maxrss);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Запуск программы в work_dir: там же лежит data/processed для словарей,
+// вывод программы уходит в <name>.log
+bool run_program(const std::string& name, const std::vector<std::string>& args,
+                 const std::string& work_dir, StageResult& result) {
+    result.name = name;
+    std::string log_file = work_dir + "/" + name + ".log";
+
+    std::vector<char*> argv;
+    for (const auto& arg : args) argv.push_back(const_cast<char*>(arg.c_str()));
+    argv.push_back(nullptr);
+
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0) {
+        std::perror("fork");
+        return false;
+    }
+    if (pid == 0) {
+        int log = open(log_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (log >= 0) {
+            dup2(log, STDOUT_FILENO);
+            dup2(log, STDERR_FILENO);
+            close(log);
+        }
+        if (chdir(work_dir.c_str()) == 0) execv(argv[0], argv.data());
+        std::perror(argv[0]);
+        _exit(127);
+    }
+
+    result.ok = wait_child(pid, result);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!result.ok) {
+        std::cerr << "Стадия " << name << " завершилась с ошибкой, см. " << log_file << std::endl;
+    }
+    return result.ok;
+}
+
+std::vector<std::string> pick_terms(const std::vector<std::pair<size_t, std::string>>& by_df,
+                                    size_t min_df, size_t max_df, size_t limit) {
+    std::vector<std::string> terms;
+    for (const auto& [df, term] : by_df) {
+        if (df >= min_df && df <= max_df) terms.push_back(term);
+        if (terms.size() == limit) break;
+    }
+    return terms;
+}
+
+// Набор запросов из словаря индекса: частые, средние и редкие термы
+// в разных сочетаниях. Зерно фиксировано — набор одинаков для всех версий.
+std::vector<std::string> make_queries(const InvertedIndex& index, size_t count, uint64_t seed) {
+    std::vector<std::pair<size_t, std::string>> by_df;
+    for (const auto& entry : index.get_terms()) {
+        by_df.push_back({entry.second.size(), entry.first});
+    }
+    std::sort(by_df.begin(), by_df.end(),
+              [](const auto& a, const auto& b) {
+                  return a.first > b.first || (a.first == b.first && a.second < b.second);
+              });
+
+    size_t docs = std::max<size_t>(index.get_documents_count(), 1);
+    std::vector<std::string> dense = pick_terms(by_df, docs / 20, docs, 100);
+    std::vector<std::string> medium = pick_terms(by_df, docs / 1000 + 2, docs / 20, 1000);
+    std::vector<std::string> sparse = pick_terms(by_df, 1, std::max<size_t>(docs / 1000, 2), 1000);
+    if (dense.empty() || medium.empty() || sparse.empty()) return {};
+
+    std::mt19937_64 rng(seed);
+    auto any = [&](const std::vector<std::string>& terms) -> const std::string& {
+        return terms[rng() % terms.size()];
+    };
+
+    std::vector<std::string> queries;
+    queries.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        switch (i % 6) {
+            case 0: queries.push_back(any(medium)); break;
+            case 1: queries.push_back(any(dense) + " AND " + any(dense)); break;
+            case 2: queries.push_back(any(dense) + " AND " + any(sparse)); break;
+            case 3: queries.push_back(any(medium) + " OR " + any(medium)); break;
+            case 4: queries.push_back(any(dense) + " NOT " + any(medium)); break;
+            case 5: queries.push_back(any(dense) + " AND " + any(medium) + " AND " + any(dense)); break;
+        }
+    }
+    return queries;
+}
+
+// Выполняется в дочернем процессе, результат — одна строка в pipe,
+// сообщения загрузки индекса — в query.log
+void query_child(const std::string& index_file, size_t count, uint64_t seed, int fd) {
+    auto start = std::chrono::steady_clock::now();
+    InvertedIndex index;
+    if (!index.load_from_file(index_file)) _exit(1);
+    double load_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<std::string> queries = make_queries(index, count, seed);
+    if (queries.empty()) {
+        std::cerr << "Слишком маленький индекс для запросов" << std::endl;
+        _exit(1);
+    }
+
+    // Задержки в наносекундах: многие запросы короче микросекунды
+    trace::Histogram latency_ns;
+    BoolSearch search(index);
+    uint64_t found = 0;
+    auto all_start = std::chrono::steady_clock::now();
+    for (const auto& query : queries) {
+        auto query_start = std::chrono::steady_clock::now();
+        found += search.execute_query(query).total_found;
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - query_start).count();
+        latency_ns.record(static_cast<uint64_t>(ns));
+    }
+    double total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - all_start).count();
+
+    std::ostringstream line;
+    line << load_seconds << ' ' << queries.size() << ' ' << total_seconds << ' '
+         << latency_ns.percentile(0.5) / 1000.0 << ' ' << latency_ns.percentile(0.9) / 1000.0 << ' '
+         << latency_ns.percentile(0.99) / 1000.0 << ' ' << latency_ns.percentile(0.999) / 1000.0 << ' '
+         << latency_ns.max() / 1000.0 << ' ' << found << '\n';
+    std::string text = line.str();
+    std::cout.flush();
+    if (write(fd, text.data(), text.size()) != static_cast<ssize_t>(text.size())) _exit(1);
+    _exit(0);
+}
+
+bool run_queries(const std::string& dir, const Options& options, QueryResult& result) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        std::perror("pipe");
+        return false;
+    }
+
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+        std::perror("fork");
+        return false;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        int log = open((dir + "/query.log").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (log >= 0) {
+            dup2(log, STDOUT_FILENO);
+            close(log);
+        }
+        query_child(dir + "/index.bin", options.queries, options.seed, fds[1]);
+    }
+    close(fds[1]);
+
+    std::string text;
+    char buffer[256];
+    ssize_t n;
+    while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) text.append(buffer, n);
+    close(fds[0]);
+
+    StageResult stage;
+    bool exited = wait_child(pid, stage);
+    result.peak_rss_kb = stage.peak_rss_kb;
+
+    std::istringstream in(text);
+    in >> result.load_seconds >> result.queries >> result.total_seconds >> result.p50_us
+       >> result.p90_us >> result.p99_us >> result.p999_us >> result.max_us >> result.found;
+    result.ok = exited && !in.fail();
+    if (!result.ok) std::cerr << "Стадия запросов завершилась с ошибкой" << std::endl;
+    return result.ok;
+}
+
+uint64_t file_size(const std::string& path) {
+    std::error_code error;
+    uint64_t size = fs::file_size(path, error);
+    return error ? 0 : size;
+}
+
+bool run_size(size_t documents, const Options& options, RunResult& run) {
+    run.documents = documents;
+    std::string dir = options.work_dir + "/" + std::to_string(documents);
+    std::error_code error;
+    fs::create_directories(dir + "/data/processed", error);
+    if (error) {
+        std::cerr << "Ошибка создания каталога " << dir << ": " << error.message() << std::endl;
+        return false;
+    }
+    dir = fs::absolute(dir).string();
+
+    std::string threads = std::to_string(options.threads);
+    auto tool = [&](const char* name) { return options.bin_dir + "/" + name; };
+
+    struct Step {
+        const char* name;
+        std::string input;
+        std::vector<std::string> args;
+    };
+    std::vector<Step> steps = {
+        {"gen_corpus", "",
+         {tool("gen_corpus"), "corpus.json", "--docs", std::to_string(documents),
+          "--words", std::to_string(options.words_per_document),
+          "--vocabulary", std::to_string(options.vocabulary),
+          "--zipf", options.zipf_exponent, "--latin", options.latin_share,
+          "--seed", std::to_string(options.seed)}},
+        {"crawler", "corpus.json", {tool("crawler"), "corpus.json", "corpus.txt", "--threads", threads}},
+        {"tokenizer", "corpus.txt", {tool("tokenizer"), "corpus.txt", "tokens.txt", "--threads", threads}},
+        {"stemmer", "tokens.txt", {tool("stemmer"), "tokens.txt", "stems.txt", "--threads", threads}},
+        {"build_index", "stems.txt", {tool("build_index"), "stems.txt", "index.bin", "--threads", threads}},
+    };
+
+    std::cout << "\n=== " << documents << " документов ===" << std::endl;
+    for (const auto& step : steps) {
+        StageResult stage;
+        if (!run_program(step.name, step.args, dir, stage)) return false;
+        // Для генератора "вход" — записанный им корпус
+        stage.input_bytes = file_size(dir + "/" + (step.input.empty() ? "corpus.json" : step.input));
+
+        double mb = stage.input_bytes / (1024.0 * 1024.0);
+        std::printf("%-12s %8.2f с  %8.1f МБ/с  %10.0f док/с  %8.1f МБ RSS\n", step.name,
+                    stage.seconds, mb / stage.seconds, documents / stage.seconds,
+                    stage.peak_rss_kb / 1024.0);
+        run.stages.push_back(stage);
+    }
+
+    if (!run_queries(dir, options, run.query)) return false;
+    const QueryResult& q = run.query;
+    std::printf("%-12s %8.2f с загрузка, %zu запросов: p50 %.1f мкс, p99 %.1f мкс, max %.1f мкс, %.1f МБ RSS\n",
+                "query", q.load_seconds, q.queries, q.p50_us, q.p99_us, q.max_us, q.peak_rss_kb / 1024.0);
+
+    if (!options.keep) fs::remove_all(dir, error);
+    return true;
+}
+
+void write_results(const Options& options, const std::vector<RunResult>& runs, std::ostream& out) {
+    out << "{\n";
+    out << "  \"threads\": " << options.threads << ",\n";
+    out << "  \"generator\": {\"words_per_document\": " << options.words_per_document
+        << ", \"vocabulary\": " << options.vocabulary << ", \"zipf\": " << options.zipf_exponent
+        << ", \"latin\": " << options.latin_share << ", \"seed\": " << options.seed << "},\n";
+    out << "  \"runs\": [";
+
+    for (size_t r = 0; r < runs.size(); ++r) {
+        const RunResult& run = runs[r];
+        out << (r ? ",\n" : "\n") << "    {\n";
+        out << "      \"documents\": " << run.documents << ",\n";
+        out << "      \"stages\": {";
+        for (size_t s = 0; s < run.stages.size(); ++s) {
+            const StageResult& stage = run.stages[s];
+            double seconds = std::max(stage.seconds, 1e-9);
+            out << (s ? ",\n" : "\n") << "        \"" << stage.name << "\": {"
+                << "\"seconds\": " << stage.seconds
+                << ", \"cpu_seconds\": " << stage.cpu_seconds
+                << ", \"input_bytes\": " << stage.input_bytes
+                << ", \"mb_per_s\": " << stage.input_bytes / (1024.0 * 1024.0) / seconds
+                << ", \"docs_per_s\": " << run.documents / seconds
+                << ", \"peak_rss_mb\": " << stage.peak_rss_kb / 1024.0 << "}";
+        }
+        out << "\n      },\n";
+
+        const QueryResult& q = run.query;
+        out << "      \"query\": {\"load_seconds\": " << q.load_seconds
+            << ", \"queries\": " << q.queries
+            << ", \"queries_per_s\": " << q.queries / std::max(q.total_seconds, 1e-9)
+            << ", \"p50_us\": " << q.p50_us << ", \"p90_us\": " << q.p90_us
+            << ", \"p99_us\": " << q.p99_us << ", \"p999_us\": " << q.p999_us
+            << ", \"max_us\": " << q.max_us << ", \"found\": " << q.found
+            << ", \"peak_rss_mb\": " << q.peak_rss_kb / 1024.0 << "}\n";
+        out << "    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+// 10000, 10K, 1M
+bool parse_count(const std::string& value, size_t& out) {
+    char* end = nullptr;
+    unsigned long long parsed = std::strtoull(value.c_str(), &end, 10);
+    if (end == value.c_str()) return false;
+    std::string suffix = end;
+    if (suffix == "K" || suffix == "k") {
+        parsed *= 1000;
+    } else if (suffix == "M" || suffix == "m") {
+        parsed *= 1000000;
+    } else if (!suffix.empty()) {
+        return false;
+    }
+    out = static_cast<size_t>(parsed);
+    return out > 0;
+}
+
+std::string executable_dir(const char* argv0) {
+    std::error_code error;
+    fs::path self = fs::read_symlink("/proc/self/exe", error);
+    if (error) self = fs::absolute(argv0);
+    return self.parent_path().string();
+}
+
+void print_usage(const char* program) {
+    std::cout << "Использование: " << program << " [опции]" << std::endl;
+    std::cout << "  --sizes LIST      размеры корпуса через запятую (10K,100K,1M,10M)" << std::endl;
+    std::cout << "  --output FILE     файл результатов JSON (bench_results.json)" << std::endl;
+    std::cout << "  --work-dir DIR    каталог для промежуточных файлов (bench_work)" << std::endl;
+    std::cout << "  --bin-dir DIR     где лежат crawler, tokenizer и остальные (рядом с программой)" << std::endl;
+    std::cout << "  --threads N       потоков для стадий" << std::endl;
+    std::cout << "  --queries N       запросов на размер (2000)" << std::endl;
+    std::cout << "  --words N, --vocabulary N, --zipf S, --latin P, --seed X  параметры gen_corpus" << std::endl;
+    std::cout << "  --keep            не удалять промежуточные файлы" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    options.threads = utils::extract_threads_option(argc, argv, utils::default_thread_count());
+    options.bin_dir = executable_dir(argv[0]);
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        bool ok = true;
+        if (arg == "--sizes" && has_value) {
+            options.sizes.clear();
+            for (const auto& part : utils::split(argv[++i], ',')) {
+                size_t size = 0;
+                ok = ok && parse_count(utils::trim(part), size);
+                options.sizes.push_back(size);
+            }
+        } else if (arg == "--output" && has_value) {
+            options.output_file = argv[++i];
+        } else if (arg == "--work-dir" && has_value) {
+            options.work_dir = argv[++i];
+        } else if (arg == "--bin-dir" && has_value) {
+            options.bin_dir = argv[++i];
+        } else if (arg == "--queries" && has_value) {
+            ok = parse_count(argv[++i], options.queries);
+        } else if (arg == "--words" && has_value) {
+            ok = parse_count(argv[++i], options.words_per_document);
+        } else if (arg == "--vocabulary" && has_value) {
+            ok = parse_count(argv[++i], options.vocabulary);
+        } else if (arg == "--zipf" && has_value) {
+            options.zipf_exponent = argv[++i];
+        } else if (arg == "--latin" && has_value) {
+            options.latin_share = argv[++i];
+        } else if (arg == "--seed" && has_value) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--keep") {
+            options.keep = true;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+        if (!ok) {
+            std::cerr << "Некорректное значение: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    for (const char* name : {"gen_corpus", "crawler", "tokenizer", "stemmer", "build_index"}) {
+        std::string path = options.bin_dir + "/" + name;
+        if (access(path.c_str(), X_OK) != 0) {
+            std::cerr << "Не найдена программа " << path << " (укажите --bin-dir)" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "Потоков: " << options.threads << ", запросов на размер: " << options.queries << std::endl;
+
+    std::vector<RunResult> runs;
+    bool ok = true;
+    for (size_t documents : options.sizes) {
+        RunResult run;
+        if (!run_size(documents, options, run)) {
+            ok = false;
+            break;
+        }
+        runs.push_back(run);
+    }
+
+    std::ofstream out(options.output_file);
+    if (!out.is_open()) {
+        std::cerr << "Ошибка создания файла: " << options.output_file << std::endl;
+        return 1;
+    }
+    write_results(options, runs, out);
+    std::cout << "\nРезультаты сохранены: " << options.output_file << std::endl;
+    return ok ? 0 : 1;
+}
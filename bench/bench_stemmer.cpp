@@ -0,0 +1,154 @@
+#include "stemmer/stemmer.h"
+#include "common/utils.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <set>
+
+// Прежняя реализация PorterStemmerRu: копия списка окончаний и сортировка
+// на каждый вызов remove_ending, поиск RV по однобайтовым строкам.
+// С fixed_rv гласные ищутся по двухбайтовым последовательностям, чтобы
+// старый алгоритм доходил до снятия окончаний и сравнение было честным.
+class LegacyStemmerRu {
+private:
+    std::set<std::string> vowels = {"а", "е", "и", "о", "у", "ы", "э", "ю", "я"};
+    std::vector<std::string> perfectiveground = {"в", "вши", "вшись"};
+    std::vector<std::string> reflexive = {"ся", "сь"};
+    std::vector<std::string> adjective = {"ее", "ие", "ые", "ое", "ими", "ыми", "ей", "ий", "ый", "ой",
+                                          "ем", "им", "ым", "ом", "его", "ого", "ему", "ому", "их", "ых",
+                                          "ую", "юю", "ая", "яя", "ою", "ею"};
+    std::vector<std::string> participle = {"ивш", "ывш", "ующ"};
+    std::vector<std::string> verb = {"ла", "на", "ете", "йте", "ли", "й", "л", "ем", "н", "ло", "но",
+                                     "ет", "ют", "ны", "ть", "ешь", "нно"};
+    std::vector<std::string> noun = {"а", "ев", "ов", "ие", "ье", "е", "иями", "ями", "ами", "еи", "ии",
+                                     "и", "ией", "ей", "ой", "ий", "й", "иям", "ям", "ием", "ем", "ам",
+                                     "ом", "о", "у", "ах", "иях", "ях", "ы", "ь", "ию", "ью", "ю", "ия",
+                                     "ья", "я"};
+    std::vector<std::string> derivational = {"ост", "ость"};
+    bool fixed_rv;
+    
+    bool ends_with(const std::string& str, const std::string& suffix) const {
+        if (suffix.length() > str.length()) return false;
+        return str.compare(str.length() - suffix.length(), suffix.length(), suffix) == 0;
+    }
+    
+    bool remove_ending(std::string& word, const std::vector<std::string>& endings) {
+        std::vector<std::string> sorted_endings = endings;
+        std::sort(sorted_endings.begin(), sorted_endings.end(),
+                  [](const std::string& a, const std::string& b) {
+                      return a.length() > b.length();
+                  });
+        for (const auto& ending : sorted_endings) {
+            if (ends_with(word, ending)) {
+                word = word.substr(0, word.length() - ending.length());
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    size_t find_rv(const std::string& word) const {
+        for (size_t i = 0; i < word.length(); ++i) {
+            size_t width = fixed_rv && static_cast<unsigned char>(word[i]) >= 0xC0 ? 2 : 1;
+            std::string ch = word.substr(i, width);
+            if (vowels.find(ch) != vowels.end()) {
+                return i + width;
+            }
+            i += width - 1;
+        }
+        return word.length();
+    }
+    
+public:
+    explicit LegacyStemmerRu(bool fixed) : fixed_rv(fixed) {}
+    
+    std::string stem(const std::string& word) {
+        if (word.length() < 3) return word;
+        std::string w = utils::to_lower(word);
+        size_t rv_pos = find_rv(w);
+        if (rv_pos >= w.length()) return w;
+        
+        std::string rv = w.substr(rv_pos);
+        std::string stem_word = w.substr(0, rv_pos);
+        
+        if (remove_ending(rv, perfectiveground)) return stem_word + rv;
+        remove_ending(rv, reflexive);
+        if (remove_ending(rv, adjective)) {
+            remove_ending(rv, participle);
+        } else if (!remove_ending(rv, verb)) {
+            remove_ending(rv, noun);
+        }
+        if (ends_with(rv, "и")) rv = rv.substr(0, rv.length() - 1);
+        remove_ending(rv, derivational);
+        if (ends_with(rv, "ь")) rv = rv.substr(0, rv.length() - 1);
+        if (ends_with(rv, "нн")) rv = rv.substr(0, rv.length() - 1);
+        return stem_word + rv;
+    }
+};
+
+// Частые слова из объявлений — кириллицы в data/processed нет
+static const char* RUSSIAN_WORDS[] = {
+    "автомобиль", "автомобили", "машина", "машины", "пробег", "пробегом", "состояние",
+    "состоянии", "хорошем", "отличном", "продаётся", "продается", "владелец", "владельца",
+    "коробка", "автоматическая", "механическая", "двигатель", "двигателя", "литров",
+    "комплектация", "комплектации", "кожаный", "салон", "салона", "зимние", "летние",
+    "колёса", "резина", "обслуживание", "обслуживался", "дилера", "вложений", "требует",
+    "красивейший", "переднеприводный", "полноприводный", "кондиционер", "подогрев", "сидений"
+};
+
+static volatile size_t benchmark_sink;
+
+template <typename F>
+static double tokens_per_second(const std::vector<std::string>& tokens, int iterations, F stem) {
+    size_t checksum = 0;
+    utils::Timer timer;
+    for (int it = 0; it < iterations; ++it) {
+        for (const auto& token : tokens) {
+            checksum += stem(token).size();
+        }
+    }
+    double ms = timer.elapsed_ms();
+    benchmark_sink = checksum;
+    return tokens.size() * static_cast<double>(iterations) / (ms / 1000.0);
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc >= 3 ? std::stoi(argv[2]) : 20;
+    
+    std::vector<std::string> russian;
+    for (int r = 0; r < 2500; ++r) {
+        for (const char* w : RUSSIAN_WORDS) russian.push_back(w);
+    }
+    
+    std::vector<std::string> corpus;
+    if (argc >= 2) {
+        std::ifstream in(argv[1]);
+        std::string line;
+        while (std::getline(in, line)) {
+            auto parts = utils::split(line, '|');
+            if (parts.size() < 4) continue;
+            for (auto& token : utils::split(parts[3], ' ')) corpus.push_back(token);
+        }
+    }
+    
+    LegacyStemmerRu legacy(false);
+    LegacyStemmerRu legacy_fixed(true);
+    PorterStemmerRu current;
+    
+    std::cout << "Кириллица (" << russian.size() << " токенов, итераций: " << iterations << "):" << std::endl;
+    std::cout << "  legacy:            " << tokens_per_second(russian, iterations,
+        [&](const std::string& t) { return legacy.stem(t); }) << " токенов/с" << std::endl;
+    std::cout << "  legacy (fixed RV): " << tokens_per_second(russian, iterations,
+        [&](const std::string& t) { return legacy_fixed.stem(t); }) << " токенов/с" << std::endl;
+    std::cout << "  suffix trie:       " << tokens_per_second(russian, iterations,
+        [&](const std::string& t) { return current.stem(t); }) << " токенов/с" << std::endl;
+    
+    if (!corpus.empty()) {
+        Stemmer stemmer;
+        std::cout << "Корпус " << argv[1] << " (" << corpus.size() << " токенов, Stemmer::stem_token):" << std::endl;
+        std::cout << "  " << tokens_per_second(corpus, 1,
+            [&](const std::string& t) { return stemmer.stem_token(t); }) << " токенов/с" << std::endl;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "tokenizer/tokenizer.h"
+#include "common/utils.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cctype>
+
+// Прежняя побайтовая реализация Tokenizer::tokenize — точка отсчёта
+static std::vector<std::string> legacy_tokenize(const std::string& text) {
+    std::vector<std::string> tokens;
+    std::string current_token;
+    
+    for (size_t i = 0; i < text.length(); ++i) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        
+        if (std::isalnum(c) || c == '-' || c == '\'' || c >= 0xC0) {
+            current_token += std::tolower(c);
+        } else {
+            if (current_token.length() >= 2) {
+                tokens.push_back(current_token);
+            }
+            current_token.clear();
+        }
+    }
+    
+    if (current_token.length() >= 2) {
+        tokens.push_back(current_token);
+    }
+    
+    return tokens;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Использование: " << argv[0] << " <text_file> [iterations]" << std::endl;
+        return 1;
+    }
+    
+    int iterations = argc >= 3 ? std::stoi(argv[2]) : 5;
+    
+    std::ifstream in(argv[1]);
+    if (!in.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << argv[1] << std::endl;
+        return 1;
+    }
+    
+    std::vector<std::string> lines;
+    size_t total_bytes = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        total_bytes += line.size();
+        lines.push_back(line);
+    }
+    
+    double mb = static_cast<double>(total_bytes) * iterations / (1024.0 * 1024.0);
+    size_t checksum = 0;
+    
+    utils::Timer timer;
+    for (int it = 0; it < iterations; ++it) {
+        for (const auto& l : lines) {
+            checksum += legacy_tokenize(l).size();
+        }
+    }
+    double legacy_ms = timer.elapsed_ms();
+    
+    Tokenizer tokenizer;
+    timer.reset();
+    for (int it = 0; it < iterations; ++it) {
+        for (const auto& l : lines) {
+            checksum += tokenizer.tokenize(l).size();
+        }
+    }
+    double copy_ms = timer.elapsed_ms();
+    
+    std::cout << "Входные данные: " << total_bytes << " байт, " << lines.size()
+              << " строк, итераций: " << iterations << std::endl;
+    std::cout << "legacy tokenize:       " << mb / (legacy_ms / 1000.0) << " MB/s" << std::endl;
+    std::cout << "tokenize (string):     " << mb / (copy_ms / 1000.0) << " MB/s" << std::endl;
+    
+    const token_scanner::Backend backends[] = {
+        token_scanner::Backend::SCALAR, token_scanner::Backend::SSE2, token_scanner::Backend::AVX2
+    };
+    for (auto backend : backends) {
+        if (!token_scanner::is_supported(backend)) continue;
+        
+        tokenizer.set_backend(backend);
+        timer.reset();
+        for (int it = 0; it < iterations; ++it) {
+            for (const auto& l : lines) {
+                checksum += tokenizer.tokenize_view(l).size();
+            }
+        }
+        double view_ms = timer.elapsed_ms();
+        
+        std::string name = std::string("tokenize_view/") + token_scanner::backend_name(backend) + ":";
+        name.resize(23, ' ');
+        std::cout << name << mb / (view_ms / 1000.0) << " MB/s" << std::endl;
+    }
+    std::cout << "(контрольная сумма " << checksum << ")" << std::endl;
+    
+    return 0;
+}
@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Синтетический корпус в формате JSON краулера: словарь из русских и
+// латинских слов, частоты слов по закону Ципфа с заданным показателем.
+// При одинаковых параметрах и seed файл получается одинаковым.
+
+namespace {
+
+struct Options {
+    size_t documents = 10000;
+    size_t words_per_document = 120;
+    size_t vocabulary = 50000;
+    double zipf_exponent = 1.0;
+    double latin_share = 0.3;
+    uint64_t seed = 42;
+};
+
+const char* const CONSONANTS[] = {
+    "б", "в", "г", "д", "ж", "з", "к", "л", "м", "н", "п", "р", "с", "т", "ф", "х", "ц", "ч", "ш"
+};
+const char* const VOWELS[] = {"а", "е", "и", "о", "у", "ы", "я", "ю"};
+// Окончания, чтобы стеммеру было что отрезать
+const char* const ENDINGS[] = {
+    "", "", "а", "ы", "ой", "ами", "ов", "ого", "ая", "ие", "ть", "ет", "ение", "ость", "ский"
+};
+
+template <size_t N>
+const char* pick(const char* const (&items)[N], std::mt19937_64& rng) {
+    return items[rng() % N];
+}
+
+std::string cyrillic_word(std::mt19937_64& rng) {
+    std::string word;
+    size_t syllables = 1 + rng() % 3;
+    for (size_t i = 0; i < syllables; ++i) {
+        word += pick(CONSONANTS, rng);
+        word += pick(VOWELS, rng);
+    }
+    word += pick(CONSONANTS, rng);
+    word += pick(ENDINGS, rng);
+    return word;
+}
+
+std::string latin_word(std::mt19937_64& rng) {
+    std::string word;
+    size_t length = 3 + rng() % 6;
+    for (size_t i = 0; i < length; ++i) {
+        word += static_cast<char>('a' + rng() % 26);
+    }
+    // Изредка — обозначения моделей вроде x5 или a4
+    if (rng() % 8 == 0) word += std::to_string(rng() % 10);
+    return word;
+}
+
+std::vector<std::string> build_vocabulary(const Options& options, std::mt19937_64& rng) {
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> words;
+    words.reserve(options.vocabulary);
+
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    while (words.size() < options.vocabulary) {
+        std::string word = coin(rng) < options.latin_share ? latin_word(rng) : cyrillic_word(rng);
+        if (seen.insert(word).second) words.push_back(std::move(word));
+    }
+    return words;
+}
+
+// Ранг r выпадает с вероятностью, пропорциональной 1 / r^s
+class ZipfSampler {
+private:
+    std::vector<double> cumulative;
+    std::uniform_real_distribution<double> uniform;
+
+public:
+    ZipfSampler(size_t n, double exponent) : cumulative(n) {
+        double total = 0;
+        for (size_t r = 0; r < n; ++r) {
+            total += 1.0 / std::pow(static_cast<double>(r + 1), exponent);
+            cumulative[r] = total;
+        }
+        uniform = std::uniform_real_distribution<double>(0.0, total);
+    }
+
+    size_t sample(std::mt19937_64& rng) {
+        double x = uniform(rng);
+        size_t r = std::upper_bound(cumulative.begin(), cumulative.end(), x) - cumulative.begin();
+        return std::min(r, cumulative.size() - 1);
+    }
+};
+
+// Первая буква в верхний регистр: латиница и кириллица без Ё
+void capitalize(std::string& word) {
+    if (word.empty()) return;
+    unsigned char c = static_cast<unsigned char>(word[0]);
+    if (c >= 'a' && c <= 'z') {
+        word[0] = static_cast<char>(c - 'a' + 'A');
+        return;
+    }
+    if (word.size() < 2 || (c != 0xD0 && c != 0xD1)) return;
+
+    // а-п: D0 B0..BF -> D0 90..9F; р-я: D1 80..8F -> D0 A0..AF
+    unsigned char c1 = static_cast<unsigned char>(word[1]);
+    if (c == 0xD0 && c1 >= 0xB0 && c1 <= 0xBF) {
+        word[1] = static_cast<char>(c1 - 0x20);
+    } else if (c == 0xD1 && c1 >= 0x80 && c1 <= 0x8F) {
+        word[0] = static_cast<char>(0xD0);
+        word[1] = static_cast<char>(c1 + 0x20);
+    }
+}
+
+bool parse_size(const char* value, size_t& out) {
+    char* end = nullptr;
+    unsigned long long parsed = std::strtoull(value, &end, 10);
+    if (end == value || *end != '\0') return false;
+    out = static_cast<size_t>(parsed);
+    return true;
+}
+
+void print_usage(const char* program) {
+    std::cout << "Использование: " << program << " <output_json> [опции]" << std::endl;
+    std::cout << "  --docs N         документов (10000)" << std::endl;
+    std::cout << "  --words N        слов в документе в среднем (120)" << std::endl;
+    std::cout << "  --vocabulary N   размер словаря (50000)" << std::endl;
+    std::cout << "  --zipf S         показатель закона Ципфа (1.0)" << std::endl;
+    std::cout << "  --latin P        доля латинских слов в словаре (0.3)" << std::endl;
+    std::cout << "  --seed X         зерно генератора (42)" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    std::string output_file;
+
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        bool ok = true;
+        if (std::strcmp(argv[i], "--docs") == 0 && has_value) {
+            ok = parse_size(argv[++i], options.documents);
+        } else if (std::strcmp(argv[i], "--words") == 0 && has_value) {
+            ok = parse_size(argv[++i], options.words_per_document);
+        } else if (std::strcmp(argv[i], "--vocabulary") == 0 && has_value) {
+            ok = parse_size(argv[++i], options.vocabulary);
+        } else if (std::strcmp(argv[i], "--zipf") == 0 && has_value) {
+            options.zipf_exponent = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--latin") == 0 && has_value) {
+            options.latin_share = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && has_value) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            output_file = argv[i];
+        }
+        if (!ok) {
+            std::cerr << "Некорректное значение: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    if (output_file.empty() || options.vocabulary == 0 || options.words_per_document < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::ofstream out(output_file);
+    if (!out.is_open()) {
+        std::cerr << "Ошибка создания файла: " << output_file << std::endl;
+        return 1;
+    }
+
+    std::mt19937_64 rng(options.seed);
+    std::vector<std::string> vocabulary = build_vocabulary(options, rng);
+    ZipfSampler sampler(vocabulary.size(), options.zipf_exponent);
+
+    size_t min_words = options.words_per_document / 2;
+    size_t spread = options.words_per_document + 1;
+
+    std::string text;
+    std::string title;
+    std::string word;
+    uint64_t bytes = 0;
+
+    out << "[\n";
+    for (size_t d = 0; d < options.documents; ++d) {
+        size_t length = min_words + rng() % spread;
+        text.clear();
+        title.clear();
+
+        bool sentence_start = true;
+        for (size_t w = 0; w < length; ++w) {
+            word = vocabulary[sampler.sample(rng)];
+            if (w < 3) {
+                if (!title.empty()) title += ' ';
+                std::string title_word = word;
+                capitalize(title_word);
+                title += title_word;
+            }
+            if (sentence_start) capitalize(word);
+            sentence_start = false;
+
+            if (!text.empty()) text += ' ';
+            text += word;
+            if (rng() % 12 == 0) {
+                text += '.';
+                sentence_start = true;
+            } else if (rng() % 10 == 0) {
+                text += ',';
+            }
+        }
+        text += '.';
+
+        out << "  {\"source\": \"synthetic\", \"title\": \"" << title
+            << "\", \"url\": \"http://synthetic/" << d << "\", \"text\": \"" << text << "\"}"
+            << (d + 1 < options.documents ? ",\n" : "\n");
+        bytes += text.size();
+
+        if ((d + 1) % 100000 == 0) {
+            std::cout << "\rСгенерировано документов: " << (d + 1) << std::flush;
+        }
+    }
+    out << "]\n";
+
+    if (options.documents >= 100000) std::cout << std::endl;
+    std::cout << "Корпус: " << options.documents << " документов, "
+              << bytes / (1024 * 1024) << " МБ текста, словарь " << vocabulary.size()
+              << ", s = " << options.zipf_exponent << std::endl;
+    return 0;
+}
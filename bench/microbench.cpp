@@ -0,0 +1,131 @@
+#include "microbench.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+namespace {
+
+std::atomic<uint64_t> allocation_count{0};
+
+}
+
+// Подмена глобальных operator new/delete: только счёт, память из malloc
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace microbench {
+
+namespace {
+
+// Заголовок столбца шириной в символах, а не байтах: printf не знает
+// про UTF-8. Отрицательная ширина — выравнивание влево.
+std::string column(const char* title, int width) {
+    std::string text = title;
+    int chars = 0;
+    for (unsigned char c : text) {
+        if ((c & 0xC0) != 0x80) chars++;
+    }
+    std::string padding(std::max(0, std::abs(width) - chars), ' ');
+    return width < 0 ? text + padding : padding + text;
+}
+
+double now_ns() {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+}
+
+uint64_t allocations() {
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+void Runner::add(const std::string& name, size_t items, size_t bytes, std::function<void()> op) {
+    cases.push_back({name, items, bytes, std::move(op)});
+}
+
+Result Runner::measure(const Case& c, const Options& options) const {
+    // Прогрев: кэши, предсказатель переходов, внутренние буферы операции
+    double warmup_start = now_ns();
+    uint64_t iterations = 0;
+    do {
+        c.op();
+        iterations++;
+    } while (now_ns() - warmup_start < options.min_time_ms * 1e6 / 5);
+
+    double per_op = (now_ns() - warmup_start) / iterations;
+    uint64_t batch = std::max<uint64_t>(1, static_cast<uint64_t>(options.min_time_ms * 1e6 / per_op));
+
+    std::vector<double> samples;
+    uint64_t allocations_before = allocations();
+    for (int r = 0; r < options.repetitions; ++r) {
+        double start = now_ns();
+        for (uint64_t i = 0; i < batch; ++i) {
+            c.op();
+            clobber_memory();
+        }
+        samples.push_back((now_ns() - start) / batch);
+    }
+    uint64_t allocated = allocations() - allocations_before;
+
+    std::sort(samples.begin(), samples.end());
+    Result result;
+    result.name = c.name;
+    result.median_ns = samples[samples.size() / 2];
+    result.min_ns = samples.front();
+    result.max_ns = samples.back();
+    result.ns_per_item = c.items ? result.median_ns / c.items : 0;
+    result.mb_per_s = c.bytes / (1024.0 * 1024.0) / (result.median_ns / 1e9);
+    result.allocations_per_op = static_cast<double>(allocated) / (batch * samples.size());
+    return result;
+}
+
+std::vector<Result> Runner::run(const Options& options) const {
+    std::printf("%s%s%s%s%s%s%s\n", column("замер", -34).c_str(), column("нс/оп", 13).c_str(),
+                column("мин нс/оп", 13).c_str(), column("разброс", 8).c_str(),
+                column("нс/элем", 11).c_str(), column("МБ/с", 10).c_str(),
+                column("выдел./оп", 12).c_str());
+
+    std::vector<Result> results;
+    for (const auto& c : cases) {
+        if (c.name.find(options.filter) == std::string::npos) continue;
+
+        Result r = measure(c, options);
+        char throughput[32] = "-";
+        if (c.bytes) std::snprintf(throughput, sizeof(throughput), "%.1f", r.mb_per_s);
+        std::printf("%-34s %12.0f %12.0f %6.1f%% %10.2f %9s %11.1f\n", r.name.c_str(),
+                    r.median_ns, r.min_ns, 100.0 * (r.max_ns - r.min_ns) / r.median_ns,
+                    r.ns_per_item, throughput, r.allocations_per_op);
+        results.push_back(r);
+    }
+    return results;
+}
+
+}
@@ -0,0 +1,79 @@
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Маленький замер отдельных функций вместо Google Benchmark, которого
+// в дереве нет.
+//
+// Операция — один проход по фикстуре (все строки, все слова, все списки).
+// Сначала прогрев, затем число повторов операции подбирается так, чтобы
+// один замер длился не меньше min_time_ms, и замер повторяется
+// repetitions раз. В отчёте медиана и минимум нс на операцию, нс на
+// элемент, МБ/с и число выделений памяти на операцию: operator new
+// в программе с этим файлом подменён и считает вызовы.
+namespace microbench {
+
+// Значение считается использованным, и компилятор не выбрасывает
+// вычисление
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <typename T>
+inline void do_not_optimize(T& value) {
+    asm volatile("" : "+r,m"(value) : : "memory");
+}
+
+// Все записи в память считаются видимыми
+inline void clobber_memory() {
+    asm volatile("" : : : "memory");
+}
+
+// Число вызовов operator new с начала программы
+uint64_t allocations();
+
+struct Options {
+    std::string filter;
+    int repetitions = 5;
+    double min_time_ms = 50;
+};
+
+struct Result {
+    std::string name;
+    double median_ns = 0;
+    double min_ns = 0;
+    double max_ns = 0;
+    double ns_per_item = 0;
+    double mb_per_s = 0;
+    double allocations_per_op = 0;
+};
+
+class Runner {
+private:
+    struct Case {
+        std::string name;
+        size_t items;
+        size_t bytes;
+        std::function<void()> op;
+    };
+
+    std::vector<Case> cases;
+
+    Result measure(const Case& c, const Options& options) const;
+
+public:
+    // items и bytes — сколько элементов и байт обрабатывает одна операция
+    void add(const std::string& name, size_t items, size_t bytes, std::function<void()> op);
+
+    // Выполняет замеры, чьё имя содержит options.filter, и печатает таблицу
+    std::vector<Result> run(const Options& options) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,539 @@
+#include "index/inverted_index.h"
+#include "search/bool_search.h"
+#include "search/sharded_search.h"
+#include "common/thread_pool.h"
+#include "common/trace.h"
+#include "common/utils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Нагрузочный замер поиска: индекс загружается один раз, затем
+// проигрывается журнал запросов — из файла или сгенерированный по
+// частотам термов.
+//
+// Закрытый цикл (--clients N): N клиентов, каждый отправляет следующий
+// запрос сразу после ответа. Открытый цикл (--qps R): запрос i должен
+// начаться в момент i / R, задержка считается от этого момента, так что
+// очередь из-за медленных запросов тоже попадает в гистограмму.
+//
+// Оглавление шардированного индекса (build_index --shards) тоже
+// принимается: каждый запрос идёт во все шарды параллельно.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string index_file;
+    std::string queries_file;
+    std::string save_queries_file;
+    size_t generate = 10000;
+    int clients = 1;
+    double qps = 0;
+    double duration_s = 0;
+    size_t repeat = 1;
+    size_t slowest = 5;
+    uint64_t seed = 42;
+    bool bigrams = true;
+};
+
+struct Sample {
+    uint32_t query;
+    uint32_t found;
+    uint64_t latency_ns;
+};
+
+// Один интерфейс для обычного индекса и шардов
+class Searcher {
+private:
+    std::unique_ptr<BoolSearch> single;
+    std::unique_ptr<ShardedSearch> sharded;
+
+public:
+    Searcher(const InvertedIndex* index, const ShardedIndex* shards, bool bigrams) {
+        if (shards) {
+            sharded = std::make_unique<ShardedSearch>(*shards);
+            sharded->set_bigrams(bigrams);
+        } else {
+            single = std::make_unique<BoolSearch>(*index);
+            single->set_bigrams(bigrams);
+        }
+    }
+
+    SearchResult execute_query(const std::string& query) {
+        return sharded ? sharded->execute_query(query) : single->execute_query(query);
+    }
+
+    SearchResult search_parsed(const ParsedQuery& query, QueryExplain* explain) {
+        return sharded ? sharded->search_parsed(query, 0, explain) : single->search_parsed(query, explain);
+    }
+
+    // Замеры шардов последнего запроса; пусто для обычного индекса
+    const std::vector<ShardTiming>& shard_timings() const {
+        static const std::vector<ShardTiming> none;
+        return sharded ? sharded->last_timings() : none;
+    }
+};
+
+// Суммы по шардам за весь прогон
+struct ShardTotals {
+    std::vector<double> time_ms;
+    double slowest_ms = 0;
+    uint64_t queries = 0;
+
+    void add(const std::vector<ShardTiming>& timings) {
+        if (timings.empty()) return;
+        time_ms.resize(timings.size(), 0);
+        double slowest = 0;
+        for (size_t i = 0; i < timings.size(); ++i) {
+            time_ms[i] += timings[i].time_ms;
+            slowest = std::max(slowest, timings[i].time_ms);
+        }
+        slowest_ms += slowest;
+        queries++;
+    }
+
+    void merge(const ShardTotals& other) {
+        time_ms.resize(std::max(time_ms.size(), other.time_ms.size()), 0);
+        for (size_t i = 0; i < other.time_ms.size(); ++i) time_ms[i] += other.time_ms[i];
+        slowest_ms += other.slowest_ms;
+        queries += other.queries;
+    }
+};
+
+// Класс запроса для разбивки задержек
+std::string query_class(const ParsedQuery& query) {
+    for (const auto& operand : query.operands) {
+        if (operand.is_phrase()) return "phrase";
+    }
+    if (query.operators.empty()) return "term";
+    switch (query.operators[0]) {
+        case BoolOperator::AND: return "AND";
+        case BoolOperator::OR: return "OR";
+        case BoolOperator::NOT: return "NOT";
+    }
+    return "term";
+}
+
+// Генератор журнала: термы выбираются с вероятностью, пропорциональной
+// документной частоте, фразы — подряд идущие термы случайных документов
+class QueryGenerator {
+private:
+    std::vector<const std::string*> terms;
+    std::vector<double> cumulative_df;
+    // Восстановленные тексты выборки документов: терм на каждой позиции
+    std::vector<std::vector<const std::string*>> sample_docs;
+    std::mt19937_64 rng;
+
+    const std::string& any_term() {
+        std::uniform_real_distribution<double> uniform(0.0, cumulative_df.back());
+        size_t i = std::upper_bound(cumulative_df.begin(), cumulative_df.end(), uniform(rng)) -
+                   cumulative_df.begin();
+        return *terms[std::min(i, terms.size() - 1)];
+    }
+
+    std::string phrase() {
+        for (int attempt = 0; attempt < 16 && !sample_docs.empty(); ++attempt) {
+            const auto& doc = sample_docs[rng() % sample_docs.size()];
+            size_t length = rng() % 10 < 7 ? 2 : 3;
+            if (doc.size() < length) continue;
+
+            size_t start = rng() % (doc.size() - length + 1);
+            std::string text = "\"";
+            bool complete = true;
+            for (size_t i = 0; i < length; ++i) {
+                complete = doc[start + i] != nullptr;
+                if (!complete) break;
+                if (i > 0) text += ' ';
+                text += *doc[start + i];
+            }
+            if (complete) return text + "\"";
+        }
+        return any_term();
+    }
+
+public:
+    QueryGenerator(const InvertedIndex& index, uint64_t seed) : rng(seed) {
+        double total = 0;
+        for (const auto& entry : index.get_terms()) {
+            total += entry.second.size();
+            terms.push_back(&entry.first);
+            cumulative_df.push_back(total);
+        }
+
+        // Около 256 документов: отбор по хешу номера, чтобы не нужен был
+        // список всех номеров
+        size_t docs = index.get_documents_count();
+        uint64_t stride = std::max<uint64_t>(1, docs / 256);
+        std::map<int, size_t> slot;
+        for (const auto& entry : index.get_terms()) {
+            for (const auto& posting : entry.second) {
+                uint64_t h = static_cast<uint32_t>(posting.doc_id) * 0x9E3779B97F4A7C15ull;
+                if ((h >> 32) % stride != 0) continue;
+
+                auto it = slot.emplace(posting.doc_id, sample_docs.size()).first;
+                if (it->second == sample_docs.size()) sample_docs.emplace_back();
+                auto& doc = sample_docs[it->second];
+                for (int position : posting.positions) {
+                    if (position < 0) continue;
+                    if (static_cast<size_t>(position) >= doc.size()) doc.resize(position + 1, nullptr);
+                    doc[position] = &entry.first;
+                }
+            }
+        }
+    }
+
+    bool empty() const { return terms.empty(); }
+
+    // Смесь: 30% одиночных термов, 25% AND, 15% OR, 10% NOT, 20% фраз
+    std::string next() {
+        unsigned r = rng() % 100;
+        if (r < 30) return any_term();
+        if (r < 55) return any_term() + " AND " + any_term();
+        if (r < 70) return any_term() + " OR " + any_term();
+        if (r < 80) return any_term() + " NOT " + any_term();
+        return phrase();
+    }
+};
+
+bool read_queries(const std::string& filename, std::vector<std::string>& queries) {
+    std::ifstream in(filename);
+    if (!in.is_open()) {
+        std::cerr << "Ошибка открытия файла: " << filename << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        line = utils::trim(line);
+        if (!line.empty() && line[0] != '#') queries.push_back(line);
+    }
+    return true;
+}
+
+// Выполняет запросы и возвращает замеры всех клиентов
+std::vector<Sample> run_load(const InvertedIndex* index, const ShardedIndex* shards,
+                             const std::vector<std::string>& queries, const Options& options,
+                             double& elapsed_s, ShardTotals& shard_totals) {
+    uint64_t total = options.duration_s > 0 ? UINT64_MAX : queries.size() * options.repeat;
+    if (options.qps > 0 && options.duration_s > 0) {
+        total = static_cast<uint64_t>(options.qps * options.duration_s);
+    }
+    const auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options.duration_s > 0 ? options.duration_s : 1e9));
+
+    std::atomic<uint64_t> next{0};
+    std::vector<std::vector<Sample>> samples(options.clients);
+    std::vector<ShardTotals> totals(options.clients);
+    const auto start = Clock::now();
+
+    auto client = [&](int id) {
+        trace::set_thread_name("client-" + std::to_string(id));
+        Searcher search(index, shards, options.bigrams);
+        auto& local = samples[id];
+        while (true) {
+            uint64_t i = next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= total) break;
+
+            Clock::time_point begin = Clock::now();
+            if (options.qps > 0) {
+                // Время отправки по расписанию, даже если клиент опоздал
+                Clock::time_point scheduled = start + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(i / options.qps));
+                // Сон просыпается с опозданием в десятки микросекунд, поэтому
+                // последние 200 мкс ждём, уступая процессор
+                if (scheduled - begin > std::chrono::microseconds(200)) {
+                    std::this_thread::sleep_until(scheduled - std::chrono::microseconds(200));
+                }
+                while (Clock::now() < scheduled) std::this_thread::yield();
+                begin = scheduled;
+            }
+            if (begin > deadline) break;
+
+            uint32_t query = static_cast<uint32_t>(i % queries.size());
+            SearchResult result = search.execute_query(queries[query]);
+            uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count();
+            local.push_back({query, static_cast<uint32_t>(result.total_found), ns});
+            totals[id].add(search.shard_timings());
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int c = 1; c < options.clients; ++c) threads.emplace_back(client, c);
+    client(0);
+    for (auto& t : threads) t.join();
+    elapsed_s = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<Sample> all;
+    for (auto& local : samples) all.insert(all.end(), local.begin(), local.end());
+    for (const auto& t : totals) shard_totals.merge(t);
+    return all;
+}
+
+double us(uint64_t ns) {
+    return ns / 1000.0;
+}
+
+void print_percentiles(const char* label, const trace::Histogram& h) {
+    std::printf("%-8s %8llu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", label,
+                static_cast<unsigned long long>(h.count()), us(h.sum()) / std::max<uint64_t>(h.count(), 1),
+                us(h.percentile(0.5)), us(h.percentile(0.9)), us(h.percentile(0.99)),
+                us(h.percentile(0.999)), us(h.max()));
+}
+
+void print_report(const InvertedIndex* index, const ShardedIndex* shards,
+                  const std::vector<std::string>& queries, const std::vector<ParsedQuery>& parsed,
+                  std::vector<Sample>& samples, const ShardTotals& shard_totals,
+                  double elapsed_s, const Options& options) {
+    trace::Histogram latency;
+    std::map<std::string, std::unique_ptr<trace::Histogram>> by_class;
+    for (const auto& s : samples) {
+        latency.record(s.latency_ns);
+        auto& h = by_class[query_class(parsed[s.query])];
+        if (!h) h = std::make_unique<trace::Histogram>();
+        h->record(s.latency_ns);
+    }
+
+    std::cout << "\nВыполнено запросов: " << samples.size() << " за " << elapsed_s << " с, "
+              << samples.size() / elapsed_s << " запросов/с";
+    if (options.qps > 0) std::cout << " (цель " << options.qps << ")";
+    std::cout << std::endl;
+
+    std::cout << "\nЗадержка, мкс" << std::endl;
+    std::cout << "класс      число    среднее        p50        p90        p99      p99.9        max" << std::endl;
+    print_percentiles("все", latency);
+    for (const auto& [name, h] : by_class) print_percentiles(name.c_str(), *h);
+
+    if (shard_totals.queries > 0) {
+        // Разница между задержкой и самым медленным шардом — раздача
+        // задач пулу, ожидание и склейка результатов
+        double queries_count = static_cast<double>(shard_totals.queries);
+        std::cout << "\nШарды, среднее время на запрос, мкс:";
+        for (size_t i = 0; i < shard_totals.time_ms.size(); ++i) {
+            std::printf(" #%zu %.1f", i, shard_totals.time_ms[i] * 1000 / queries_count);
+        }
+        std::printf("\nСамый медленный шард: %.1f мкс, задержка целиком: %.1f мкс\n",
+                    shard_totals.slowest_ms * 1000 / queries_count,
+                    us(latency.sum()) / std::max<uint64_t>(latency.count(), 1));
+    }
+
+    // Работа без учёта времени: каждый запрос журнала один раз с планом
+    Searcher search(index, shards, options.bigrams);
+    struct Scanned {
+        uint64_t queries = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+    };
+    std::map<std::string, Scanned> scanned;
+    for (const auto& query : parsed) {
+        QueryExplain explain;
+        search.search_parsed(query, &explain);
+        Scanned& c = scanned[query_class(query)];
+        c.queries++;
+        c.sum += explain.postings_scanned;
+        c.max = std::max<uint64_t>(c.max, explain.postings_scanned);
+    }
+    std::cout << "\nПросмотрено постингов за запрос" << std::endl;
+    std::cout << "класс      среднее        max" << std::endl;
+    for (const auto& [name, c] : scanned) {
+        std::printf("%-8s %10.0f %10llu\n", name.c_str(), static_cast<double>(c.sum) / c.queries,
+                    static_cast<unsigned long long>(c.max));
+    }
+
+    // Гистограмма по степеням двойки микросекунд
+    std::cout << "\nРаспределение задержек" << std::endl;
+    std::vector<uint64_t> buckets;
+    for (const auto& s : samples) {
+        uint64_t u = s.latency_ns / 1000;
+        size_t b = u == 0 ? 0 : 64 - __builtin_clzll(u);
+        if (b >= buckets.size()) buckets.resize(b + 1, 0);
+        buckets[b]++;
+    }
+    for (size_t b = 0; b < buckets.size(); ++b) {
+        if (buckets[b] == 0) continue;
+        uint64_t lo = b == 0 ? 0 : 1ull << (b - 1);
+        uint64_t hi = 1ull << b;
+        int bar = static_cast<int>(50.0 * buckets[b] / samples.size() + 0.5);
+        std::printf("%8llu - %-8llu мкс %8llu %6.2f%% %s\n", static_cast<unsigned long long>(lo),
+                    static_cast<unsigned long long>(hi), static_cast<unsigned long long>(buckets[b]),
+                    100.0 * buckets[b] / samples.size(), std::string(bar, '#').c_str());
+    }
+
+    // Сколько документов находят запросы: 0, 1, 2-9, 10-99, ...
+    std::cout << "\nЧисло найденных документов" << std::endl;
+    std::vector<uint64_t> found_buckets;
+    for (const auto& s : samples) {
+        size_t b = 0;
+        if (s.found == 1) {
+            b = 1;
+        } else if (s.found > 1) {
+            b = 2;
+            for (uint64_t limit = 10; s.found >= limit; limit *= 10) b++;
+        }
+        if (b >= found_buckets.size()) found_buckets.resize(b + 1, 0);
+        found_buckets[b]++;
+    }
+    for (size_t b = 0; b < found_buckets.size(); ++b) {
+        if (found_buckets[b] == 0) continue;
+        std::string range;
+        if (b == 0) {
+            range = "0";
+        } else if (b == 1) {
+            range = "1";
+        } else {
+            uint64_t lo = 1;
+            for (size_t k = 2; k < b; ++k) lo *= 10;
+            range = std::to_string(b == 2 ? 2 : lo) + "-" + std::to_string(lo * 10 - 1);
+        }
+        std::printf("%16s %8llu %6.2f%%\n", range.c_str(), static_cast<unsigned long long>(found_buckets[b]),
+                    100.0 * found_buckets[b] / samples.size());
+    }
+
+    // Самые медленные запросы, каждый один раз, с планом выполнения
+    std::sort(samples.begin(), samples.end(),
+              [](const Sample& a, const Sample& b) { return a.latency_ns > b.latency_ns; });
+    std::set<std::string> shown;
+    size_t printed = 0;
+    for (const auto& s : samples) {
+        if (printed == options.slowest) break;
+        if (!shown.insert(queries[s.query]).second) continue;
+        printed++;
+
+        QueryExplain explain;
+        SearchResult result = search.search_parsed(parsed[s.query], &explain);
+        std::cout << "\n#" << printed << " " << us(s.latency_ns) << " мкс (повтор "
+                  << result.search_time_ms * 1000 << " мкс), найдено " << s.found << ": "
+                  << queries[s.query] << std::endl;
+        explain.print(std::cout);
+    }
+}
+
+void print_usage(const char* program) {
+    std::cout << "Использование: " << program << " <index_file> [опции]" << std::endl;
+    std::cout << "  --queries FILE       журнал запросов, по одному в строке" << std::endl;
+    std::cout << "  --generate N         сгенерировать N запросов по частотам термов (10000)" << std::endl;
+    std::cout << "  --save-queries FILE  сохранить сгенерированный журнал" << std::endl;
+    std::cout << "  --clients N          клиентов в закрытом цикле или потоков в открытом (1)" << std::endl;
+    std::cout << "  --qps R              открытый цикл: R запросов в секунду" << std::endl;
+    std::cout << "  --duration S         ограничение по времени, журнал повторяется по кругу" << std::endl;
+    std::cout << "  --repeat K           сколько раз проиграть журнал (1)" << std::endl;
+    std::cout << "  --slowest K          показать K самых медленных запросов с планом (5)" << std::endl;
+    std::cout << "  --seed X             зерно генератора (42)" << std::endl;
+    std::cout << "  --no-bigrams         фразы только по термам, без биграмм индекса" << std::endl;
+    std::cout << "  --threads N          потоков пула для шардов (ядра)" << std::endl;
+    std::cout << "  --trace FILE, --metrics FILE" << std::endl;
+    std::cout << "Пример: " << program << " index.bin --qps 2000 --duration 10 --clients 4" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int threads = utils::extract_threads_option(argc, argv, utils::default_thread_count());
+    utils::ThreadPool::configure_shared(threads);
+    trace::Session tracing(argc, argv);
+
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--queries") == 0 && has_value) {
+            options.queries_file = argv[++i];
+        } else if (std::strcmp(argv[i], "--generate") == 0 && has_value) {
+            options.generate = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--save-queries") == 0 && has_value) {
+            options.save_queries_file = argv[++i];
+        } else if (std::strcmp(argv[i], "--clients") == 0 && has_value) {
+            options.clients = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--qps") == 0 && has_value) {
+            options.qps = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--duration") == 0 && has_value) {
+            options.duration_s = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && has_value) {
+            options.repeat = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--slowest") == 0 && has_value) {
+            options.slowest = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && has_value) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--no-bigrams") == 0) {
+            options.bigrams = false;
+        } else if (argv[i][0] != '-' && options.index_file.empty()) {
+            options.index_file = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.index_file.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    utils::Timer timer;
+    InvertedIndex single;
+    ShardedIndex shards;
+    const bool is_sharded = index_shards::is_manifest(options.index_file);
+    if (is_sharded ? !shards.load(options.index_file) : !single.load_from_file(options.index_file)) {
+        return 1;
+    }
+    std::cout << "Индекс загружен за " << timer.elapsed_ms() << " мс" << std::endl;
+    // Журнал генерируется по первому шарду: частоты в шардах близки
+    const InvertedIndex& index = is_sharded ? shards.shard(0) : single;
+
+    std::vector<std::string> queries;
+    if (!options.queries_file.empty()) {
+        if (!read_queries(options.queries_file, queries)) return 1;
+    } else {
+        QueryGenerator generator(index, options.seed);
+        if (generator.empty()) {
+            std::cerr << "Индекс пуст" << std::endl;
+            return 1;
+        }
+        for (size_t i = 0; i < options.generate; ++i) queries.push_back(generator.next());
+    }
+    if (queries.empty()) {
+        std::cerr << "Нет запросов" << std::endl;
+        return 1;
+    }
+
+    if (!options.save_queries_file.empty()) {
+        std::ofstream out(options.save_queries_file);
+        for (const auto& query : queries) out << query << "\n";
+        std::cout << "Журнал сохранён: " << options.save_queries_file << std::endl;
+    }
+
+    std::vector<ParsedQuery> parsed;
+    parsed.reserve(queries.size());
+    for (const auto& query : queries) parsed.push_back(BoolSearch::parse_query(query));
+
+    std::cout << "Запросов в журнале: " << queries.size() << ", ";
+    if (options.qps > 0) {
+        std::cout << "открытый цикл " << options.qps << " запросов/с, потоков " << options.clients;
+    } else {
+        std::cout << "закрытый цикл, клиентов " << options.clients;
+    }
+    std::cout << std::endl;
+
+    double elapsed_s = 0;
+    ShardTotals shard_totals;
+    std::vector<Sample> samples = run_load(is_sharded ? nullptr : &single, is_sharded ? &shards : nullptr,
+                                           queries, options, elapsed_s, shard_totals);
+    if (samples.empty()) {
+        std::cerr << "Ни один запрос не выполнен" << std::endl;
+        return 1;
+    }
+    print_report(is_sharded ? nullptr : &single, is_sharded ? &shards : nullptr, queries, parsed,
+                 samples, shard_totals, elapsed_s, options);
+    return 0;
+}
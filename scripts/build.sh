@@ -12,4 +12,4 @@ make -j$(nproc)
 echo "Сборка завершена!"
 echo ""
 echo "Собранные программы:"
-ls -lh crawler tokenizer stemmer zipf_analyzer build_index bool_search
+ls -lh crawler tokenizer stemmer zipf_analyzer build_index bool_search ingest
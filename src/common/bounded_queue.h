@@ -0,0 +1,64 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+namespace utils {
+
+// Очередь фиксированной ёмкости между стадиями конвейера: производитель
+// ждёт, пока потребители не разгребут очередь, поэтому память ограничена
+template <typename T>
+class BoundedQueue {
+private:
+    std::deque<T> items;
+    size_t capacity;
+    bool closed = false;
+
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+
+public:
+    explicit BoundedQueue(size_t cap) : capacity(cap > 0 ? cap : 1) {}
+
+    // false, если очередь уже закрыта
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return closed || items.size() < capacity; });
+        if (closed) return false;
+
+        items.push_back(std::move(item));
+        lock.unlock();
+        not_empty.notify_one();
+        return true;
+    }
+
+    // false, если очередь закрыта и пуста
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return closed || !items.empty(); });
+        if (items.empty()) return false;
+
+        item = std::move(items.front());
+        items.pop_front();
+        lock.unlock();
+        not_full.notify_one();
+        return true;
+    }
+
+    // Больше элементов не будет; pop дочитывает остаток
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,371 @@
+#include "common/corpus_format.h"
+#include "common/varint.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+
+namespace corpus {
+
+namespace {
+
+const char MAGIC[8] = {'S', 'E', 'C', 'O', 'R', 'P', 'U', 'S'};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t kind;
+    uint64_t documents_count;
+    uint64_t terms_count;
+    uint64_t dictionary_offset;
+    uint64_t offsets_offset;
+};
+
+static_assert(sizeof(Header) == 48, "заголовок корпуса должен быть без выравнивания");
+
+}
+
+void append_field(std::string& out, std::string_view field) {
+    for (char c : field) {
+        out += (c == '|' || c == '\n' || c == '\r') ? ' ' : c;
+    }
+}
+
+namespace {
+
+bool parse_doc_id(std::string_view field, int& doc_id) {
+    auto result = std::from_chars(field.data(), field.data() + field.size(), doc_id);
+    return result.ec == std::errc() && field.size() > 0;
+}
+
+}
+
+bool parse_document_line(std::string_view line, DocumentView& view) {
+    std::string_view fields[5];
+    if (utils::split_fields(line, '|', fields, 5) < 5) return false;
+    if (!parse_doc_id(fields[0], view.doc_id)) return false;
+
+    view.source = fields[1];
+    view.title = fields[2];
+    view.url = fields[3];
+    view.text = fields[4];
+    return true;
+}
+
+bool parse_terms_line(std::string_view line, TermsView& view) {
+    std::string_view fields[4];
+    if (utils::split_fields(line, '|', fields, 4) < 4) return false;
+    if (!parse_doc_id(fields[0], view.doc_id)) return false;
+
+    view.source = fields[1];
+    view.title = fields[2];
+
+    view.terms.clear();
+    utils::for_each_field(fields[3], ' ', [&view](std::string_view term) {
+        view.terms.push_back(term);
+    });
+    return true;
+}
+
+bool is_binary_name(const std::string& filename) {
+    const std::string ext = ".bin";
+    return filename.size() >= ext.size() &&
+           filename.compare(filename.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+bool is_binary_file(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    if (!in.read(magic, sizeof(magic))) return false;
+    return std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool Writer::open(const std::string& filename) {
+    out.open(filename, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Ошибка создания файла: " << filename << std::endl;
+        return false;
+    }
+
+    // Заголовок перезаписывается в close(), когда известны смещения
+    Header header = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    offset = sizeof(header);
+    return true;
+}
+
+void Writer::begin_record(int doc_id, std::string_view source, std::string_view title) {
+    offsets.push_back(offset + buffer.size());
+    varint::put(buffer, static_cast<uint32_t>(doc_id));
+    varint::put_string(buffer, source);
+    varint::put_string(buffer, title);
+}
+
+void Writer::add_document(const utils::Document& doc) {
+    begin_record(doc.doc_id, doc.source, doc.title);
+    varint::put_string(buffer, doc.url);
+    varint::put_string(buffer, doc.text);
+    if (buffer.size() >= (1 << 20)) flush();
+}
+
+void Writer::add_term(std::string_view term) {
+    if ((dictionary.size() + 1) * 10 > id_slots.size() * 7) {
+        grow_ids();
+    }
+
+    uint32_t hash = utils::FrequencyCounter::hash_key(term);
+    size_t mask = id_slots.size() - 1;
+    size_t i = hash & mask;
+
+    while (id_slots[i] != 0) {
+        uint32_t id = id_slots[i] - 1;
+        if (term_hashes[id] == hash && dictionary[id] == term) {
+            varint::put(buffer, id);
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+
+    uint32_t id = static_cast<uint32_t>(dictionary.size());
+    dictionary.push_back(pool.store(term));
+    term_hashes.push_back(hash);
+    id_slots[i] = id + 1;
+    varint::put(buffer, id);
+}
+
+void Writer::grow_ids() {
+    id_slots.assign(id_slots.empty() ? 1024 : id_slots.size() * 2, 0);
+
+    size_t mask = id_slots.size() - 1;
+    for (uint32_t id = 0; id < dictionary.size(); ++id) {
+        size_t i = term_hashes[id] & mask;
+        while (id_slots[i] != 0) i = (i + 1) & mask;
+        id_slots[i] = id + 1;
+    }
+}
+
+void Writer::add_batch(const TermsBatch& batch) {
+    size_t term = 0;
+    size_t term_begin = 0;
+    for (const auto& doc : batch.documents) {
+        begin_record(doc.doc_id, doc.source, doc.title);
+        varint::put(buffer, doc.terms_end - term);
+        for (; term < doc.terms_end; ++term) {
+            size_t term_end = batch.term_ends[term];
+            add_term(std::string_view(batch.bytes.data() + term_begin, term_end - term_begin));
+            term_begin = term_end;
+        }
+    }
+    if (buffer.size() >= (1 << 20)) flush();
+}
+
+void Writer::flush() {
+    out.write(buffer.data(), buffer.size());
+    offset += buffer.size();
+    buffer.clear();
+}
+
+bool Writer::close() {
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.kind = static_cast<uint32_t>(kind);
+    header.documents_count = offsets.size();
+    header.terms_count = dictionary.size();
+
+    header.dictionary_offset = offset + buffer.size();
+    for (const auto& term : dictionary) {
+        varint::put_string(buffer, term);
+    }
+
+    header.offsets_offset = offset + buffer.size();
+    buffer.append(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    flush();
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+
+    if (!out) {
+        std::cerr << "Ошибка записи двоичного корпуса" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Reader::open(const std::string& filename) {
+    if (!file.open(filename)) return false;
+
+    Header header;
+    if (file.size() < sizeof(header)) {
+        std::cerr << "Файл слишком короткий для двоичного корпуса: " << filename << std::endl;
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        std::cerr << "Файл не является двоичным корпусом: " << filename << std::endl;
+        return false;
+    }
+    if (header.version != VERSION) {
+        std::cerr << "Неподдерживаемая версия корпуса " << header.version
+                  << ": " << filename << std::endl;
+        return false;
+    }
+
+    size_t size = file.size();
+    // Сначала границы разделов, потом вычисления от них: иначе size - offsets_offset
+    // переполняется и таблица смещений и словарь читаются за концом отображения.
+    // Каждый терм словаря занимает хотя бы байт длины
+    if (header.dictionary_offset < sizeof(header) || header.dictionary_offset > size ||
+        header.offsets_offset < header.dictionary_offset || header.offsets_offset > size ||
+        header.documents_count > (size - header.offsets_offset) / sizeof(uint64_t) ||
+        header.terms_count > header.offsets_offset - header.dictionary_offset) {
+        std::cerr << "Повреждённый заголовок корпуса: " << filename << std::endl;
+        return false;
+    }
+
+    if (header.kind != static_cast<uint32_t>(Kind::DOCUMENTS) &&
+        header.kind != static_cast<uint32_t>(Kind::TERMS)) {
+        std::cerr << "Неизвестный вид корпуса: " << filename << std::endl;
+        return false;
+    }
+
+    file_kind = static_cast<Kind>(header.kind);
+    documents_count = header.documents_count;
+    records_begin = file.data() + sizeof(header);
+    records_end = file.data() + header.dictionary_offset;
+    offsets_table = file.data() + header.offsets_offset;
+
+    dictionary.clear();
+    dictionary.reserve(header.terms_count);
+    const char* p = records_end;
+    const char* end = offsets_table;
+    for (uint64_t i = 0; i < header.terms_count; ++i) {
+        std::string_view term;
+        if (!varint::get_string(p, end, term)) {
+            std::cerr << "Повреждённый словарь корпуса: " << filename << std::endl;
+            return false;
+        }
+        dictionary.push_back(term);
+    }
+    return true;
+}
+
+bool Reader::record_bounds(size_t i, const char*& p, const char*& end) const {
+    if (i >= documents_count) return false;
+
+    // Смещения из файла проверяются как числа: указатель за пределами
+    // отображения нельзя даже сформировать
+    uint64_t records_limit = records_end - file.data();
+    uint64_t begin_offset, end_offset;
+    std::memcpy(&begin_offset, offsets_table + i * sizeof(uint64_t), sizeof(uint64_t));
+    if (i + 1 < documents_count) {
+        std::memcpy(&end_offset, offsets_table + (i + 1) * sizeof(uint64_t), sizeof(uint64_t));
+    } else {
+        end_offset = records_limit;
+    }
+    if (begin_offset < sizeof(Header) || begin_offset > end_offset || end_offset > records_limit) {
+        return false;
+    }
+
+    p = file.data() + begin_offset;
+    end = file.data() + end_offset;
+    return true;
+}
+
+bool Reader::read_document(size_t i, DocumentView& view) const {
+    const char* p;
+    const char* end;
+    if (file_kind != Kind::DOCUMENTS || !record_bounds(i, p, end)) return false;
+
+    return varint::get_int(p, end, view.doc_id) &&
+           varint::get_string(p, end, view.source) &&
+           varint::get_string(p, end, view.title) &&
+           varint::get_string(p, end, view.url) &&
+           varint::get_string(p, end, view.text);
+}
+
+bool Reader::read_terms(size_t i, TermsView& view) const {
+    const char* p;
+    const char* end;
+    if (file_kind != Kind::TERMS || !record_bounds(i, p, end)) return false;
+
+    uint64_t count;
+    if (!varint::get_int(p, end, view.doc_id) ||
+        !varint::get_string(p, end, view.source) ||
+        !varint::get_string(p, end, view.title) ||
+        !varint::get(p, end, count) ||
+        count > static_cast<uint64_t>(end - p)) {
+        return false;
+    }
+
+    view.terms.clear();
+    view.terms.reserve(count);
+    for (uint64_t k = 0; k < count; ++k) {
+        uint64_t id;
+        if (!varint::get(p, end, id) || id >= dictionary.size()) return false;
+        view.terms.push_back(dictionary[id]);
+    }
+    return true;
+}
+
+bool Reader::read_term_ids(size_t i, std::vector<uint32_t>& ids) const {
+    const char* p;
+    const char* end;
+    if (file_kind != Kind::TERMS || !record_bounds(i, p, end)) return false;
+
+    int doc_id;
+    std::string_view skipped;
+    uint64_t count;
+    if (!varint::get_int(p, end, doc_id) ||
+        !varint::get_string(p, end, skipped) ||
+        !varint::get_string(p, end, skipped) ||
+        !varint::get(p, end, count) ||
+        count > static_cast<uint64_t>(end - p)) {
+        return false;
+    }
+
+    ids.clear();
+    ids.reserve(count);
+    for (uint64_t k = 0; k < count; ++k) {
+        uint64_t id;
+        if (!varint::get(p, end, id) || id >= dictionary.size()) return false;
+        ids.push_back(static_cast<uint32_t>(id));
+    }
+    return true;
+}
+
+bool ChunkSource::open(const std::string& filename) {
+    binary = is_binary_file(filename);
+    next = 0;
+    if (binary) return reader.open(filename);
+    return lines.open(filename);
+}
+
+bool ChunkSource::next_chunk(InputChunk& chunk, size_t max_lines, size_t max_bytes) {
+    if (!binary) {
+        chunk.first = 0;
+        bool has_lines = lines.next_chunk(chunk.lines, max_lines, max_bytes);
+        chunk.count = chunk.lines.size();
+        return has_lines;
+    }
+
+    chunk.lines.clear();
+    chunk.first = next;
+    chunk.count = std::min(max_lines, reader.size() - next);
+    next += chunk.count;
+    return chunk.count > 0;
+}
+
+bool ChunkSource::document_at(const InputChunk& chunk, size_t k, DocumentView& view) const {
+    if (binary) return reader.read_document(chunk.first + k, view);
+    return parse_document_line(chunk.lines[k], view);
+}
+
+bool ChunkSource::terms_at(const InputChunk& chunk, size_t k, TermsView& view) const {
+    if (binary) return reader.read_terms(chunk.first + k, view);
+    return parse_terms_line(chunk.lines[k], view);
+}
+
+}
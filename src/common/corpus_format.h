@@ -0,0 +1,223 @@
+#ifndef CORPUS_FORMAT_H
+#define CORPUS_FORMAT_H
+
+#include "common/utils.h"
+#include "common/mapped_file.h"
+#include "common/line_reader.h"
+#include "common/string_pool.h"
+#include "common/frequency_counter.h"
+#include "common/varint.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Двоичный контейнер корпуса вместо corpus.txt / tokens.txt / stems.txt.
+//
+//   Header      магия, версия, вид файла, число документов и смещения разделов
+//   записи      по одной на документ, подряд:
+//                 DOCUMENTS: doc_id, source, title, url, text
+//                 TERMS:     doc_id, source, title, число термов, id термов
+//               числа — varint, строки — varint-длина и байты как есть
+//   словарь     (только TERMS) термы в порядке id: varint-длина и байты
+//   смещения    uint64 на документ: начало его записи, для произвольного доступа
+//
+// Терм хранится один раз в словаре, в записях — только его varint-id,
+// поэтому частые термы занимают 1-2 байта. Строки не экранируются:
+// '|' и переводы строк в тексте сохраняются.
+namespace corpus {
+
+enum class Kind : uint32_t {
+    DOCUMENTS = 1,
+    TERMS = 2
+};
+
+const uint32_t VERSION = 1;
+
+struct DocumentView {
+    int doc_id = 0;
+    std::string_view source;
+    std::string_view title;
+    std::string_view url;
+    std::string_view text;
+};
+
+// Термы указывают в словарь отображённого файла
+struct TermsView {
+    int doc_id = 0;
+    std::string_view source;
+    std::string_view title;
+    std::vector<std::string_view> terms;
+};
+
+// Записи TERMS, собранные рабочим потоком до передачи в Writer.
+// Термы всех документов лежат подряд в одном буфере, чтобы не
+// заводить по строке на каждый терм.
+struct TermsBatch {
+    struct Entry {
+        int doc_id;
+        std::string source;
+        std::string title;
+        size_t terms_end;
+    };
+
+    std::vector<Entry> documents;
+    std::string bytes;
+    std::vector<size_t> term_ends;
+
+    template <typename Terms>
+    void add(int doc_id, std::string_view source, std::string_view title, const Terms& terms) {
+        for (const auto& term : terms) {
+            bytes.append(term.data(), term.size());
+            term_ends.push_back(bytes.size());
+        }
+        documents.push_back({doc_id, std::string(source), std::string(title), term_ends.size()});
+    }
+};
+
+// Строка текстового tokens.txt / stems.txt: doc_id|source|title|t1 t2 ...
+// Разделители в source и title заменяются пробелами.
+void append_field(std::string& out, std::string_view field);
+
+template <typename Terms>
+void append_terms_line(std::string& out, int doc_id, std::string_view source,
+                       std::string_view title, const Terms& terms) {
+    out += std::to_string(doc_id);
+    out += '|';
+    append_field(out, source);
+    out += '|';
+    append_field(out, title);
+    out += '|';
+
+    bool first = true;
+    for (const auto& term : terms) {
+        if (!first) out += ' ';
+        out += term;
+        first = false;
+    }
+    out += '\n';
+}
+
+// Разбор строк текстовых форматов без копирования: view указывают в line
+bool parse_document_line(std::string_view line, DocumentView& view);
+
+bool parse_terms_line(std::string_view line, TermsView& view);
+
+// Выходной файл двоичный, если его имя оканчивается на .bin
+bool is_binary_name(const std::string& filename);
+
+// Входной файл двоичный, если начинается с магии контейнера
+bool is_binary_file(const std::string& filename);
+
+class Writer {
+private:
+    Kind kind;
+    std::ofstream out;
+    std::string buffer;
+    uint64_t offset = 0;
+    std::vector<uint64_t> offsets;
+
+    // Словарь терм -> id: открытая адресация, в слоте id + 1 (0 — пусто)
+    utils::StringPool pool;
+    std::vector<std::string_view> dictionary;
+    std::vector<uint32_t> term_hashes;
+    std::vector<uint32_t> id_slots;
+
+    void begin_record(int doc_id, std::string_view source, std::string_view title);
+    void add_term(std::string_view term);
+    void grow_ids();
+    void flush();
+
+public:
+    explicit Writer(Kind k) : kind(k) {}
+
+    bool open(const std::string& filename);
+
+    void add_document(const utils::Document& doc);
+
+    template <typename Terms>
+    void add_terms(int doc_id, std::string_view source, std::string_view title,
+                   const Terms& terms) {
+        begin_record(doc_id, source, title);
+        varint::put(buffer, terms.size());
+        for (const auto& term : terms) {
+            add_term(term);
+        }
+        if (buffer.size() >= (1 << 20)) flush();
+    }
+
+    void add_batch(const TermsBatch& batch);
+
+    // Дописывает словарь, таблицу смещений и заголовок
+    bool close();
+
+    size_t size() const { return offsets.size(); }
+};
+
+// Чтение через отображение в память: записи разбираются на месте,
+// строки выдаются как string_view внутрь файла. Методы чтения
+// константные, один Reader можно читать из нескольких потоков.
+class Reader {
+private:
+    utils::MappedFile file;
+    Kind file_kind = Kind::DOCUMENTS;
+    size_t documents_count = 0;
+    const char* records_begin = nullptr;
+    const char* records_end = nullptr;
+    const char* offsets_table = nullptr;
+    std::vector<std::string_view> dictionary;
+
+    bool record_bounds(size_t i, const char*& p, const char*& end) const;
+
+public:
+    bool open(const std::string& filename);
+
+    Kind kind() const { return file_kind; }
+    size_t size() const { return documents_count; }
+
+    const std::vector<std::string_view>& get_dictionary() const { return dictionary; }
+
+    bool read_document(size_t i, DocumentView& view) const;
+
+    bool read_terms(size_t i, TermsView& view) const;
+
+    // Только id термов, без обращения к словарю
+    bool read_term_ids(size_t i, std::vector<uint32_t>& ids) const;
+};
+
+// Порция входа для конвейера: строки текстового файла
+// или диапазон [first, first + count) записей двоичного.
+// Строки указывают в отображение и живут вместе с ChunkSource.
+struct InputChunk {
+    std::vector<std::string_view> lines;
+    size_t first = 0;
+    size_t count = 0;
+};
+
+// Вход стадии в любом из двух форматов; формат определяется по магии
+class ChunkSource {
+private:
+    bool binary = false;
+    utils::LineReader lines;
+    Reader reader;
+    size_t next = 0;
+
+public:
+    bool open(const std::string& filename);
+
+    bool is_binary() const { return binary; }
+    const Reader& get_reader() const { return reader; }
+
+    // false, когда вход исчерпан
+    bool next_chunk(InputChunk& chunk, size_t max_lines, size_t max_bytes);
+
+    // k-й документ порции; false, если строка или запись битая
+    bool document_at(const InputChunk& chunk, size_t k, DocumentView& view) const;
+
+    bool terms_at(const InputChunk& chunk, size_t k, TermsView& view) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,150 @@
+#include "common/frequency_counter.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace utils {
+
+namespace {
+
+const size_t MIN_CAPACITY = 16;
+
+bool more_frequent(const FrequencyCounter::Entry& a, const FrequencyCounter::Entry& b) {
+    if (a.second != b.second) return a.second > b.second;
+    return a.first < b.first;
+}
+
+}
+
+FrequencyCounter::FrequencyCounter(size_t expected_keys) {
+    size_t capacity = MIN_CAPACITY;
+    while (capacity * 7 / 10 < expected_keys) capacity *= 2;
+    slots.resize(capacity);
+}
+
+FrequencyCounter::FrequencyCounter(FrequencyCounter&& other) noexcept
+    : slots(std::move(other.slots)),
+      used(std::exchange(other.used, 0)),
+      total_count(std::exchange(other.total_count, 0)),
+      pool(std::move(other.pool)) {
+    other.slots.clear();
+}
+
+FrequencyCounter& FrequencyCounter::operator=(FrequencyCounter&& other) noexcept {
+    if (this != &other) {
+        slots = std::move(other.slots);
+        other.slots.clear();
+        used = std::exchange(other.used, 0);
+        total_count = std::exchange(other.total_count, 0);
+        pool = std::move(other.pool);
+    }
+    return *this;
+}
+
+uint32_t FrequencyCounter::hash_key(std::string_view key) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (char c : key) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 16777619u;
+    }
+    return h;
+}
+
+size_t FrequencyCounter::find_slot(std::string_view key, uint32_t hash) const {
+    size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+
+    while (true) {
+        const Slot& slot = slots[i];
+        if (!slot.data) return i;
+        if (slot.hash == hash && slot.length == key.size() &&
+            std::memcmp(slot.data, key.data(), key.size()) == 0) {
+            return i;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+void FrequencyCounter::grow() {
+    std::vector<Slot> old;
+    old.swap(slots);
+    slots.resize(old.empty() ? MIN_CAPACITY : old.size() * 2);
+
+    size_t mask = slots.size() - 1;
+    for (const auto& slot : old) {
+        if (!slot.data) continue;
+        size_t i = slot.hash & mask;
+        while (slots[i].data) i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+}
+
+void FrequencyCounter::add(std::string_view key, uint64_t n) {
+    add_hashed(key, hash_key(key), n);
+}
+
+void FrequencyCounter::add_hashed(std::string_view key, uint32_t hash, uint64_t n) {
+    // Пустой ключ не отличить от пустого слота; пустых термов в корпусе нет
+    if (key.empty()) return;
+
+    if ((used + 1) * 10 > slots.size() * 7) {
+        grow();
+    }
+
+    Slot& slot = slots[find_slot(key, hash)];
+
+    if (!slot.data) {
+        std::string_view stored = pool.store(key);
+        slot.data = stored.data();
+        slot.length = static_cast<uint32_t>(stored.size());
+        slot.hash = hash;
+        used++;
+    }
+
+    slot.count += n;
+    total_count += n;
+}
+
+uint64_t FrequencyCounter::count(std::string_view key) const {
+    return count_hashed(key, hash_key(key));
+}
+
+uint64_t FrequencyCounter::count_hashed(std::string_view key, uint32_t hash) const {
+    if (slots.empty() || key.empty()) return 0;
+    const Slot& slot = slots[find_slot(key, hash)];
+    return slot.data ? slot.count : 0;
+}
+
+void FrequencyCounter::merge(const FrequencyCounter& other) {
+    // Хэши уже лежат в слотах, пересчитывать их не нужно
+    for (const auto& slot : other.slots) {
+        if (slot.data) add_hashed(std::string_view(slot.data, slot.length), slot.hash, slot.count);
+    }
+}
+
+std::vector<FrequencyCounter::Entry> FrequencyCounter::top_n(size_t n) const {
+    std::vector<Entry> entries;
+    entries.reserve(used);
+    for_each([&entries](std::string_view key, uint64_t n) {
+        entries.emplace_back(key, n);
+    });
+
+    n = std::min(n, entries.size());
+    if (n < entries.size()) {
+        std::nth_element(entries.begin(), entries.begin() + n, entries.end(), more_frequent);
+        entries.resize(n);
+    }
+    std::sort(entries.begin(), entries.end(), more_frequent);
+
+    return entries;
+}
+
+void FrequencyCounter::clear() {
+    slots.clear();
+    used = 0;
+    total_count = 0;
+    pool.clear();
+}
+
+}
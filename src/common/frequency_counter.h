@@ -0,0 +1,81 @@
+#ifndef FREQUENCY_COUNTER_H
+#define FREQUENCY_COUNTER_H
+
+#include "common/string_pool.h"
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace utils {
+
+// Счётчик частот термов: открытая адресация с линейным пробированием,
+// ключи — string_view в собственную арену строк. Поиск принимает любую
+// строку без создания std::string.
+class FrequencyCounter {
+public:
+    using Entry = std::pair<std::string_view, uint64_t>;
+
+private:
+    struct Slot {
+        const char* data = nullptr;
+        uint32_t length = 0;
+        uint32_t hash = 0;
+        uint64_t count = 0;
+    };
+
+    std::vector<Slot> slots;
+    size_t used = 0;
+    uint64_t total_count = 0;
+    StringPool pool;
+
+    size_t find_slot(std::string_view key, uint32_t hash) const;
+    void grow();
+
+public:
+    FrequencyCounter() = default;
+    explicit FrequencyCounter(size_t expected_keys);
+
+    // Исходный счётчик после перемещения пуст и пригоден к использованию
+    FrequencyCounter(FrequencyCounter&& other) noexcept;
+    FrequencyCounter& operator=(FrequencyCounter&& other) noexcept;
+
+    static uint32_t hash_key(std::string_view key);
+
+    void add(std::string_view key, uint64_t n = 1);
+
+    // То же с готовым хэшем hash_key(key), если он уже нужен вызывающему,
+    // например для выбора раздела
+    void add_hashed(std::string_view key, uint32_t hash, uint64_t n = 1);
+
+    uint64_t count(std::string_view key) const;
+    uint64_t count_hashed(std::string_view key, uint32_t hash) const;
+
+    // Количество различных ключей
+    size_t size() const { return used; }
+
+    // Сумма всех частот
+    uint64_t total() const { return total_count; }
+
+    void merge(const FrequencyCounter& other);
+
+    // n самых частых: по убыванию частоты, при равенстве — по ключу.
+    // Частичная сортировка, весь словарь не упорядочивается.
+    std::vector<Entry> top_n(size_t n) const;
+
+    // Весь словарь в том же порядке, что и top_n
+    std::vector<Entry> sorted() const { return top_n(used); }
+
+    template <typename F>
+    void for_each(F f) const {
+        for (const auto& slot : slots) {
+            if (slot.data) f(std::string_view(slot.data, slot.length), slot.count);
+        }
+    }
+
+    void clear();
+};
+
+}
+
+#endif
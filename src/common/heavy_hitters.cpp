@@ -0,0 +1,159 @@
+#include "common/heavy_hitters.h"
+#include "common/frequency_counter.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace utils {
+
+SpaceSaving::SpaceSaving(size_t max_entries)
+    : capacity(std::min(std::max<size_t>(max_entries, 1), MAX_CAPACITY)) {
+    size_t bucket_count = 16;
+    while (bucket_count < capacity * 2) bucket_count *= 2;
+    buckets.assign(bucket_count, 0);
+    counters.reserve(capacity);
+    heap.reserve(capacity);
+    heap_position.reserve(capacity);
+}
+
+bool SpaceSaving::parse_capacity(const std::string& text, size_t& capacity) {
+    // strtoull молча принимает знак минус и пробелы, поэтому только цифры
+    if (text.empty() || text.size() > 19 ||
+        text.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    unsigned long long value = std::strtoull(text.c_str(), nullptr, 10);
+    if (value == 0 || value > MAX_CAPACITY) return false;
+    capacity = static_cast<size_t>(value);
+    return true;
+}
+
+size_t SpaceSaving::find_bucket(std::string_view key, uint32_t hash) const {
+    size_t mask = buckets.size() - 1;
+    size_t i = hash & mask;
+    while (buckets[i] != 0) {
+        const Counter& counter = counters[buckets[i] - 1];
+        if (counter.hash == hash && counter.key == key) return i;
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+void SpaceSaving::erase_bucket(size_t bucket) {
+    // Удаление со сдвигом назад: цепочки линейного пробирования не рвутся
+    size_t mask = buckets.size() - 1;
+    size_t hole = bucket;
+    size_t i = (bucket + 1) & mask;
+    buckets[hole] = 0;
+
+    while (buckets[i] != 0) {
+        size_t home = counters[buckets[i] - 1].hash & mask;
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            buckets[hole] = buckets[i];
+            buckets[i] = 0;
+            hole = i;
+        }
+        i = (i + 1) & mask;
+    }
+}
+
+void SpaceSaving::sift_down(size_t position) {
+    size_t size = heap.size();
+    while (true) {
+        size_t smallest = position;
+        size_t left = position * 2 + 1;
+        size_t right = left + 1;
+        if (left < size && counters[heap[left]].count < counters[heap[smallest]].count) {
+            smallest = left;
+        }
+        if (right < size && counters[heap[right]].count < counters[heap[smallest]].count) {
+            smallest = right;
+        }
+        if (smallest == position) return;
+
+        std::swap(heap[position], heap[smallest]);
+        heap_position[heap[position]] = static_cast<uint32_t>(position);
+        heap_position[heap[smallest]] = static_cast<uint32_t>(smallest);
+        position = smallest;
+    }
+}
+
+void SpaceSaving::add(std::string_view key, uint64_t n) {
+    add_hashed(key, FrequencyCounter::hash_key(key), n);
+}
+
+void SpaceSaving::add_hashed(std::string_view key, uint32_t hash, uint64_t n) {
+    if (key.empty() || n == 0) return;
+    total_count += n;
+
+    size_t bucket = find_bucket(key, hash);
+
+    if (buckets[bucket] != 0) {
+        uint32_t index = buckets[bucket] - 1;
+        counters[index].count += n;
+        sift_down(heap_position[index]);
+        return;
+    }
+
+    if (counters.size() < capacity) {
+        // Пока есть свободные счётчики, ключ просто добавляется в кучу
+        uint32_t index = static_cast<uint32_t>(counters.size());
+        counters.push_back({std::string(key), hash, n, 0});
+        buckets[bucket] = index + 1;
+
+        size_t position = heap.size();
+        heap.push_back(index);
+        heap_position.push_back(static_cast<uint32_t>(position));
+        while (position > 0) {
+            size_t parent = (position - 1) / 2;
+            if (counters[heap[parent]].count <= counters[heap[position]].count) break;
+            std::swap(heap[position], heap[parent]);
+            heap_position[heap[position]] = static_cast<uint32_t>(position);
+            heap_position[heap[parent]] = static_cast<uint32_t>(parent);
+            position = parent;
+        }
+        return;
+    }
+
+    // Вытесняем ключ с наименьшим счётчиком
+    uint32_t index = heap[0];
+    Counter& victim = counters[index];
+    erase_bucket(find_bucket(victim.key, victim.hash));
+
+    victim.key.assign(key.data(), key.size());
+    victim.hash = hash;
+    victim.error = victim.count;
+    victim.count += n;
+    buckets[find_bucket(key, hash)] = index + 1;
+    sift_down(0);
+}
+
+uint64_t SpaceSaving::max_error() const {
+    if (counters.size() < capacity) return 0;
+    return counters[heap[0]].count;
+}
+
+std::vector<SpaceSaving::Entry> SpaceSaving::sorted() const {
+    std::vector<Entry> entries;
+    entries.reserve(counters.size());
+    for (const auto& counter : counters) {
+        entries.push_back({counter.key, counter.count, counter.error});
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        if (a.count != b.count) return a.count > b.count;
+        return a.key < b.key;
+    });
+    return entries;
+}
+
+size_t SpaceSaving::memory_bytes() const {
+    size_t bytes = counters.capacity() * sizeof(Counter) +
+                   heap.capacity() * sizeof(uint32_t) +
+                   heap_position.capacity() * sizeof(uint32_t) +
+                   buckets.capacity() * sizeof(uint32_t);
+    for (const auto& counter : counters) {
+        bytes += counter.key.capacity();
+    }
+    return bytes;
+}
+
+}
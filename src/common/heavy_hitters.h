@@ -0,0 +1,78 @@
+#ifndef HEAVY_HITTERS_H
+#define HEAVY_HITTERS_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace utils {
+
+// Space-Saving (Metwally et al.): приближённые частоты самых частых
+// ключей в памяти O(capacity), независимо от размера словаря.
+// Отслеживается не больше capacity ключей; новый ключ вытесняет ключ с
+// наименьшим счётчиком и наследует его значение как погрешность.
+// Для каждого отслеживаемого ключа count - error <= истинная частота <= count,
+// а любой ключ с частотой больше total / capacity гарантированно отслеживается.
+class SpaceSaving {
+public:
+    struct Entry {
+        std::string_view key;
+        uint64_t count;
+        uint64_t error;
+    };
+
+private:
+    struct Counter {
+        std::string key;
+        uint32_t hash = 0;
+        uint64_t count = 0;
+        uint64_t error = 0;
+    };
+
+    size_t capacity;
+    std::vector<Counter> counters;
+    // Мин-куча номеров счётчиков по count и позиция каждого счётчика в ней
+    std::vector<uint32_t> heap;
+    std::vector<uint32_t> heap_position;
+    // Открытая адресация: номер счётчика + 1, 0 — пустая ячейка
+    std::vector<uint32_t> buckets;
+    uint64_t total_count = 0;
+
+    size_t find_bucket(std::string_view key, uint32_t hash) const;
+    void erase_bucket(size_t bucket);
+    void sift_down(size_t position);
+
+public:
+    // Верхняя граница числа счётчиков: номера в куче и ячейках — uint32_t,
+    // а больше нескольких миллионов ключей дешевле считать точно
+    static constexpr size_t MAX_CAPACITY = size_t(1) << 22;
+
+    // max_entries приводится к [1, MAX_CAPACITY]
+    explicit SpaceSaving(size_t max_entries = 10000);
+
+    // Число отслеживаемых ключей из командной строки: целое в [1, MAX_CAPACITY]
+    static bool parse_capacity(const std::string& text, size_t& capacity);
+
+    void add(std::string_view key, uint64_t n = 1);
+    
+    // То же с готовым хэшем ключа, если он уже посчитан для другого скетча
+    void add_hashed(std::string_view key, uint32_t hash, uint64_t n = 1);
+
+    uint64_t total() const { return total_count; }
+    size_t size() const { return counters.size(); }
+    size_t get_capacity() const { return capacity; }
+
+    // Верхняя граница частоты любого неотслеживаемого ключа и
+    // погрешности любого отслеживаемого
+    uint64_t max_error() const;
+
+    // Отслеживаемые ключи по убыванию count, при равенстве — по ключу
+    std::vector<Entry> sorted() const;
+
+    size_t memory_bytes() const;
+};
+
+}
+
+#endif
@@ -0,0 +1,105 @@
+#include "common/hyperloglog.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace utils {
+
+namespace {
+
+double sigma(double x) {
+    if (x == 1.0) return std::numeric_limits<double>::infinity();
+    double y = 1.0;
+    double z = x;
+    double previous;
+    do {
+        x *= x;
+        previous = z;
+        z += x * y;
+        y += y;
+    } while (z != previous);
+    return z;
+}
+
+double tau(double x) {
+    if (x == 0.0 || x == 1.0) return 0.0;
+    double y = 1.0;
+    double z = 1.0 - x;
+    double previous;
+    do {
+        x = std::sqrt(x);
+        previous = z;
+        y *= 0.5;
+        z -= (1.0 - x) * (1.0 - x) * y;
+    } while (z != previous);
+    return z / 3.0;
+}
+
+}
+
+HyperLogLog::HyperLogLog(int precision_bits)
+    : precision(std::min(std::max(precision_bits, 4), 18)),
+      registers(static_cast<size_t>(1) << precision, 0) {}
+
+uint64_t HyperLogLog::hash_key(std::string_view key) {
+    // FNV-1a 64 с финальным перемешиванием из MurmurHash3: у FNV плохо
+    // распределены старшие биты, а HyperLogLog берёт номер регистра из них
+    uint64_t h = 14695981039346656037ULL;
+    for (char c : key) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+void HyperLogLog::add(std::string_view key) {
+    add_hash(hash_key(key));
+}
+
+void HyperLogLog::add_hash(uint64_t hash) {
+    size_t index = hash >> (64 - precision);
+    // Позиция первой единицы в оставшихся битах; сторожевой бит
+    // ограничивает ранг, если все они нулевые
+    uint64_t rest = (hash << precision) | (1ULL << (precision - 1));
+    uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+    if (rank > registers[index]) registers[index] = rank;
+}
+
+void HyperLogLog::merge(const HyperLogLog& other) {
+    if (other.precision != precision) return;
+    for (size_t i = 0; i < registers.size(); ++i) {
+        registers[i] = std::max(registers[i], other.registers[i]);
+    }
+}
+
+uint64_t HyperLogLog::estimate() const {
+    // Улучшенная оценка Ertl («New cardinality estimation algorithms for
+    // HyperLogLog sketches», 2017): в отличие от классической формулы с
+    // линейным подсчётом не смещена на переходе около 2.5 * m
+    int q = 64 - precision;
+    std::vector<uint32_t> histogram(q + 2, 0);
+    for (uint8_t r : registers) {
+        histogram[r]++;
+    }
+
+    double m = static_cast<double>(registers.size());
+    double z = m * tau(1.0 - histogram[q + 1] / m);
+    for (int k = q; k >= 1; --k) {
+        z = 0.5 * (z + histogram[k]);
+    }
+    z += m * sigma(histogram[0] / m);
+
+    double alpha = 0.5 / std::log(2.0);
+    return static_cast<uint64_t>(std::llround(alpha * m * m / z));
+}
+
+double HyperLogLog::standard_error() const {
+    return 1.04 / std::sqrt(static_cast<double>(registers.size()));
+}
+
+}
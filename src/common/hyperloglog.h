@@ -0,0 +1,38 @@
+#ifndef HYPERLOGLOG_H
+#define HYPERLOGLOG_H
+
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace utils {
+
+// HyperLogLog (Flajolet et al.): оценка числа различных ключей
+// в 2^precision байтах. Стандартная ошибка — 1.04 / sqrt(2^precision),
+// для precision = 14 это около 0.8% при 16 КБ памяти.
+class HyperLogLog {
+private:
+    int precision;
+    std::vector<uint8_t> registers;
+
+public:
+    explicit HyperLogLog(int precision_bits = 14);
+
+    static uint64_t hash_key(std::string_view key);
+
+    void add(std::string_view key);
+    void add_hash(uint64_t hash);
+
+    void merge(const HyperLogLog& other);
+
+    uint64_t estimate() const;
+
+    // Относительная стандартная ошибка оценки
+    double standard_error() const;
+
+    size_t memory_bytes() const { return registers.size(); }
+};
+
+}
+
+#endif
@@ -0,0 +1,273 @@
+#include "common/json_reader.h"
+#include "common/utf8.h"
+#include <iostream>
+
+#if defined(__SSE2__)
+#define JSON_READER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace utils {
+
+namespace {
+
+// Через сколько прочитанных байт отдавать страницы файла обратно ядру
+const size_t RELEASE_STEP = 64 * 1024 * 1024;
+
+// Первая кавычка или обратная косая черта в [p, end): внутри строки
+// всё остальное копируется как есть, поэтому ищем только их,
+// по 16 байт за сравнение там, где есть SSE2
+const char* find_string_special(const char* p, const char* end) {
+#ifdef JSON_READER_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                  _mm_cmpeq_epi8(chunk, backslash)));
+        if (mask != 0) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\\') ++p;
+    return p;
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool is_whitespace(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+}
+
+bool JsonCorpusReader::read_file(const std::string& filename, const Callback& callback) {
+    MappedFile file;
+    if (!file.open(filename)) return false;
+
+    begin = file.data();
+    end = begin + file.size();
+
+    if (!parse(callback, &file)) {
+        std::cerr << "Ошибка разбора JSON в " << filename << ": " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool JsonCorpusReader::read(std::string_view json, const Callback& callback) {
+    begin = json.data();
+    end = begin + json.size();
+    return parse(callback, nullptr);
+}
+
+bool JsonCorpusReader::parse(const Callback& callback, MappedFile* file) {
+    pos = begin;
+    documents_count = 0;
+    error.clear();
+    size_t released = 0;
+
+    // Верхний уровень: '[' ... ']' или объекты подряд; запятые между
+    // объектами необязательны, чтобы читать и JSON Lines
+    while (true) {
+        skip_whitespace();
+        if (pos == end) return true;
+
+        char c = *pos;
+        if (c == '[' || c == ']' || c == ',') {
+            ++pos;
+            continue;
+        }
+        if (c != '{') return fail("ожидался объект документа");
+
+        ++pos;
+        if (!parse_object()) return false;
+
+        doc.doc_id = static_cast<int>(documents_count++);
+        callback(doc);
+
+        size_t offset = static_cast<size_t>(pos - begin);
+        if (file && offset - released >= RELEASE_STEP) {
+            file->release_before(offset);
+            released = offset;
+        }
+    }
+}
+
+void JsonCorpusReader::skip_whitespace() {
+    while (pos < end && is_whitespace(*pos)) ++pos;
+}
+
+bool JsonCorpusReader::parse_object() {
+    doc.source.clear();
+    doc.title.clear();
+    doc.text.clear();
+    doc.url.clear();
+
+    skip_whitespace();
+    if (pos < end && *pos == '}') {
+        ++pos;
+        return true;
+    }
+
+    while (true) {
+        skip_whitespace();
+        if (pos == end || *pos != '"') return fail("ожидалось имя поля");
+        ++pos;
+        if (!parse_string(key)) return false;
+
+        skip_whitespace();
+        if (pos == end || *pos != ':') return fail("ожидалось ':'");
+        ++pos;
+        skip_whitespace();
+        if (pos == end) return fail("неожиданный конец файла");
+
+        std::string* field = nullptr;
+        if (key == "source") field = &doc.source;
+        else if (key == "title") field = &doc.title;
+        else if (key == "text" || key == "content") field = &doc.text;
+        else if (key == "url") field = &doc.url;
+
+        if (field && *pos == '"') {
+            ++pos;
+            if (!parse_string(*field)) return false;
+        } else if (!skip_value()) {
+            return false;
+        }
+
+        skip_whitespace();
+        if (pos == end) return fail("незакрытый объект");
+        if (*pos == ',') {
+            ++pos;
+            continue;
+        }
+        if (*pos == '}') {
+            ++pos;
+            return true;
+        }
+        return fail("ожидалось ',' или '}'");
+    }
+}
+
+// pos стоит сразу после открывающей кавычки
+bool JsonCorpusReader::parse_string(std::string& out) {
+    out.clear();
+
+    while (true) {
+        const char* special = find_string_special(pos, end);
+        out.append(pos, special - pos);
+        pos = special;
+
+        if (pos == end) return fail("незакрытая строка");
+        if (*pos == '"') {
+            ++pos;
+            return true;
+        }
+
+        if (end - pos < 2) return fail("обрыв escape-последовательности");
+        char c = pos[1];
+        pos += 2;
+        switch (c) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u':
+                if (!parse_unicode_escape(out)) return false;
+                break;
+            default:
+                return fail("неизвестная escape-последовательность");
+        }
+    }
+}
+
+// pos стоит после "\u"
+bool JsonCorpusReader::parse_unicode_escape(std::string& out) {
+    auto read_hex4 = [this](char32_t& cp) {
+        if (end - pos < 4) return false;
+        cp = 0;
+        for (int i = 0; i < 4; ++i) {
+            int v = hex_value(pos[i]);
+            if (v < 0) return false;
+            cp = (cp << 4) | static_cast<char32_t>(v);
+        }
+        pos += 4;
+        return true;
+    };
+
+    char32_t cp;
+    if (!read_hex4(cp)) return fail("неверная последовательность \\u");
+
+    if (cp >= 0xD800 && cp <= 0xDBFF) {
+        // Символ вне BMP записывается парой суррогатов
+        char32_t low;
+        if (end - pos >= 2 && pos[0] == '\\' && pos[1] == 'u') {
+            const char* saved = pos;
+            pos += 2;
+            if (read_hex4(low) && low >= 0xDC00 && low <= 0xDFFF) {
+                utf8::append(out, 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00));
+                return true;
+            }
+            pos = saved;
+        }
+        utf8::append(out, 0xFFFD);
+        return true;
+    }
+    if (cp >= 0xDC00 && cp <= 0xDFFF) {
+        utf8::append(out, 0xFFFD);
+        return true;
+    }
+
+    utf8::append(out, cp);
+    return true;
+}
+
+bool JsonCorpusReader::skip_value() {
+    char c = *pos;
+
+    if (c == '"') {
+        ++pos;
+        return parse_string(scratch);
+    }
+
+    if (c == '{' || c == '[') {
+        int depth = 0;
+        while (pos < end) {
+            c = *pos;
+            if (c == '"') {
+                ++pos;
+                if (!parse_string(scratch)) return false;
+                continue;
+            }
+            ++pos;
+            if (c == '{' || c == '[') {
+                depth++;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) return true;
+            }
+        }
+        return fail("незакрытый вложенный объект");
+    }
+
+    // Число, true, false или null
+    const char* start = pos;
+    while (pos < end && *pos != ',' && *pos != '}' && *pos != ']' && !is_whitespace(*pos)) ++pos;
+    if (pos == start) return fail("ожидалось значение");
+    return true;
+}
+
+bool JsonCorpusReader::fail(const char* message) {
+    error = std::string(message) + " (байт " + std::to_string(pos - begin) + ")";
+    return false;
+}
+
+}
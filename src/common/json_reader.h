@@ -0,0 +1,55 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include "common/utils.h"
+#include "common/mapped_file.h"
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace utils {
+
+// Потоковый разбор JSON-корпуса: массив объектов или объекты подряд
+// (JSON Lines). Каждый объект разбирается прямо из отображённого файла
+// в один переиспользуемый Document и сразу отдаётся в callback, так что
+// память не зависит от размера дампа.
+//
+// Из объекта берутся поля source, title, text (или content) и url;
+// остальные значения, включая вложенные, пропускаются. Строки декодируются
+// полностью: \", \\, \n, \uXXXX и суррогатные пары.
+class JsonCorpusReader {
+public:
+    using Callback = std::function<void(Document&)>;
+
+private:
+    const char* begin = nullptr;
+    const char* pos = nullptr;
+    const char* end = nullptr;
+
+    Document doc;
+    std::string key;
+    std::string scratch;
+    size_t documents_count = 0;
+    std::string error;
+
+    bool parse(const Callback& callback, MappedFile* file);
+    void skip_whitespace();
+    bool parse_object();
+    bool parse_string(std::string& out);
+    bool parse_unicode_escape(std::string& out);
+    bool skip_value();
+    bool fail(const char* message);
+
+public:
+    // Документы до первой ошибки разбора успевают попасть в callback
+    bool read_file(const std::string& filename, const Callback& callback);
+
+    bool read(std::string_view json, const Callback& callback);
+
+    size_t get_documents_count() const { return documents_count; }
+    const std::string& get_error() const { return error; }
+};
+
+}
+
+#endif
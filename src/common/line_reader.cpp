@@ -0,0 +1,75 @@
+#include "common/line_reader.h"
+#include <algorithm>
+
+namespace utils {
+
+size_t split_fields(std::string_view line, char delimiter,
+                    std::string_view* fields, size_t max_fields) {
+    if (max_fields == 0) return 0;
+
+    const char* p = line.data();
+    const char* end = p + line.size();
+    size_t count = 0;
+
+    while (count + 1 < max_fields) {
+        const void* hit = p < end ? std::memchr(p, delimiter, end - p) : nullptr;
+        if (!hit) break;
+        const char* field_end = static_cast<const char*>(hit);
+        fields[count++] = std::string_view(p, field_end - p);
+        p = field_end + 1;
+    }
+
+    fields[count++] = std::string_view(p, end - p);
+    return count;
+}
+
+std::vector<std::string_view> split_by_lines(std::string_view text, size_t parts) {
+    std::vector<std::string_view> chunks;
+    if (parts == 0) parts = 1;
+
+    size_t begin = 0;
+    for (size_t k = 1; k <= parts && begin < text.size(); ++k) {
+        size_t end = text.size();
+        if (k < parts) {
+            end = std::max(begin, text.size() / parts * k);
+            size_t newline = text.find('\n', end);
+            end = newline == std::string_view::npos ? text.size() : newline + 1;
+        }
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
+
+bool LineReader::open(const std::string& filename) {
+    if (!file.open(filename)) return false;
+    pos = file.data();
+    end = pos + file.size();
+    return true;
+}
+
+bool LineReader::next(std::string_view& line) {
+    if (pos >= end) return false;
+
+    const void* newline = std::memchr(pos, '\n', end - pos);
+    const char* line_end = newline ? static_cast<const char*>(newline) : end;
+    line = std::string_view(pos, line_end - pos);
+    pos = newline ? line_end + 1 : end;
+    return true;
+}
+
+bool LineReader::next_chunk(std::vector<std::string_view>& lines,
+                            size_t max_lines, size_t max_bytes) {
+    lines.clear();
+    size_t bytes = 0;
+
+    std::string_view line;
+    while (lines.size() < max_lines && bytes < max_bytes && next(line)) {
+        bytes += line.size();
+        lines.push_back(line);
+    }
+
+    return !lines.empty();
+}
+
+}
@@ -0,0 +1,59 @@
+#ifndef LINE_READER_H
+#define LINE_READER_H
+
+#include "common/mapped_file.h"
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace utils {
+
+// Разбивает line по первым (max_fields - 1) разделителям; последнее поле —
+// весь остаток строки. Возвращает число полей: меньше max_fields, если
+// разделителей не хватило. Поля указывают в line, ничего не копируется.
+size_t split_fields(std::string_view line, char delimiter,
+                    std::string_view* fields, size_t max_fields);
+
+// Вызывает f для каждого непустого куска str между разделителями
+template <typename F>
+void for_each_field(std::string_view str, char delimiter, F&& f) {
+    const char* p = str.data();
+    const char* end = p + str.size();
+    while (p < end) {
+        const void* hit = std::memchr(p, delimiter, end - p);
+        const char* field_end = hit ? static_cast<const char*>(hit) : end;
+        if (field_end > p) f(std::string_view(p, field_end - p));
+        p = field_end + 1;
+    }
+}
+
+// Делит text на parts кусков примерно равной длины. Граница куска
+// сдвигается на начало следующей строки, поэтому строки не разрезаются;
+// кусков может получиться меньше, если строк мало.
+std::vector<std::string_view> split_by_lines(std::string_view text, size_t parts);
+
+// Построчное чтение отображённого в память файла. Строки выдаются как
+// string_view внутрь отображения и живут, пока жив LineReader;
+// перевод строки в них не входит.
+class LineReader {
+private:
+    MappedFile file;
+    const char* pos = nullptr;
+    const char* end = nullptr;
+
+public:
+    bool open(const std::string& filename);
+
+    bool next(std::string_view& line);
+
+    // Следующая порция: не больше max_lines строк и примерно max_bytes байт.
+    // false, если строк больше нет.
+    bool next_chunk(std::vector<std::string_view>& lines, size_t max_lines, size_t max_bytes);
+
+    size_t size() const { return file.size(); }
+};
+
+}
+
+#endif
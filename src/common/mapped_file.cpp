@@ -0,0 +1,68 @@
+#include "common/mapped_file.h"
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace utils {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd == -1) {
+        std::cerr << "Ошибка открытия файла: " << filename << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        std::cerr << "Ошибка чтения размера файла: " << filename << std::endl;
+        close();
+        return false;
+    }
+
+    length = static_cast<size_t>(st.st_size);
+    if (length == 0) return true;
+
+    void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+        std::cerr << "Ошибка отображения файла в память: " << filename << std::endl;
+        length = 0;
+        close();
+        return false;
+    }
+
+    mapped = static_cast<const char*>(p);
+    madvise(p, length, MADV_SEQUENTIAL);
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapped) {
+        munmap(const_cast<char*>(mapped), length);
+        mapped = nullptr;
+    }
+    if (fd != -1) {
+        ::close(fd);
+        fd = -1;
+    }
+    length = 0;
+}
+
+void MappedFile::release_before(size_t offset) {
+    if (!mapped) return;
+
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t aligned = offset / page * page;
+    if (aligned == 0) return;
+
+    madvise(const_cast<char*>(mapped), aligned, MADV_DONTNEED);
+}
+
+}
@@ -0,0 +1,40 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+namespace utils {
+
+// Файл, отображённый в память только для чтения. Большие дампы читаются
+// без копирования в буфер; страницы подгружает ядро по мере обращения.
+class MappedFile {
+private:
+    const char* mapped = nullptr;
+    size_t length = 0;
+    int fd = -1;
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& filename);
+    void close();
+
+    bool is_open() const { return fd != -1; }
+    const char* data() const { return mapped; }
+    size_t size() const { return length; }
+    std::string_view view() const { return std::string_view(mapped, length); }
+
+    // Уже прочитанные страницы [0, offset) можно выгрузить: при
+    // последовательном проходе потребление памяти не растёт с размером файла
+    void release_before(size_t offset);
+};
+
+}
+
+#endif
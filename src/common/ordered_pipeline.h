@@ -0,0 +1,96 @@
+#ifndef ORDERED_PIPELINE_H
+#define ORDERED_PIPELINE_H
+
+#include "common/thread_pool.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+
+namespace utils {
+
+// Читатель -> задачи пула -> писатель.
+// Вызывающий поток режет вход на порции и отдаёт каждую пулу отдельной
+// задачей, а готовые результаты пишет строго в порядке чтения.
+// В работе одновременно не больше max_in_flight порций, считая ждущие
+// в буфере переупорядочивания, так что память не зависит от размера входа.
+//
+// read(In&) -> bool       следующая порция, false в конце входа
+// process(int worker, In&, Out&)   worker — номер потока пула для его локального состояния
+// write(Out&)             вызывается в исходном порядке из вызывающего потока
+template <typename In, typename Out, typename Read, typename Process, typename Write>
+void run_ordered_pipeline(ThreadPool& pool, size_t max_in_flight,
+                          Read read, Process process, Write write) {
+    if (pool.size() <= 1) {
+        In input;
+        while (read(input)) {
+            Out output;
+            process(0, input, output);
+            write(output);
+            input = In();
+        }
+        return;
+    }
+
+    if (max_in_flight < pool.size()) {
+        max_in_flight = pool.size();
+    }
+
+    std::mutex mutex;
+    std::condition_variable ready_cv;
+    std::map<size_t, Out> ready;
+    size_t submitted = 0;
+    size_t written = 0;
+    bool more_input = true;
+
+    TaskGroup group(pool);
+
+    while (true) {
+        // Всё, что готово подряд от следующего номера, сразу пишется
+        while (true) {
+            Out output;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = ready.find(written);
+                if (it == ready.end()) break;
+                output = std::move(it->second);
+                ready.erase(it);
+            }
+            write(output);
+            written++;
+        }
+
+        if (more_input && submitted - written < max_in_flight) {
+            auto input = std::make_shared<In>();
+            if (!read(*input)) {
+                more_input = false;
+                continue;
+            }
+
+            size_t seq = submitted++;
+            group.run([&, input, seq] {
+                Out output;
+                // Порции выполняют только потоки пула: вызывающий в это
+                // время читает и пишет, а не ждёт группу
+                process(static_cast<int>(pool.current_worker()), *input, output);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    ready.emplace(seq, std::move(output));
+                }
+                ready_cv.notify_one();
+            });
+            continue;
+        }
+
+        if (!more_input && written == submitted) break;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        ready_cv.wait(lock, [&] { return ready.count(written) > 0; });
+    }
+
+    group.wait();
+}
+}
+
+#endif
@@ -0,0 +1,60 @@
+#include "common/string_pool.h"
+#include <cstring>
+#include <utility>
+
+namespace utils {
+
+StringPool::StringPool(StringPool&& other) noexcept
+    : blocks(std::move(other.blocks)),
+      block_size(other.block_size),
+      current(std::exchange(other.current, nullptr)),
+      remaining(std::exchange(other.remaining, 0)),
+      used(std::exchange(other.used, 0)) {
+    other.blocks.clear();
+}
+
+StringPool& StringPool::operator=(StringPool&& other) noexcept {
+    if (this != &other) {
+        blocks = std::move(other.blocks);
+        other.blocks.clear();
+        block_size = other.block_size;
+        current = std::exchange(other.current, nullptr);
+        remaining = std::exchange(other.remaining, 0);
+        used = std::exchange(other.used, 0);
+    }
+    return *this;
+}
+
+std::string_view StringPool::store(std::string_view str) {
+    if (str.empty()) return std::string_view();
+
+    if (str.size() > remaining) {
+        // Длинная строка получает собственный блок, текущий не трогаем
+        if (str.size() > block_size / 4) {
+            blocks.emplace_back(new char[str.size()]);
+            std::memcpy(blocks.back().get(), str.data(), str.size());
+            used += str.size();
+            return std::string_view(blocks.back().get(), str.size());
+        }
+
+        blocks.emplace_back(new char[block_size]);
+        current = blocks.back().get();
+        remaining = block_size;
+    }
+
+    char* dst = current;
+    std::memcpy(dst, str.data(), str.size());
+    current += str.size();
+    remaining -= str.size();
+    used += str.size();
+    return std::string_view(dst, str.size());
+}
+
+void StringPool::clear() {
+    blocks.clear();
+    current = nullptr;
+    remaining = 0;
+    used = 0;
+}
+
+}
@@ -0,0 +1,38 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+namespace utils {
+
+// Арена для строк: копии складываются в крупные блоки и живут, пока жив
+// пул. Перемещение пула не инвалидирует выданные string_view.
+class StringPool {
+private:
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t block_size;
+    char* current = nullptr;
+    size_t remaining = 0;
+    size_t used = 0;
+
+public:
+    explicit StringPool(size_t block_bytes = 64 * 1024) : block_size(block_bytes) {}
+
+    // Блоки переходят к новому владельцу, исходный пул становится пустым:
+    // его current не должен указывать в чужой блок
+    StringPool(StringPool&& other) noexcept;
+    StringPool& operator=(StringPool&& other) noexcept;
+
+    std::string_view store(std::string_view str);
+
+    size_t bytes_used() const { return used; }
+
+    void clear();
+};
+
+}
+
+#endif
@@ -0,0 +1,198 @@
+#include "common/thread_pool.h"
+#include "common/trace.h"
+#include "common/utils.h"
+#include <chrono>
+#include <iostream>
+
+namespace utils {
+
+namespace {
+
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_index = 0;
+
+std::mutex shared_mutex;
+std::unique_ptr<ThreadPool> shared_pool;
+int shared_threads = 0;
+
+uint64_t elapsed_us(std::chrono::steady_clock::time_point since) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - since).count());
+}
+
+}
+
+ThreadPool::ThreadPool(int thread_count) {
+    size_t count = thread_count > 0 ? static_cast<size_t>(thread_count) : 1;
+    for (size_t i = 0; i < count; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < count; ++i) {
+        threads.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+size_t ThreadPool::current_worker() const {
+    return current_pool == this ? current_index : size();
+}
+
+void ThreadPool::push(Task task) {
+    // Задача из рабочего потока остаётся в его очереди, извне —
+    // раздаётся по очередям по кругу
+    size_t target = current_worker();
+    if (target == size()) target = next_queue++ % size();
+
+    {
+        std::lock_guard<std::mutex> lock(workers[target]->mutex);
+        workers[target]->tasks.push_back(std::move(task));
+    }
+    queued++;
+
+    // Пустая критическая секция не даёт потерять пробуждение потока,
+    // который только что проверил queued и собирается заснуть
+    { std::lock_guard<std::mutex> lock(sleep_mutex); }
+    wake.notify_one();
+}
+
+bool ThreadPool::try_pop(size_t self, Task& task) {
+    size_t n = size();
+    if (self < n) {
+        Worker& own = *workers[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+
+    size_t start = self < n ? self + 1 : next_queue.load();
+    for (size_t k = 0; k < n; ++k) {
+        size_t victim = (start + k) % n;
+        if (victim == self) continue;
+
+        Worker& other = *workers[victim];
+        std::lock_guard<std::mutex> lock(other.mutex);
+        if (other.tasks.empty()) continue;
+
+        task = std::move(other.tasks.front());
+        other.tasks.pop_front();
+        queued--;
+        if (self < n) workers[self]->steals++;
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::execute(Task& task) {
+    task.run();
+    if (task.group) task.group->finish_one();
+}
+
+void ThreadPool::worker_loop(size_t index) {
+    current_pool = this;
+    current_index = index;
+    Worker& self = *workers[index];
+    trace::set_thread_name("pool-" + std::to_string(index));
+
+    while (true) {
+        Task task;
+        if (try_pop(index, task)) {
+            auto start = std::chrono::steady_clock::now();
+            execute(task);
+            self.busy_us += elapsed_us(start);
+            self.executed++;
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        wake.wait(lock, [this] { return stopping || queued > 0; });
+        self.idle_us += elapsed_us(start);
+        if (stopping && queued == 0) return;
+    }
+}
+
+bool ThreadPool::run_pending() {
+    Task task;
+    size_t self = current_worker();
+    if (!try_pop(self, task)) return false;
+
+    execute(task);
+    // Время уже входит во время задачи, которая здесь ждёт свою группу
+    if (self < size()) workers[self]->executed++;
+    return true;
+}
+
+std::vector<ThreadPool::WorkerStatistics> ThreadPool::get_statistics() const {
+    std::vector<WorkerStatistics> result;
+    for (const auto& worker : workers) {
+        WorkerStatistics stats;
+        stats.tasks = worker->executed;
+        stats.steals = worker->steals;
+        stats.busy_ms = worker->busy_us / 1000.0;
+        stats.idle_ms = worker->idle_us / 1000.0;
+        result.push_back(stats);
+    }
+    return result;
+}
+
+void ThreadPool::print_statistics() const {
+    std::cout << "\nПул потоков: " << size() << " поток(ов)" << std::endl;
+    auto stats = get_statistics();
+    for (size_t i = 0; i < stats.size(); ++i) {
+        std::cout << "  поток " << i << ": задач " << stats[i].tasks
+                  << ", перехвачено " << stats[i].steals
+                  << ", работа " << stats[i].busy_ms << " мс"
+                  << ", простой " << stats[i].idle_ms << " мс" << std::endl;
+    }
+}
+
+void ThreadPool::configure_shared(int thread_count) {
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    shared_threads = thread_count;
+    shared_pool.reset();
+}
+
+ThreadPool& ThreadPool::shared() {
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    if (!shared_pool) {
+        shared_pool = std::make_unique<ThreadPool>(
+            shared_threads > 0 ? shared_threads : default_thread_count());
+    }
+    return *shared_pool;
+}
+
+void TaskGroup::finish_one() {
+    // Под мьютексом: иначе ждущий может увидеть ноль и разрушить группу,
+    // пока этот поток ещё её трогает
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--pending == 0) done.notify_all();
+}
+
+void TaskGroup::wait() {
+    while (pending > 0) {
+        if (pool.run_pending()) continue;
+
+        // Задачи группы выполняются другими потоками; новые задачи в
+        // очередях проверяются снова через миллисекунду
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait_for(lock, std::chrono::milliseconds(1), [this] { return pending == 0; });
+    }
+    // Последний finish_one мог ещё не отпустить мьютекс
+    std::lock_guard<std::mutex> lock(mutex);
+}
+
+}
@@ -0,0 +1,153 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utils {
+
+class TaskGroup;
+
+// Общий планировщик задач с перехватом работы. У каждого рабочего потока
+// своя двусторонняя очередь: свои задачи он берёт с хвоста (последняя
+// порождённая задача ещё в кэше), а опустевший поток забирает самую
+// старую задачу из головы чужой очереди.
+//
+// Ожидание группы не простаивает: пока группа не завершена, ждущий поток
+// выполняет задачи из очередей, поэтому вложенный параллелизм не зависает.
+// Между стадиями конвейера данные передаются через BoundedQueue.
+class ThreadPool {
+public:
+    struct WorkerStatistics {
+        uint64_t tasks = 0;
+        // Задачи, взятые из чужой очереди
+        uint64_t steals = 0;
+        double busy_ms = 0;
+        double idle_ms = 0;
+    };
+
+private:
+    struct Task {
+        std::function<void()> run;
+        TaskGroup* group = nullptr;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> steals{0};
+        std::atomic<uint64_t> busy_us{0};
+        std::atomic<uint64_t> idle_us{0};
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    // Задач во всех очередях; спящий поток просыпается, когда оно больше нуля
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> next_queue{0};
+    bool stopping = false;
+
+    void push(Task task);
+    bool try_pop(size_t self, Task& task);
+    void execute(Task& task);
+    void worker_loop(size_t index);
+
+    friend class TaskGroup;
+
+public:
+    explicit ThreadPool(int thread_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    // Номер рабочего потока этого пула, из которого сделан вызов.
+    // Все прочие потоки получают size(), поэтому массив локальных
+    // состояний по номеру потока заводится на size() + 1 элемент.
+    size_t current_worker() const;
+
+    // Выполняет одну задачу из любой очереди; false, если задач нет
+    bool run_pending();
+
+    // f(lo, hi) по кускам [begin, end) не короче grain. Куски раздаются
+    // задачами, около четырёх на поток, чтобы перехват выравнивал нагрузку.
+    template <typename F>
+    void parallel_for(size_t begin, size_t end, size_t grain, F f);
+
+    std::vector<WorkerStatistics> get_statistics() const;
+
+    void print_statistics() const;
+
+    // Пул процесса. Размер задаётся до первого обращения, обычно из
+    // --threads; без этого берётся число ядер.
+    static void configure_shared(int thread_count);
+    static ThreadPool& shared();
+};
+
+// Набор задач, завершения которых можно дождаться. Задачи группы могут
+// порождать новые задачи в ту же или в другую группу.
+class TaskGroup {
+private:
+    ThreadPool& pool;
+    std::atomic<size_t> pending{0};
+    std::mutex mutex;
+    std::condition_variable done;
+
+    void finish_one();
+
+    friend class ThreadPool;
+
+public:
+    explicit TaskGroup(ThreadPool& p) : pool(p) {}
+    ~TaskGroup() { wait(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename F>
+    void run(F f) {
+        pending++;
+        pool.push({std::function<void()>(std::move(f)), this});
+    }
+
+    void wait();
+};
+
+template <typename F>
+void ThreadPool::parallel_for(size_t begin, size_t end, size_t grain, F f) {
+    if (begin >= end) return;
+
+    size_t count = end - begin;
+    size_t pieces = size() * 4;
+    size_t step = std::max<size_t>(std::max<size_t>(grain, 1), (count + pieces - 1) / pieces);
+    if (size() <= 1 || step >= count) {
+        f(begin, end);
+        return;
+    }
+
+    TaskGroup group(*this);
+    for (size_t lo = begin; lo < end; lo += step) {
+        size_t hi = std::min(end, lo + step);
+        group.run([&f, lo, hi] { f(lo, hi); });
+    }
+    group.wait();
+}
+
+}
+
+#endif
@@ -0,0 +1,355 @@
+#include "common/trace.h"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+
+namespace {
+
+// Больше интервалов на поток не пишется: трасса долгого прогона
+// не должна съесть память
+const size_t MAX_EVENTS_PER_THREAD = 1 << 20;
+
+struct Event {
+    const char* name;
+    uint64_t start_us;
+    uint64_t duration_us;
+};
+
+// Блоки только дописываются: читатель видит первые size событий блока
+// и следующий блок по next, не останавливая пишущий поток
+struct Block {
+    static const size_t CAPACITY = 4096;
+
+    Event events[CAPACITY];
+    std::atomic<size_t> size{0};
+    std::atomic<Block*> next{nullptr};
+};
+
+struct ThreadBuffer {
+    uint32_t tid = 0;
+    std::string name;
+    Block* head = nullptr;
+    Block* tail = nullptr;
+    size_t recorded = 0;
+};
+
+struct MetricEntry {
+    std::string help;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Histogram> histogram;
+};
+
+// Реестр трогается только при первом событии потока, при регистрации
+// метрики и при выводе; запись событий идёт мимо него
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> threads;
+    std::vector<std::unique_ptr<Block>> blocks;
+    std::map<std::string, MetricEntry> metrics;
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+std::atomic<bool> tracing{false};
+std::atomic<uint64_t> dropped{0};
+
+const auto epoch = std::chrono::steady_clock::now();
+
+uint64_t now_us() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - epoch).count());
+}
+
+thread_local ThreadBuffer* local_buffer = nullptr;
+
+ThreadBuffer& thread_buffer() {
+    if (!local_buffer) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.threads.push_back(std::make_unique<ThreadBuffer>());
+        local_buffer = r.threads.back().get();
+        local_buffer->tid = static_cast<uint32_t>(r.threads.size());
+    }
+    return *local_buffer;
+}
+
+Block* new_block() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.blocks.push_back(std::make_unique<Block>());
+    return r.blocks.back().get();
+}
+
+void record_event(const char* name, uint64_t start_us, uint64_t duration_us) {
+    ThreadBuffer& buffer = thread_buffer();
+    if (buffer.recorded >= MAX_EVENTS_PER_THREAD) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (!buffer.tail || buffer.tail->size.load(std::memory_order_relaxed) == Block::CAPACITY) {
+        Block* block = new_block();
+        if (buffer.tail) {
+            buffer.tail->next.store(block, std::memory_order_release);
+        } else {
+            buffer.head = block;
+        }
+        buffer.tail = block;
+    }
+
+    Block* block = buffer.tail;
+    size_t size = block->size.load(std::memory_order_relaxed);
+    block->events[size] = {name, start_us, duration_us};
+    block->size.store(size + 1, std::memory_order_release);
+    buffer.recorded++;
+}
+
+void write_json_string(std::ostream& out, const std::string& str) {
+    out << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out << ' ';
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+bool take_option(const std::string& arg, const char* name, int& i, int argc, char* argv[],
+                 std::string& value) {
+    std::string prefix = std::string(name) + "=";
+    if (arg == name && i + 1 < argc) {
+        value = argv[++i];
+        return true;
+    }
+    if (arg.rfind(prefix, 0) == 0) {
+        value = arg.substr(prefix.size());
+        return true;
+    }
+    return false;
+}
+
+}
+
+bool enabled() {
+    return tracing.load(std::memory_order_relaxed);
+}
+
+void set_enabled(bool on) {
+    tracing.store(on, std::memory_order_relaxed);
+}
+
+void set_thread_name(const std::string& name) {
+    ThreadBuffer& buffer = thread_buffer();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    buffer.name = name;
+}
+
+Span::Span(const char* span_name, Histogram* latency_us)
+    : name(span_name), start_us(now_us()), latency(latency_us) {}
+
+Span::~Span() {
+    uint64_t duration = now_us() - start_us;
+    if (latency) latency->record(duration);
+    if (enabled()) record_event(name, start_us, duration);
+}
+
+double Span::elapsed_ms() const {
+    return (now_us() - start_us) / 1000.0;
+}
+
+size_t Histogram::bucket_of(uint64_t value) {
+    if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+
+    int exponent = 63 - __builtin_clzll(value);
+    size_t sub = static_cast<size_t>(value >> (exponent - 4)) & (SUB_BUCKETS - 1);
+    return SUB_BUCKETS + static_cast<size_t>(exponent - 4) * SUB_BUCKETS + sub;
+}
+
+uint64_t Histogram::bucket_upper(size_t bucket) {
+    if (bucket < SUB_BUCKETS) return bucket;
+
+    size_t exponent = (bucket - SUB_BUCKETS) / SUB_BUCKETS + 4;
+    uint64_t sub = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+    uint64_t width = uint64_t(1) << (exponent - 4);
+    uint64_t lower = (SUB_BUCKETS + sub) * width;
+    return lower + (width - 1);
+}
+
+void Histogram::record(uint64_t value) {
+    buckets[bucket_of(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum_of_values.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t current = max_value.load(std::memory_order_relaxed);
+    while (value > current &&
+           !max_value.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t Histogram::percentile(double q) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(q * n);
+    if (rank >= n) rank = n - 1;
+
+    uint64_t seen = 0;
+    for (size_t b = 0; b < BUCKETS; ++b) {
+        seen += bucket_count(b);
+        if (seen > rank) return std::min(bucket_upper(b), max());
+    }
+    return max();
+}
+
+Counter& counter(const std::string& name, const std::string& help) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    MetricEntry& entry = r.metrics[name];
+    if (!entry.counter) {
+        entry.counter = std::make_unique<Counter>();
+        entry.help = help;
+    }
+    return *entry.counter;
+}
+
+Histogram& histogram(const std::string& name, const std::string& help) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    MetricEntry& entry = r.metrics[name];
+    if (!entry.histogram) {
+        entry.histogram = std::make_unique<Histogram>();
+        entry.help = help;
+    }
+    return *entry.histogram;
+}
+
+bool write_chrome_trace(const std::string& filename) {
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        std::cerr << "Ошибка создания файла трассы: " << filename << std::endl;
+        return false;
+    }
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    auto separator = [&]() {
+        out << (first ? "\n" : ",\n");
+        first = false;
+    };
+
+    for (const auto& buffer : r.threads) {
+        if (!buffer->name.empty()) {
+            separator();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"args\":{\"name\":";
+            write_json_string(out, buffer->name);
+            out << "}}";
+        }
+
+        for (Block* block = buffer->head; block; block = block->next.load(std::memory_order_acquire)) {
+            size_t size = block->size.load(std::memory_order_acquire);
+            for (size_t i = 0; i < size; ++i) {
+                const Event& event = block->events[i];
+                separator();
+                out << "{\"name\":";
+                write_json_string(out, event.name);
+                out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                    << ",\"ts\":" << event.start_us << ",\"dur\":" << event.duration_us << "}";
+            }
+        }
+    }
+    out << "\n]}\n";
+
+    if (dropped > 0) {
+        std::cerr << "Трасса: отброшено " << dropped << " интервалов сверх лимита" << std::endl;
+    }
+    return true;
+}
+
+void write_metrics(std::ostream& out) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    for (const auto& [name, entry] : r.metrics) {
+        if (!entry.help.empty()) {
+            out << "# HELP " << name << " " << entry.help << "\n";
+        }
+
+        if (entry.counter) {
+            out << "# TYPE " << name << " counter\n";
+            out << name << " " << entry.counter->get() << "\n";
+            continue;
+        }
+
+        // Выводятся только непустые корзины: их границы и так возрастают
+        const Histogram& h = *entry.histogram;
+        out << "# TYPE " << name << " histogram\n";
+        uint64_t cumulative = 0;
+        for (size_t b = 0; b < Histogram::BUCKETS; ++b) {
+            uint64_t n = h.bucket_count(b);
+            if (n == 0) continue;
+            cumulative += n;
+            out << name << "_bucket{le=\"" << Histogram::bucket_upper(b) << "\"} " << cumulative << "\n";
+        }
+        out << name << "_bucket{le=\"+Inf\"} " << h.count() << "\n";
+        out << name << "_sum " << h.sum() << "\n";
+        out << name << "_count " << h.count() << "\n";
+    }
+}
+
+bool write_metrics(const std::string& filename) {
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        std::cerr << "Ошибка создания файла метрик: " << filename << std::endl;
+        return false;
+    }
+    write_metrics(out);
+    return true;
+}
+
+Session::Session(int& argc, char* argv[]) {
+    int out = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (take_option(arg, "--trace", i, argc, argv, trace_file)) continue;
+        if (take_option(arg, "--metrics", i, argc, argv, metrics_file)) continue;
+        argv[out++] = argv[i];
+    }
+    argc = out;
+    argv[argc] = nullptr;
+
+    if (!trace_file.empty()) {
+        set_enabled(true);
+        set_thread_name("main");
+    }
+}
+
+Session::~Session() {
+    if (!trace_file.empty()) {
+        set_enabled(false);
+        if (write_chrome_trace(trace_file)) {
+            std::cout << "Трасса сохранена: " << trace_file << std::endl;
+        }
+    }
+    if (!metrics_file.empty() && write_metrics(metrics_file)) {
+        std::cout << "Метрики сохранены: " << metrics_file << std::endl;
+    }
+}
+
+}
@@ -0,0 +1,114 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Трассировка и метрики для всех стадий.
+//
+// Span — интервал с именем и номером потока, в формате Chrome trace
+// (chrome://tracing, Perfetto). Интервалы пишутся в буфер своего потока
+// без блокировок и записываются только после set_enabled(true).
+// Счётчики и гистограммы — атомарные, включены всегда и выводятся
+// текстом в формате Prometheus.
+//
+// Session в main разбирает --trace FILE и --metrics FILE и пишет файлы
+// при выходе из main.
+namespace trace {
+
+bool enabled();
+void set_enabled(bool on);
+
+// Имя потока в трассе, например "pool-3"
+void set_thread_name(const std::string& name);
+
+class Histogram;
+
+// Интервал от конструктора до деструктора. Имя — строковый литерал:
+// хранится только указатель. Заодно работает как utils::Timer.
+class Span {
+private:
+    const char* name;
+    uint64_t start_us;
+    Histogram* latency;
+
+public:
+    explicit Span(const char* span_name, Histogram* latency_us = nullptr);
+    ~Span();
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    double elapsed_ms() const;
+};
+
+class Counter {
+private:
+    std::atomic<uint64_t> value{0};
+
+public:
+    void add(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+};
+
+// Гистограмма с корзинами как в HdrHistogram: значения до 16 точные,
+// дальше каждая степень двойки делится на 16 корзин, так что
+// относительная погрешность не больше 1/16 на всём диапазоне uint64.
+class Histogram {
+public:
+    static const size_t SUB_BUCKETS = 16;
+    static const size_t BUCKETS = SUB_BUCKETS + 60 * SUB_BUCKETS;
+
+private:
+    std::atomic<uint64_t> buckets[BUCKETS] = {};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum_of_values{0};
+    std::atomic<uint64_t> max_value{0};
+
+public:
+    static size_t bucket_of(uint64_t value);
+    // Наибольшее значение, попадающее в корзину
+    static uint64_t bucket_upper(size_t bucket);
+
+    void record(uint64_t value);
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_of_values.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_value.load(std::memory_order_relaxed); }
+    uint64_t bucket_count(size_t bucket) const {
+        return buckets[bucket].load(std::memory_order_relaxed);
+    }
+
+    // Верхняя граница корзины, в которой лежит q-квантиль (q от 0 до 1)
+    uint64_t percentile(double q) const;
+};
+
+// Метрики регистрируются по имени и живут до конца процесса, поэтому
+// ссылку удобно держать в static: static auto& docs = trace::counter(...)
+Counter& counter(const std::string& name, const std::string& help = "");
+Histogram& histogram(const std::string& name, const std::string& help = "");
+
+bool write_chrome_trace(const std::string& filename);
+void write_metrics(std::ostream& out);
+bool write_metrics(const std::string& filename);
+
+class Session {
+private:
+    std::string trace_file;
+    std::string metrics_file;
+
+public:
+    // Вынимает из argv --trace FILE и --metrics FILE (или --trace=FILE),
+    // argc уменьшается, как у utils::extract_threads_option
+    Session(int& argc, char* argv[]);
+    ~Session();
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,134 @@
+#include "common/utf8.h"
+
+namespace utf8 {
+
+char32_t decode(const char* p, const char* end, int& length) {
+    unsigned char c0 = static_cast<unsigned char>(p[0]);
+    length = 1;
+
+    if (c0 < 0x80) return c0;
+
+    int need;
+    char32_t cp;
+    if ((c0 & 0xE0) == 0xC0) {
+        need = 2;
+        cp = c0 & 0x1F;
+    } else if ((c0 & 0xF0) == 0xE0) {
+        need = 3;
+        cp = c0 & 0x0F;
+    } else if ((c0 & 0xF8) == 0xF0) {
+        need = 4;
+        cp = c0 & 0x07;
+    } else {
+        return INVALID;
+    }
+
+    if (end - p < need) return INVALID;
+
+    for (int i = 1; i < need; ++i) {
+        unsigned char c = static_cast<unsigned char>(p[i]);
+        if ((c & 0xC0) != 0x80) return INVALID;
+        cp = (cp << 6) | (c & 0x3F);
+    }
+
+    // Отсекаем overlong-формы и суррогаты
+    static const char32_t min_cp[5] = {0, 0, 0x80, 0x800, 0x10000};
+    if (cp < min_cp[need] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+        return INVALID;
+    }
+
+    length = need;
+    return cp;
+}
+
+char32_t decode_backward(const char* begin, const char* end, int& length) {
+    const char* p = end - 1;
+    int steps = 1;
+    while (p > begin && steps < 4 && (static_cast<unsigned char>(*p) & 0xC0) == 0x80) {
+        --p;
+        ++steps;
+    }
+
+    int decoded_length;
+    char32_t cp = decode(p, end, decoded_length);
+    if (cp == INVALID || decoded_length != steps) {
+        length = 1;
+        return INVALID;
+    }
+    length = decoded_length;
+    return cp;
+}
+
+int encode(char32_t cp, char* out) {
+    if (cp < 0x80) {
+        out[0] = static_cast<char>(cp);
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (cp >> 6));
+        out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = static_cast<char>(0xE0 | (cp >> 12));
+        out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = static_cast<char>(0xF0 | (cp >> 18));
+    out[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = static_cast<char>(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+void append(std::string& out, char32_t cp) {
+    char bytes[4];
+    int n = encode(cp, bytes);
+    out.append(bytes, n);
+}
+
+size_t length(std::string_view str) {
+    size_t count = 0;
+    for (char c : str) {
+        if ((static_cast<unsigned char>(c) & 0xC0) != 0x80) count++;
+    }
+    return count;
+}
+
+std::string to_lower(std::string_view str) {
+    std::string result;
+    result.reserve(str.size());
+
+    const char* p = str.data();
+    const char* end = p + str.size();
+    while (p < end) {
+        int len;
+        char32_t cp = decode(p, end, len);
+        if (cp == INVALID) {
+            result.push_back(*p);
+        } else {
+            append(result, to_lower(cp));
+        }
+        p += len;
+    }
+    return result;
+}
+
+bool has_cyrillic(std::string_view str) {
+    const char* p = str.data();
+    const char* end = p + str.size();
+    while (p < end) {
+        if (static_cast<unsigned char>(*p) < 0x80) {
+            ++p;
+            continue;
+        }
+        int len;
+        char32_t cp = decode(p, end, len);
+        if (cp >= CYRILLIC_FIRST && cp <= CYRILLIC_LAST) return true;
+        p += len;
+    }
+    return false;
+}
+
+}
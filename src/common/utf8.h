@@ -0,0 +1,106 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <string>
+#include <array>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+namespace utf8 {
+
+enum CharClass : uint8_t {
+    SEPARATOR = 0,
+    LETTER = 1,
+    DIGIT = 2,
+    JOINER = 3  // '-' и '\'' внутри токена: "mercedes-benz", "o'neil"
+};
+
+struct CharInfo {
+    CharClass cls;
+    char32_t lower;
+};
+
+constexpr char32_t CYRILLIC_FIRST = 0x400;
+constexpr char32_t CYRILLIC_LAST = 0x45F;
+
+namespace detail {
+
+constexpr std::array<CharInfo, 128> make_ascii_table() {
+    std::array<CharInfo, 128> table{};
+    for (char32_t c = 0; c < 128; ++c) {
+        table[c] = {SEPARATOR, c};
+    }
+    for (char32_t c = 'a'; c <= 'z'; ++c) {
+        table[c] = {LETTER, c};
+    }
+    for (char32_t c = 'A'; c <= 'Z'; ++c) {
+        table[c] = {LETTER, c + ('a' - 'A')};
+    }
+    for (char32_t c = '0'; c <= '9'; ++c) {
+        table[c] = {DIGIT, c};
+    }
+    table['-'] = {JOINER, '-'};
+    table['\''] = {JOINER, '\''};
+    return table;
+}
+
+constexpr std::array<CharInfo, CYRILLIC_LAST - CYRILLIC_FIRST + 1> make_cyrillic_table() {
+    std::array<CharInfo, CYRILLIC_LAST - CYRILLIC_FIRST + 1> table{};
+    for (char32_t c = CYRILLIC_FIRST; c <= CYRILLIC_LAST; ++c) {
+        char32_t lower = c;
+        if (c >= 0x410 && c <= 0x42F) {
+            lower = c + 0x20;   // А-Я -> а-я
+        } else if (c <= 0x40F) {
+            lower = c + 0x50;   // Ё, Є, І, Ї, Ў ... -> строчные
+        }
+        table[c - CYRILLIC_FIRST] = {LETTER, lower};
+    }
+    return table;
+}
+
+}
+
+// Латиница и цифры: прямой индекс по байту
+inline constexpr auto ascii_table = detail::make_ascii_table();
+
+// Кириллица U+0400..U+045F: индекс cp - 0x400
+inline constexpr auto cyrillic_table = detail::make_cyrillic_table();
+
+constexpr char32_t INVALID = 0xFFFFFFFF;
+
+constexpr CharInfo classify(char32_t cp) {
+    if (cp < 0x80) return ascii_table[cp];
+    if (cp >= CYRILLIC_FIRST && cp <= CYRILLIC_LAST) return cyrillic_table[cp - CYRILLIC_FIRST];
+    return {SEPARATOR, cp};
+}
+
+constexpr bool is_token_char(char32_t cp) {
+    return classify(cp).cls != SEPARATOR;
+}
+
+constexpr char32_t to_lower(char32_t cp) {
+    return classify(cp).lower;
+}
+
+// Декодирует один символ с позиции p. Возвращает INVALID для битой
+// последовательности; length всегда >= 1, чтобы можно было пропустить байт.
+char32_t decode(const char* p, const char* end, int& length);
+
+// Декодирует символ, который заканчивается перед end (обратный проход)
+char32_t decode_backward(const char* begin, const char* end, int& length);
+
+// Пишет cp в out, возвращает число байт (1..4)
+int encode(char32_t cp, char* out);
+
+void append(std::string& out, char32_t cp);
+
+size_t length(std::string_view str);
+
+std::string to_lower(std::string_view str);
+
+bool has_cyrillic(std::string_view str);
+
+}
+
+#endif
@@ -1,21 +1,20 @@
 #include "common/utils.h"
+#include "common/json_reader.h"
+#include "common/line_reader.h"
+#include <charconv>
+#include <cstring>
 #include <iostream>
 #include <chrono>
-#include <locale>
-#include <codecvt>
+#include <thread>
 
 namespace utils {
 
 std::vector<std::string> split(const std::string& str, char delimiter) {
     std::vector<std::string> tokens;
-    std::stringstream ss(str);
-    std::string token;
     
-    while (std::getline(ss, token, delimiter)) {
-        if (!token.empty()) {
-            tokens.push_back(token);
-        }
-    }
+    for_each_field(str, delimiter, [&tokens](std::string_view token) {
+        tokens.emplace_back(token);
+    });
     
     return tokens;
 }
@@ -48,97 +47,13 @@ bool is_letter(char c) {
 
 std::vector<Document> read_json_corpus(const std::string& filename) {
     std::vector<Document> documents;
-    std::ifstream file(filename);
-    
-    if (!file.is_open()) {
-        std::cerr << "Ошибка открытия файла: " << filename << std::endl;
-        return documents;
-    }
-    
-    file.imbue(std::locale("en_US.UTF-8"));
-    
-    std::string line;
-    std::string current_json;
-    bool in_object = false;
-    int brace_count = 0;
-    
-    while (std::getline(file, line)) {
-        for (char c : line) {
-            if (c == '{') {
-                brace_count++;
-                in_object = true;
-            } else if (c == '}') {
-                brace_count--;
-            }
-        }
-        
-        if (in_object) {
-            current_json += line + "\n";
-        }
-        
-        if (in_object && brace_count == 0) {
-            Document doc;
-            doc.doc_id = documents.size();
-            
-            std::istringstream iss(current_json);
-            std::string json_line;
-            
-            while (std::getline(iss, json_line)) {
-                json_line = trim(json_line);
-                
-                if (json_line.find("\"source\"") != std::string::npos) {
-                    size_t start = json_line.find(":") + 1;
-                    size_t first_quote = json_line.find("\"", start);
-                    size_t second_quote = json_line.find("\"", first_quote + 1);
-                    if (first_quote != std::string::npos && second_quote != std::string::npos) {
-                        doc.source = json_line.substr(first_quote + 1, second_quote - first_quote - 1);
-                    }
-                }
-                else if (json_line.find("\"title\"") != std::string::npos) {
-                    size_t start = json_line.find(":") + 1;
-                    size_t first_quote = json_line.find("\"", start);
-                    size_t second_quote = json_line.find("\"", first_quote + 1);
-                    if (first_quote != std::string::npos && second_quote != std::string::npos) {
-                        doc.title = json_line.substr(first_quote + 1, second_quote - first_quote - 1);
-                    }
-                }
-                else if (json_line.find("\"content\"") != std::string::npos || 
-                         json_line.find("\"text\"") != std::string::npos) {
-                    size_t start = json_line.find(":") + 1;
-                    size_t first_quote = json_line.find("\"", start);
-                    
-                    if (first_quote != std::string::npos) {
-                        std::string text_content;
-                        size_t second_quote = json_line.find("\"", first_quote + 1);
-                        
-                        if (second_quote != std::string::npos) {
-                            text_content = json_line.substr(first_quote + 1, second_quote - first_quote - 1);
-                        }
-                        
-                        doc.text = text_content;
-                    }
-                }
-                else if (json_line.find("\"url\"") != std::string::npos) {
-                    size_t start = json_line.find(":") + 1;
-                    size_t first_quote = json_line.find("\"", start);
-                    size_t second_quote = json_line.find("\"", first_quote + 1);
-                    if (first_quote != std::string::npos && second_quote != std::string::npos) {
-                        doc.url = json_line.substr(first_quote + 1, second_quote - first_quote - 1);
-                    }
-                }
-            }
-            
-            if (!doc.title.empty() && !doc.text.empty()) {
-                documents.push_back(doc);
-            }
-            
-            current_json.clear();
-            in_object = false;
-            brace_count = 0;
-        }
-    }
     
-    file.close();
+    JsonCorpusReader reader;
+    reader.read_file(filename, [&documents](Document& doc) {
+        if (doc.title.empty() || doc.text.empty()) return;
+        doc.doc_id = documents.size();
+        documents.push_back(doc);
+    });
     
     std::cout << "Прочитано " << documents.size() << " документов из JSON" << std::endl;
     return documents;
@@ -153,65 +68,119 @@ void write_documents_txt(const std::vector<Document>& docs, const std::string& f
     }
     
     for (const auto& doc : docs) {
-        std::string clean_text = doc.text;
-        std::replace(clean_text.begin(), clean_text.end(), '|', ' ');
-        
-        std::string clean_title = doc.title;
-        std::replace(clean_title.begin(), clean_title.end(), '|', ' ');
-        
-        file << doc.doc_id << "|" 
-             << doc.source << "|" 
-             << clean_title << "|" 
-             << doc.url << "|" 
-             << clean_text << "\n";
+        write_document_line(file, doc);
     }
     
     file.close();
     std::cout << "Сохранено " << docs.size() << " документов в " << filename << std::endl;
 }
 
+void sanitize_field(std::string& field) {
+    for (char& c : field) {
+        if (c == '|' || c == '\n' || c == '\r') c = ' ';
+    }
+}
+
+void write_document_line(std::ostream& out, const Document& doc) {
+    std::string clean_text = doc.text;
+    sanitize_field(clean_text);
+    
+    std::string clean_title = doc.title;
+    sanitize_field(clean_title);
+    
+    out << doc.doc_id << "|" 
+        << doc.source << "|" 
+        << clean_title << "|" 
+        << doc.url << "|" 
+        << clean_text << "\n";
+}
+
+bool parse_document_line(std::string_view line, Document& doc) {
+    std::string_view fields[5];
+    if (split_fields(line, '|', fields, 5) < 5) return false;
+    
+    auto result = std::from_chars(fields[0].data(), fields[0].data() + fields[0].size(), doc.doc_id);
+    if (result.ec != std::errc() || fields[0].empty()) return false;
+    
+    doc.source.assign(fields[1]);
+    doc.title.assign(fields[2]);
+    doc.url.assign(fields[3]);
+    doc.text.assign(fields[4]);
+    return true;
+}
+
 std::vector<Document> read_documents_txt(const std::string& filename) {
     std::vector<Document> documents;
-    std::ifstream file(filename);
     
-    if (!file.is_open()) {
-        std::cerr << "Ошибка открытия файла: " << filename << std::endl;
+    LineReader reader;
+    if (!reader.open(filename)) {
         return documents;
     }
     
-    std::string line;
-    while (std::getline(file, line)) {
+    std::string_view line;
+    while (reader.next(line)) {
         if (line.empty()) continue;
         
-        size_t pos1 = line.find('|');
-        if (pos1 == std::string::npos) continue;
-        
-        size_t pos2 = line.find('|', pos1 + 1);
-        if (pos2 == std::string::npos) continue;
-        
-        size_t pos3 = line.find('|', pos2 + 1);
-        if (pos3 == std::string::npos) continue;
-        
-        size_t pos4 = line.find('|', pos3 + 1);
-        if (pos4 == std::string::npos) continue;
-        
         Document doc;
-        try {
-            doc.doc_id = std::stoi(line.substr(0, pos1));
-            doc.source = line.substr(pos1 + 1, pos2 - pos1 - 1);
-            doc.title = line.substr(pos2 + 1, pos3 - pos2 - 1);
-            doc.url = line.substr(pos3 + 1, pos4 - pos3 - 1);
-            doc.text = line.substr(pos4 + 1);
-            
-            documents.push_back(doc);
-        } catch (...) {
+        if (!parse_document_line(line, doc)) {
             std::cerr << "Ошибка парсинга строки " << documents.size() << std::endl;
             continue;
         }
+        documents.push_back(doc);
     }
     
-    file.close();
     return documents;
 }
 
+int default_thread_count() {
+    unsigned int n = std::thread::hardware_concurrency();
+    return n > 0 ? static_cast<int>(n) : 1;
+}
+
+int extract_threads_option(int& argc, char* argv[], int default_threads) {
+    int threads = default_threads;
+    int out = 1;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value;
+        
+        if (arg == "--threads" && i + 1 < argc) {
+            value = argv[++i];
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            value = arg.substr(10);
+        } else {
+            argv[out++] = argv[i];
+            continue;
+        }
+        
+        try {
+            threads = std::max(1, std::stoi(value));
+        } catch (...) {
+            std::cerr << "Некорректное число потоков: " << value << std::endl;
+        }
+    }
+    
+    argc = out;
+    argv[argc] = nullptr;
+    return threads;
+}
+
+bool extract_flag(int& argc, char* argv[], const char* name) {
+    bool found = false;
+    int out = 1;
+    
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], name) == 0) {
+            found = true;
+        } else {
+            argv[out++] = argv[i];
+        }
+    }
+    
+    argc = out;
+    argv[argc] = nullptr;
+    return found;
+}
+
 }
@@ -2,12 +2,14 @@
 #define UTILS_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <cctype>
 #include <map>
+#include <chrono>
 
 namespace utils {
 
@@ -33,8 +35,27 @@ std::vector<Document> read_json_corpus(const std::string& filename);
 
 void write_documents_txt(const std::vector<Document>& docs, const std::string& filename);
 
+// Заменяет пробелами разделители формата corpus.txt: '|' и переводы строк
+void sanitize_field(std::string& field);
+
+// Одна строка corpus.txt; заголовок и текст проходят через sanitize_field
+void write_document_line(std::ostream& out, const Document& doc);
+
 std::vector<Document> read_documents_txt(const std::string& filename);
 
+// Разбор строки corpus.txt: doc_id|source|title|url|text
+bool parse_document_line(std::string_view line, Document& doc);
+
+// Число потоков по умолчанию — число ядер
+int default_thread_count();
+
+// Вынимает из argv опцию --threads N (или --threads=N), argc уменьшается.
+// Возвращает default_threads, если опции нет.
+int extract_threads_option(int& argc, char* argv[], int default_threads);
+
+// Вынимает из argv флаг без значения, например --pool-stats; true, если он был
+bool extract_flag(int& argc, char* argv[], const char* name);
+
 class Timer {
 private:
     std::chrono::high_resolution_clock::time_point start_time;
@@ -0,0 +1,54 @@
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// LEB128: по 7 бит на байт, старший бит — «дальше есть ещё байт».
+// Общие кирпичики двоичных форматов корпуса и индекса.
+namespace varint {
+
+inline void put(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+inline void put_string(std::string& out, std::string_view str) {
+    put(out, str.size());
+    out.append(str.data(), str.size());
+}
+
+// Чтение с проверкой границ: false, если значение не помещается в [p, end)
+inline bool get(const char*& p, const char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(*p++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+inline bool get_int(const char*& p, const char* end, int& value) {
+    uint64_t v;
+    if (!get(p, end, v)) return false;
+    value = static_cast<int>(v);
+    return true;
+}
+
+inline bool get_string(const char*& p, const char* end, std::string_view& str) {
+    uint64_t length;
+    if (!get(p, end, length)) return false;
+    if (length > static_cast<uint64_t>(end - p)) return false;
+    str = std::string_view(p, length);
+    p += length;
+    return true;
+}
+
+}
+
+#endif
@@ -1,4 +1,6 @@
 #include "crawler/crawler.h"
+#include "common/json_reader.h"
+#include "common/trace.h"
 #include <iostream>
 #include <algorithm>
 
@@ -13,6 +15,47 @@ void Crawler::load_corpus_from_json(const std::string& filename) {
     std::cout << "Загружено " << stats.total_docs << " документов" << std::endl;
 }
 
+namespace {
+
+const size_t DEDUP_BATCH = 4096;
+
+}
+
+void Crawler::enable_dedup(const NearDuplicateFilter::Options& options, bool drop) {
+    dedup = std::make_unique<NearDuplicateFilter>(options);
+    dedup_drop = drop;
+}
+
+bool Crawler::set_clusters_file(const std::string& filename) {
+    clusters_out.open(filename);
+    if (!clusters_out.is_open()) {
+        std::cerr << "Ошибка создания файла: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Crawler::flush_pending(const std::function<void(utils::Document&)>& sink) {
+    static trace::Counter& duplicates_total = trace::counter(
+        "crawler_duplicates_total", "Найдено почти-дубликатов");
+    trace::Span span("dedup_batch");
+    std::vector<int> representatives;
+    dedup->filter(pending, representatives);
+    
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (representatives[i] >= 0) {
+            stats.duplicates++;
+            duplicates_total.add();
+            if (clusters_out.is_open()) {
+                clusters_out << pending[i].doc_id << "|" << representatives[i] << "\n";
+            }
+            if (dedup_drop) continue;
+        }
+        sink(pending[i]);
+    }
+    pending.clear();
+}
+
 bool Crawler::validate_document(const utils::Document& doc) {
     if (doc.text.length() < 50) {
         return false;
@@ -47,12 +90,71 @@ void Crawler::crawl() {
     
     std::cout << std::endl;
     
+    if (dedup) {
+        std::vector<utils::Document> unique_docs;
+        auto keep = [&unique_docs](utils::Document& doc) {
+            unique_docs.push_back(std::move(doc));
+        };
+        
+        for (auto& doc : valid_docs) {
+            pending.push_back(std::move(doc));
+            if (pending.size() >= DEDUP_BATCH) flush_pending(keep);
+        }
+        flush_pending(keep);
+        valid_docs.swap(unique_docs);
+    }
+    
     documents = valid_docs;
     stats.elapsed_time_ms = timer.elapsed_ms();
     
     std::cout << "Обход завершён" << std::endl;
 }
 
+bool Crawler::crawl_stream(const std::string& filename,
+                           const std::function<void(utils::Document&)>& sink) {
+    static trace::Counter& documents_total = trace::counter(
+        "crawler_documents_total", "Документов прочитано из JSON");
+    static trace::Counter& rejected_total = trace::counter(
+        "crawler_rejected_total", "Документов отклонено при обходе");
+    trace::Span span("crawl_file");
+    utils::Timer timer;
+    
+    utils::JsonCorpusReader reader;
+    bool ok = reader.read_file(filename, [&](utils::Document& doc) {
+        // Объекты без заголовка или текста не считаются документами, как в read_json_corpus
+        if (doc.title.empty() || doc.text.empty()) return;
+        doc.doc_id = stats.total_docs++;
+        documents_total.add();
+        
+        if (!validate_document(doc)) {
+            stats.failed++;
+            rejected_total.add();
+        } else if (dedup) {
+            stats.crawled++;
+            pending.push_back(std::move(doc));
+            if (pending.size() >= DEDUP_BATCH) flush_pending(sink);
+        } else {
+            stats.crawled++;
+            sink(doc);
+        }
+        
+        if (stats.total_docs % 10000 == 0) {
+            std::cout << "\rОбработано: " << stats.total_docs << std::flush;
+        }
+    });
+    
+    if (dedup) {
+        flush_pending(sink);
+    }
+    
+    if (stats.total_docs >= 10000) {
+        std::cout << std::endl;
+    }
+    
+    stats.elapsed_time_ms += timer.elapsed_ms();
+    return ok;
+}
+
 void Crawler::save_results(const std::string& output_file) {
     utils::write_documents_txt(documents, output_file);
 }
@@ -63,6 +165,18 @@ void Crawler::print_statistics() const {
     std::cout << "Всего документов: " << stats.total_docs << std::endl;
     std::cout << "Обработано: " << stats.crawled << std::endl;
     std::cout << "Отклонено: " << stats.failed << std::endl;
+    
+    if (dedup) {
+        const auto& dedup_stats = dedup->get_statistics();
+        std::cout << "Почти-дубликатов: " << stats.duplicates
+                  << (dedup_drop ? " (удалены)" : " (оставлены)") << std::endl;
+        std::cout << "LSH: " << dedup->get_bands() << " полос по " << dedup->get_rows()
+                  << " строк, кандидатов проверено: " << dedup_stats.candidates << std::endl;
+        std::cout << "Время дедупликации: " << (dedup_stats.signature_ms + dedup_stats.lookup_ms) / 1000.0
+                  << " сек (сигнатуры " << dedup_stats.signature_ms / 1000.0
+                  << ", поиск " << dedup_stats.lookup_ms / 1000.0 << ")" << std::endl;
+    }
+    
     std::cout << "Время обхода: " << stats.elapsed_time_ms / 1000.0 << " сек" << std::endl;
     
     if (stats.elapsed_time_ms > 0) {
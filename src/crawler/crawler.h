@@ -2,8 +2,12 @@
 #define CRAWLER_H
 
 #include "common/utils.h"
+#include "crawler/dedup.h"
 #include <vector>
 #include <string>
+#include <functional>
+#include <fstream>
+#include <memory>
 
 class Crawler {
 private:
@@ -13,21 +17,48 @@ private:
         int total_docs = 0;
         int crawled = 0;
         int failed = 0;
+        int duplicates = 0;
         double elapsed_time_ms = 0;
     } stats;
     
+    std::unique_ptr<NearDuplicateFilter> dedup;
+    bool dedup_drop = true;
+    std::ofstream clusters_out;
+    
+    // Документы, ждущие проверки на дубликаты
+    std::vector<utils::Document> pending;
+    
     bool validate_document(const utils::Document& doc);
     
+    // Прогоняет pending через фильтр дубликатов и отдаёт оставшиеся в sink
+    void flush_pending(const std::function<void(utils::Document&)>& sink);
+    
 public:
+    // drop = false оставляет дубликаты в корпусе, только записывая кластеры
+    void enable_dedup(const NearDuplicateFilter::Options& options, bool drop = true);
+    
+    // Файл кластеров: строки doc_id|doc_id представителя
+    bool set_clusters_file(const std::string& filename);
+    
     void load_corpus_from_json(const std::string& filename);
     
     void crawl();
     
+    // Обход без накопления корпуса: JSON читается потоково, каждый
+    // прошедший проверку документ сразу отдаётся в sink, статистика
+    // считается так же, как в crawl(). false при ошибке чтения или разбора.
+    bool crawl_stream(const std::string& filename,
+                      const std::function<void(utils::Document&)>& sink);
+    
     void save_results(const std::string& output_file);
     
     void print_statistics() const;
     
     const std::vector<utils::Document>& get_documents() const { return documents; }
+    
+    int get_total_count() const { return stats.total_docs; }
+    int get_failed_count() const { return stats.failed; }
+    int get_duplicate_count() const { return stats.duplicates; }
 };
 
 #endif
@@ -0,0 +1,209 @@
+#include "crawler/dedup.h"
+#include "common/thread_pool.h"
+#include "common/trace.h"
+#include "common/utf8.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace {
+
+const uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Число полос для num_hashes и порога: порог S-кривой LSH (1/b)^(1/r)
+// берётся наибольшим, но не выше заданного, чтобы пропусков было мало,
+// а ложные кандидаты отсеивались сравнением сигнатур
+int choose_bands(int num_hashes, double threshold) {
+    int best = num_hashes;
+    double best_point = -1;
+    for (int b = 1; b <= num_hashes; ++b) {
+        if (num_hashes % b != 0) continue;
+        int r = num_hashes / b;
+        double point = std::pow(1.0 / b, 1.0 / r);
+        if (point <= threshold && point > best_point) {
+            best_point = point;
+            best = b;
+        }
+    }
+    return best;
+}
+
+}
+
+NearDuplicateFilter::NearDuplicateFilter(const Options& opts) : options(opts) {
+    options.num_hashes = std::max(1, options.num_hashes);
+    options.shingle_size = std::max(1, options.shingle_size);
+
+    if (options.bands > 0 && options.num_hashes % options.bands == 0) {
+        bands = options.bands;
+    } else {
+        bands = choose_bands(options.num_hashes, options.threshold);
+    }
+    rows = options.num_hashes / bands;
+
+    // Семейство хэшей multiply-shift: h(x) = старшие 32 бита (a * x + b), a нечётное
+    uint64_t state = 0x5EED5EED5EEDull;
+    for (int i = 0; i < options.num_hashes; ++i) {
+        hash_a.push_back(splitmix64(state) | 1);
+        hash_b.push_back(splitmix64(state));
+    }
+
+    buckets.resize(bands);
+    next_in_bucket.resize(bands);
+}
+
+bool NearDuplicateFilter::parse_threshold(const std::string& text, double& threshold) {
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    // !(value > 0) отсекает и NaN
+    if (end == text.c_str() || *end || !(value > 0) || value > 1) return false;
+    threshold = value;
+    return true;
+}
+
+bool NearDuplicateFilter::compute_signature(const std::string& text, uint32_t* signature,
+                                            std::vector<uint64_t>& words) const {
+    // Слова — те же классы символов, что у токенизатора, в нижнем регистре
+    words.clear();
+    uint64_t h = 14695981039346656037ull;
+    bool in_word = false;
+
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end) {
+        int len;
+        char32_t cp = utf8::decode(p, end, len);
+        p += len;
+
+        if (cp != utf8::INVALID && utf8::is_token_char(cp)) {
+            h = (h ^ utf8::to_lower(cp)) * 1099511628211ull;
+            in_word = true;
+        } else if (in_word) {
+            words.push_back(h);
+            h = 14695981039346656037ull;
+            in_word = false;
+        }
+    }
+    if (in_word) words.push_back(h);
+
+    if (words.empty()) return false;
+
+    int n = options.num_hashes;
+    std::fill(signature, signature + n, NONE);
+
+    size_t k = std::min(words.size(), static_cast<size_t>(options.shingle_size));
+    for (size_t i = 0; i + k <= words.size(); ++i) {
+        uint64_t shingle = 0;
+        for (size_t j = 0; j < k; ++j) {
+            shingle = (shingle ^ words[i + j]) * 0x9E3779B97F4A7C15ull;
+        }
+
+        for (int j = 0; j < n; ++j) {
+            uint32_t v = static_cast<uint32_t>((hash_a[j] * shingle + hash_b[j]) >> 32);
+            signature[j] = std::min(signature[j], v);
+        }
+    }
+    return true;
+}
+
+uint64_t NearDuplicateFilter::band_hash(const uint32_t* signature, int band) const {
+    uint64_t h = 14695981039346656037ull ^ static_cast<uint64_t>(band);
+    const uint32_t* values = signature + band * rows;
+    for (int i = 0; i < rows; ++i) {
+        h = (h ^ values[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+int NearDuplicateFilter::find_duplicate(const uint32_t* signature) {
+    if (++visit_stamp == 0) {
+        std::fill(visited.begin(), visited.end(), 0);
+        visit_stamp = 1;
+    }
+
+    int n = options.num_hashes;
+    int min_matches = static_cast<int>(std::ceil(options.threshold * n));
+
+    for (int band = 0; band < bands; ++band) {
+        auto it = buckets[band].find(band_hash(signature, band));
+        if (it == buckets[band].end()) continue;
+
+        for (uint32_t c = it->second; c != NONE; c = next_in_bucket[band][c]) {
+            if (visited[c] == visit_stamp) continue;
+            visited[c] = visit_stamp;
+            stats.candidates++;
+
+            // Доля совпавших позиций сигнатуры — оценка сходства Жаккара
+            const uint32_t* other = &accepted_signatures[static_cast<size_t>(c) * n];
+            int matches = 0;
+            for (int j = 0; j < n; ++j) {
+                matches += signature[j] == other[j];
+            }
+            if (matches >= min_matches) return static_cast<int>(c);
+        }
+    }
+    return -1;
+}
+
+void NearDuplicateFilter::accept(int doc_id, const uint32_t* signature) {
+    uint32_t index = static_cast<uint32_t>(accepted_ids.size());
+    accepted_ids.push_back(doc_id);
+    accepted_signatures.insert(accepted_signatures.end(), signature, signature + options.num_hashes);
+    visited.push_back(0);
+
+    for (int band = 0; band < bands; ++band) {
+        auto result = buckets[band].try_emplace(band_hash(signature, band), index);
+        if (result.second) {
+            next_in_bucket[band].push_back(NONE);
+        } else {
+            next_in_bucket[band].push_back(result.first->second);
+            result.first->second = index;
+        }
+    }
+}
+
+void NearDuplicateFilter::filter(const std::vector<utils::Document>& batch,
+                                 std::vector<int>& representatives) {
+    size_t count = batch.size();
+    int n = options.num_hashes;
+    representatives.assign(count, -1);
+
+    // Сигнатуры независимы — считаются параллельно
+    utils::Timer timer;
+    std::vector<uint32_t> signatures(count * n);
+    std::vector<char> has_words(count, 0);
+
+    utils::ThreadPool::shared().parallel_for(0, count, 16, [&](size_t lo, size_t hi) {
+        trace::Span span("minhash_signatures");
+        std::vector<uint64_t> words;
+        for (size_t i = lo; i < hi; ++i) {
+            has_words[i] = compute_signature(batch[i].text, &signatures[i * n], words);
+        }
+    });
+    stats.signature_ms += timer.elapsed_ms();
+
+    // Поиск и добавление — по порядку, чтобы представителем был первый документ
+    timer.reset();
+    for (size_t i = 0; i < count; ++i) {
+        stats.checked++;
+        if (!has_words[i]) continue;
+
+        const uint32_t* signature = &signatures[i * n];
+        int duplicate = find_duplicate(signature);
+        if (duplicate >= 0) {
+            representatives[i] = accepted_ids[duplicate];
+            stats.duplicates++;
+        } else {
+            accept(batch[i].doc_id, signature);
+        }
+    }
+    stats.lookup_ms += timer.elapsed_ms();
+}
@@ -0,0 +1,82 @@
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include "common/utils.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Поиск почти-дубликатов: MinHash-сигнатуры по шинглам из слов и LSH
+// с разбиением сигнатуры на полосы. Документы проверяются в порядке
+// поступления: дубликатом считается документ, у которого оценка сходства
+// Жаккара с уже принятым документом не ниже порога. Сам первый документ
+// кластера остаётся его представителем.
+//
+// Хранятся только сигнатуры принятых документов, поэтому фильтр
+// работает и на потоковом обходе.
+class NearDuplicateFilter {
+public:
+    struct Options {
+        double threshold = 0.8;
+        int shingle_size = 3;
+        int num_hashes = 128;
+        // 0 — подобрать по порогу
+        int bands = 0;
+    };
+
+    struct Statistics {
+        size_t checked = 0;
+        size_t duplicates = 0;
+        size_t candidates = 0;
+        double signature_ms = 0;
+        double lookup_ms = 0;
+    };
+
+private:
+    Options options;
+    int bands;
+    int rows;
+
+    std::vector<uint64_t> hash_a;
+    std::vector<uint64_t> hash_b;
+
+    // Принятые документы: doc_id и сигнатура num_hashes подряд
+    std::vector<int> accepted_ids;
+    std::vector<uint32_t> accepted_signatures;
+
+    // Полоса -> (хэш полосы -> последний принятый документ в корзине);
+    // остальные документы корзины связаны цепочкой через next_in_bucket
+    std::vector<std::unordered_map<uint64_t, uint32_t>> buckets;
+    std::vector<std::vector<uint32_t>> next_in_bucket;
+    std::vector<uint32_t> visited;
+    uint32_t visit_stamp = 0;
+
+    Statistics stats;
+
+    // false, если в тексте нет ни одного слова
+    bool compute_signature(const std::string& text, uint32_t* signature,
+                           std::vector<uint64_t>& words) const;
+
+    uint64_t band_hash(const uint32_t* signature, int band) const;
+
+    int find_duplicate(const uint32_t* signature);
+
+    void accept(int doc_id, const uint32_t* signature);
+
+public:
+    explicit NearDuplicateFilter(const Options& opts);
+
+    // Порог сходства из командной строки: число в (0, 1]
+    static bool parse_threshold(const std::string& text, double& threshold);
+
+    // Для каждого документа пакета: -1, если он новый, иначе doc_id
+    // представителя. Дубликаты внутри пакета тоже находятся.
+    void filter(const std::vector<utils::Document>& batch, std::vector<int>& representatives);
+
+    int get_bands() const { return bands; }
+    int get_rows() const { return rows; }
+    const Statistics& get_statistics() const { return stats; }
+};
+
+#endif
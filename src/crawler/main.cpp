@@ -1,27 +1,92 @@
 #include "crawler/crawler.h"
+#include "common/corpus_format.h"
+#include "common/thread_pool.h"
+#include "common/trace.h"
 #include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
 
 int main(int argc, char* argv[]) {
-    if (argc < 3) {
+    int threads = utils::extract_threads_option(argc, argv, utils::default_thread_count());
+    
+    utils::ThreadPool::configure_shared(threads);
+    trace::Session tracing(argc, argv);
+    
+    NearDuplicateFilter::Options dedup_options;
+    bool dedup = false;
+    bool dedup_drop = true;
+    std::string clusters_file;
+    
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--dedup") == 0) {
+            dedup = true;
+        } else if (std::strcmp(argv[i], "--dedup-threshold") == 0 && i + 1 < argc) {
+            dedup = true;
+            if (!NearDuplicateFilter::parse_threshold(argv[++i], dedup_options.threshold)) {
+                std::cerr << "Неверный порог дубликатов: " << argv[i]
+                          << " (ожидается число в (0, 1])" << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--dedup-keep") == 0) {
+            dedup = true;
+            dedup_drop = false;
+        } else if (std::strcmp(argv[i], "--dedup-clusters") == 0 && i + 1 < argc) {
+            dedup = true;
+            clusters_file = argv[++i];
+        } else {
+            positional.push_back(argv[i]);
+        }
+    }
+    
+    if (positional.size() < 2) {
         std::cout << "Использование: " << argv[0] 
-                 << " <input_json> <output_txt>" << std::endl;
-        std::cout << "Пример: ./crawler data/raw/wikipedia_cars.json data/processed/corpus.txt" 
+                 << " <input_json> <output_txt> [--threads N] [--trace FILE] [--metrics FILE] [--dedup] [--dedup-threshold J]"
+                 << " [--dedup-keep] [--dedup-clusters FILE]" << std::endl;
+        std::cout << "Пример: ./crawler data/raw/avito_cars.json data/processed/corpus.txt --dedup" 
                  << std::endl;
         return 1;
     }
     
-    std::string input_file = argv[1];
-    std::string output_file = argv[2];
+    std::string input_file = positional[0];
+    std::string output_file = positional[1];
     
+    // Документы пишутся по мере разбора, корпус целиком в памяти не держится.
+    // Имя на .bin — двоичный корпус, иначе текстовый corpus.txt
     Crawler crawler;
+    bool ok;
     
-    crawler.load_corpus_from_json(input_file);
+    if (dedup) {
+        crawler.enable_dedup(dedup_options, dedup_drop);
+        if (!clusters_file.empty() && !crawler.set_clusters_file(clusters_file)) {
+            return 1;
+        }
+    }
     
-    crawler.crawl();
+    if (corpus::is_binary_name(output_file)) {
+        corpus::Writer writer(corpus::Kind::DOCUMENTS);
+        if (!writer.open(output_file)) return 1;
+        
+        ok = crawler.crawl_stream(input_file, [&writer](utils::Document& doc) {
+            writer.add_document(doc);
+        });
+        ok &= writer.close();
+    } else {
+        std::ofstream output(output_file);
+        if (!output.is_open()) {
+            std::cerr << "Ошибка создания файла: " << output_file << std::endl;
+            return 1;
+        }
+        
+        ok = crawler.crawl_stream(input_file, [&output](utils::Document& doc) {
+            utils::write_document_line(output, doc);
+        });
+    }
     
-    crawler.save_results(output_file);
+    std::cout << "Сохранено в: " << output_file << std::endl;
     
     crawler.print_statistics();
     
-    return 0;
+    return ok ? 0 : 1;
 }
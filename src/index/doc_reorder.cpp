@@ -0,0 +1,238 @@
+#include "index/doc_reorder.h"
+#include "common/thread_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+
+namespace doc_reorder {
+
+bool parse_mode(const std::string& name, Mode& mode) {
+    if (name == "none") {
+        mode = Mode::NONE;
+    } else if (name == "source") {
+        mode = Mode::SOURCE_TITLE;
+    } else if (name == "bisection" || name == "bp") {
+        mode = Mode::BISECTION;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* mode_name(Mode mode) {
+    switch (mode) {
+        case Mode::NONE: return "none";
+        case Mode::SOURCE_TITLE: return "source";
+        case Mode::BISECTION: return "bisection";
+    }
+    return "unknown";
+}
+
+namespace {
+
+// Упрощённый вариант Dhulipala et al., «Compressing Graphs and Indexes with
+// Recursive Graph Bisection»: множество документов делится пополам, затем
+// несколько раз меняются местами пары документов, перенос которых сильнее
+// всего уменьшает оценку log-gap стоимости d * log2(n / (d + 1)) по всем
+// термам. После этого каждая половина делится так же.
+class Bisection {
+private:
+    // Половины делятся параллельно, пока в части не меньше стольких документов
+    static const size_t PARALLEL_MIN_DOCUMENTS = 4096;
+
+    // Рабочие массивы одного потока; после каждого деления степени снова нулевые
+    struct Scratch {
+        std::vector<int32_t> left_degree;
+        std::vector<int32_t> right_degree;
+        std::vector<float> move_right_gain;
+        std::vector<float> move_left_gain;
+        std::vector<uint32_t> touched;
+
+        std::vector<std::pair<float, uint32_t>> left_gains;
+        std::vector<std::pair<float, uint32_t>> right_gains;
+
+        explicit Scratch(size_t terms_count)
+            : left_degree(terms_count, 0), right_degree(terms_count, 0),
+              move_right_gain(terms_count, 0), move_left_gain(terms_count, 0) {}
+    };
+
+    const DocumentTerms& doc_terms;
+    const Options& options;
+    utils::ThreadPool& pool;
+    std::vector<float> log_table;
+    // По одному на поток пула и ещё один для вызывающего
+    std::vector<std::unique_ptr<Scratch>> scratches;
+
+    float cost(int32_t degree, size_t size) const {
+        return degree * (log_table[size] - log_table[degree + 1]);
+    }
+
+    template <typename F>
+    void for_each_term(uint32_t doc, F&& f) const {
+        for (uint32_t k = doc_terms.offsets[doc]; k < doc_terms.offsets[doc + 1]; ++k) {
+            f(doc_terms.terms[k]);
+        }
+    }
+
+    Scratch& local_scratch() {
+        auto& scratch = scratches[pool.current_worker()];
+        if (!scratch) scratch = std::make_unique<Scratch>(doc_terms.terms_count);
+        return *scratch;
+    }
+
+    void count_degrees(Scratch& s, const uint32_t* docs, size_t count, std::vector<int32_t>& degree) {
+        for (size_t i = 0; i < count; ++i) {
+            for_each_term(docs[i], [&](uint32_t term) {
+                if (s.left_degree[term] == 0 && s.right_degree[term] == 0) s.touched.push_back(term);
+                degree[term]++;
+            });
+        }
+    }
+
+    float document_gain(uint32_t doc, const std::vector<float>& term_gain) const {
+        float gain = 0;
+        for_each_term(doc, [&](uint32_t term) { gain += term_gain[term]; });
+        return gain;
+    }
+
+    void move(uint32_t doc, std::vector<int32_t>& from, std::vector<int32_t>& to) {
+        for_each_term(doc, [&](uint32_t term) {
+            from[term]--;
+            to[term]++;
+        });
+    }
+
+    // Одна итерация обмена; возвращает число переставленных пар
+    size_t refine(Scratch& s, uint32_t* left, size_t left_count, uint32_t* right, size_t right_count) {
+        for (uint32_t term : s.touched) {
+            int32_t l = s.left_degree[term];
+            int32_t r = s.right_degree[term];
+            float current = cost(l, left_count) + cost(r, right_count);
+            s.move_right_gain[term] = l > 0
+                ? current - cost(l - 1, left_count) - cost(r + 1, right_count) : 0;
+            s.move_left_gain[term] = r > 0
+                ? current - cost(l + 1, left_count) - cost(r - 1, right_count) : 0;
+        }
+
+        s.left_gains.resize(left_count);
+        for (size_t i = 0; i < left_count; ++i) {
+            s.left_gains[i] = {document_gain(left[i], s.move_right_gain), static_cast<uint32_t>(i)};
+        }
+        s.right_gains.resize(right_count);
+        for (size_t i = 0; i < right_count; ++i) {
+            s.right_gains[i] = {document_gain(right[i], s.move_left_gain), static_cast<uint32_t>(i)};
+        }
+
+        auto by_gain = [](const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b) {
+            return a.first > b.first;
+        };
+        std::sort(s.left_gains.begin(), s.left_gains.end(), by_gain);
+        std::sort(s.right_gains.begin(), s.right_gains.end(), by_gain);
+
+        size_t swaps = 0;
+        size_t pairs = std::min(left_count, right_count);
+        for (size_t i = 0; i < pairs; ++i) {
+            if (s.left_gains[i].first + s.right_gains[i].first <= 0) break;
+
+            uint32_t& a = left[s.left_gains[i].second];
+            uint32_t& b = right[s.right_gains[i].second];
+            move(a, s.left_degree, s.right_degree);
+            move(b, s.right_degree, s.left_degree);
+            std::swap(a, b);
+            swaps++;
+        }
+        return swaps;
+    }
+
+    void split(uint32_t* left, size_t left_count, uint32_t* right, size_t right_count) {
+        Scratch& s = local_scratch();
+        count_degrees(s, left, left_count, s.left_degree);
+        count_degrees(s, right, right_count, s.right_degree);
+
+        for (int iteration = 0; iteration < options.iterations; ++iteration) {
+            if (refine(s, left, left_count, right, right_count) == 0) break;
+        }
+
+        for (uint32_t term : s.touched) {
+            s.left_degree[term] = 0;
+            s.right_degree[term] = 0;
+        }
+        s.touched.clear();
+    }
+
+public:
+    Bisection(const DocumentTerms& terms, const Options& opts, size_t documents_count,
+              utils::ThreadPool& thread_pool)
+        : doc_terms(terms), options(opts), pool(thread_pool),
+          log_table(documents_count + 2, 0), scratches(thread_pool.size() + 1) {
+        for (size_t i = 1; i < log_table.size(); ++i) {
+            log_table[i] = static_cast<float>(std::log2(static_cast<double>(i)));
+        }
+    }
+
+    // Результат не зависит от числа потоков: каждая часть делится
+    // одинаково, кто бы её ни обрабатывал
+    void run(uint32_t* docs, size_t count, int depth) {
+        if (count <= std::max<size_t>(options.leaf_size, 2) || depth >= options.max_depth) return;
+
+        size_t left_count = count / 2;
+        size_t right_count = count - left_count;
+        uint32_t* left = docs;
+        uint32_t* right = docs + left_count;
+
+        split(left, left_count, right, right_count);
+
+        if (pool.size() > 1 && count >= PARALLEL_MIN_DOCUMENTS) {
+            utils::TaskGroup group(pool);
+            group.run([this, left, left_count, depth] { run(left, left_count, depth + 1); });
+            run(right, right_count, depth + 1);
+            group.wait();
+        } else {
+            run(left, left_count, depth + 1);
+            run(right, right_count, depth + 1);
+        }
+    }
+};
+
+}
+
+std::vector<uint32_t> compute_order(const std::vector<Document>& documents,
+                                    const DocumentTerms& doc_terms,
+                                    const Options& options) {
+    std::vector<uint32_t> order(documents.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (options.mode == Mode::NONE) return order;
+
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        int by_source = documents[a].source->compare(*documents[b].source);
+        if (by_source != 0) return by_source < 0;
+        return *documents[a].title < *documents[b].title;
+    });
+    if (options.mode == Mode::SOURCE_TITLE) return order;
+
+    Bisection bisection(doc_terms, options, documents.size(), utils::ThreadPool::shared());
+    bisection.run(order.data(), order.size(), 0);
+    return order;
+}
+
+double average_log_gap(const DocumentTerms& doc_terms, const std::vector<uint32_t>& order) {
+    std::vector<int64_t> last(doc_terms.terms_count, -1);
+    double total = 0;
+    size_t gaps = 0;
+
+    for (size_t new_id = 0; new_id < order.size(); ++new_id) {
+        uint32_t doc = order[new_id];
+        for (uint32_t k = doc_terms.offsets[doc]; k < doc_terms.offsets[doc + 1]; ++k) {
+            uint32_t term = doc_terms.terms[k];
+            if (last[term] >= 0) {
+                total += std::log2(static_cast<double>(new_id - last[term]));
+                gaps++;
+            }
+            last[term] = static_cast<int64_t>(new_id);
+        }
+    }
+    return gaps > 0 ? total / gaps : 0;
+}
+
+}
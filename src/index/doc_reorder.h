@@ -0,0 +1,61 @@
+#ifndef DOC_REORDER_H
+#define DOC_REORDER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Перенумерация документов перед сохранением индекса.
+// Порядок файла разбрасывает похожие документы по всему пространству
+// идентификаторов; если поставить их рядом, разрывы в постинг-листах
+// становятся короче, varint-кодирование — плотнее, а пересечения
+// ходят по памяти последовательнее.
+namespace doc_reorder {
+
+enum class Mode {
+    NONE,
+    // Сортировка по источнику, затем по заголовку
+    SOURCE_TITLE,
+    // Рекурсивное разбиение графа документ-терм (BP), начиная с SOURCE_TITLE
+    BISECTION
+};
+
+bool parse_mode(const std::string& name, Mode& mode);
+const char* mode_name(Mode mode);
+
+struct Document {
+    const std::string* source;
+    const std::string* title;
+};
+
+struct Options {
+    Mode mode = Mode::BISECTION;
+    // Части меньше этого размера не делятся
+    size_t leaf_size = 16;
+    int iterations = 20;
+    // Глубже этого уровня рекурсия не идёт, даже если части большие
+    int max_depth = 24;
+};
+
+// Термы документов в формате CSR: термы документа i лежат в
+// terms[offsets[i], offsets[i + 1]), каждый терм — один раз.
+// Термы, встречающиеся в одном документе, можно не передавать:
+// на порядок они не влияют
+struct DocumentTerms {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> terms;
+    uint32_t terms_count = 0;
+};
+
+// Возвращает order, где order[new_id] = old_id
+std::vector<uint32_t> compute_order(const std::vector<Document>& documents,
+                                    const DocumentTerms& doc_terms,
+                                    const Options& options);
+
+// Оценка сжимаемости: средний log2 разрыва между соседними документами
+// в постинг-листах при порядке order (order[new_id] = old_id)
+double average_log_gap(const DocumentTerms& doc_terms, const std::vector<uint32_t>& order);
+
+}
+
+#endif
@@ -0,0 +1,61 @@
+#include "index/index_format.h"
+#include <cstring>
+#include <iostream>
+
+namespace index_format {
+
+bool has_magic(const char* data, size_t size) {
+    return size >= sizeof(MAGIC) && std::memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool read_sections(const utils::MappedFile& file,
+                   std::map<uint32_t, std::string_view>& sections) {
+    Header header;
+    if (file.size() < sizeof(header) || !has_magic(file.data(), file.size())) {
+        std::cerr << "Файл не является индексом v2" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    
+    if (header.version != VERSION) {
+        std::cerr << "Неподдерживаемая версия индекса " << header.version << std::endl;
+        return false;
+    }
+    if (header.sections_count > (file.size() - sizeof(header)) / sizeof(SectionEntry)) {
+        std::cerr << "Файл индекса повреждён (таблица секций)" << std::endl;
+        return false;
+    }
+    
+    for (uint32_t i = 0; i < header.sections_count; ++i) {
+        SectionEntry section;
+        std::memcpy(&section, file.data() + sizeof(header) + i * sizeof(section), sizeof(section));
+        if (section.offset > file.size() || section.size > file.size() - section.offset) {
+            std::cerr << "Файл индекса повреждён (секция " << section.id << ")" << std::endl;
+            return false;
+        }
+        sections[section.id] = std::string_view(file.data() + section.offset, section.size);
+    }
+    return true;
+}
+
+uint64_t write_sections(std::ofstream& out,
+                        const std::vector<std::pair<uint32_t, const std::string*>>& sections) {
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.sections_count = static_cast<uint32_t>(sections.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    
+    uint64_t offset = sizeof(header) + sections.size() * sizeof(SectionEntry);
+    for (const auto& [id, data] : sections) {
+        SectionEntry entry = {id, 0, offset, data->size()};
+        out.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        offset += entry.size;
+    }
+    for (const auto& section : sections) {
+        out.write(section.second->data(), section.second->size());
+    }
+    return offset;
+}
+
+}
@@ -0,0 +1,56 @@
+#ifndef INDEX_FORMAT_H
+#define INDEX_FORMAT_H
+
+#include "common/mapped_file.h"
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Формат индекса v2: заголовок, таблица секций, затем сами секции.
+// Незнакомые секции читатель пропускает, так что новые данные
+// добавляются без смены версии.
+namespace index_format {
+
+const char MAGIC[8] = {'S', 'E', 'I', 'N', 'D', 'E', 'X', '2'};
+const uint32_t VERSION = 2;
+
+enum SectionId : uint32_t {
+    SECTION_DOCUMENTS = 1,
+    SECTION_TERMS = 2,
+    SECTION_STATISTICS = 3,
+    SECTION_BIGRAMS = 4,
+    SECTION_SHARDS = 5
+};
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t sections_count;
+};
+
+struct SectionEntry {
+    uint32_t id;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+
+static_assert(sizeof(Header) == 16, "заголовок индекса должен быть без выравнивания");
+static_assert(sizeof(SectionEntry) == 24, "запись о секции должна быть без выравнивания");
+
+bool has_magic(const char* data, size_t size);
+
+// Проверяет заголовок и таблицу секций; sections[id] указывает в file
+bool read_sections(const utils::MappedFile& file,
+                   std::map<uint32_t, std::string_view>& sections);
+
+// Пишет заголовок, таблицу и секции; возвращает размер файла
+uint64_t write_sections(std::ofstream& out,
+                        const std::vector<std::pair<uint32_t, const std::string*>>& sections);
+
+}
+
+#endif
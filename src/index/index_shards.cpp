@@ -0,0 +1,105 @@
+#include "index/index_shards.h"
+#include "index/index_format.h"
+#include "common/mapped_file.h"
+#include "common/varint.h"
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+namespace index_shards {
+
+std::string shard_file_name(const std::string& manifest, size_t i) {
+    return std::filesystem::path(manifest).filename().string() + ".shard" + std::to_string(i);
+}
+
+std::string shard_path(const std::string& manifest, const Shard& shard) {
+    return (std::filesystem::path(manifest).parent_path() / shard.file).string();
+}
+
+bool write_manifest(const std::string& filename, const std::vector<Shard>& shards) {
+    std::string section;
+    varint::put(section, shards.size());
+    for (const auto& shard : shards) {
+        varint::put_string(section, shard.file);
+        varint::put(section, static_cast<uint32_t>(shard.first_doc));
+        varint::put(section, static_cast<uint32_t>(shard.end_doc));
+    }
+    
+    // Как и индекс, оглавление подменяется целиком через rename
+    std::string tmp_filename = filename + ".tmp";
+    std::ofstream out(tmp_filename, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Ошибка создания файла: " << tmp_filename << std::endl;
+        return false;
+    }
+    index_format::write_sections(out, {{index_format::SECTION_SHARDS, &section}});
+    out.close();
+    if (out.fail() || std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+        std::cerr << "Ошибка записи оглавления: " << filename << std::endl;
+        std::remove(tmp_filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool read_manifest(const std::string& filename, std::vector<Shard>& shards) {
+    utils::MappedFile file;
+    if (!file.open(filename)) return false;
+    
+    std::map<uint32_t, std::string_view> sections;
+    if (!index_format::read_sections(file, sections)) return false;
+    
+    auto it = sections.find(index_format::SECTION_SHARDS);
+    if (it == sections.end()) {
+        std::cerr << "Файл не является оглавлением шардов: " << filename << std::endl;
+        return false;
+    }
+    
+    const char* p = it->second.data();
+    const char* end = p + it->second.size();
+    uint64_t count = 0;
+    bool ok = varint::get(p, end, count) && count <= it->second.size();
+    // Шарды лежат рядом с оглавлением: имя без каталогов, иначе оглавление
+    // могло бы указать на любой файл
+    auto plain_name = [](std::string_view name) {
+        return !name.empty() && name != "." && name != ".." &&
+               name.find('/') == std::string_view::npos &&
+               name.find('\\') == std::string_view::npos;
+    };
+    for (uint64_t i = 0; ok && i < count; ++i) {
+        Shard shard;
+        std::string_view name;
+        ok = varint::get_string(p, end, name) && plain_name(name) &&
+             varint::get_int(p, end, shard.first_doc) &&
+             varint::get_int(p, end, shard.end_doc) &&
+             shard.first_doc <= shard.end_doc &&
+             (shards.empty() || shards.back().end_doc <= shard.first_doc);
+        shard.file.assign(name.data(), name.size());
+        if (ok) shards.push_back(std::move(shard));
+    }
+    if (!ok || shards.empty()) {
+        std::cerr << "Оглавление шардов повреждено: " << filename << std::endl;
+        shards.clear();
+        return false;
+    }
+    return true;
+}
+
+bool is_manifest(const std::string& filename) {
+    // Читается только заголовок с таблицей секций, а не весь индекс
+    std::ifstream in(filename, std::ios::binary);
+    index_format::Header header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        !index_format::has_magic(header.magic, sizeof(header.magic))) {
+        return false;
+    }
+    
+    index_format::SectionEntry section;
+    for (uint32_t i = 0; i < header.sections_count; ++i) {
+        if (!in.read(reinterpret_cast<char*>(&section), sizeof(section))) return false;
+        if (section.id == index_format::SECTION_SHARDS) return true;
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,36 @@
+#ifndef INDEX_SHARDS_H
+#define INDEX_SHARDS_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Индекс, разбитый по диапазонам документов: оглавление — файл формата v2
+// с единственной секцией SECTION_SHARDS, шарды — обычные индексы рядом
+// с ним. Внутренние номера документов в шардах общие для всего индекса,
+// а диапазоны идут по возрастанию, поэтому результаты шардов
+// склеиваются без перенумерации.
+namespace index_shards {
+
+struct Shard {
+    std::string file;      // имя файла относительно каталога оглавления
+    int first_doc = 0;     // диапазон документов [first_doc, end_doc)
+    int end_doc = 0;
+};
+
+// Имя файла i-го шарда для оглавления manifest: index.bin.shard0, ...
+std::string shard_file_name(const std::string& manifest, size_t i);
+
+// Полный путь файла шарда
+std::string shard_path(const std::string& manifest, const Shard& shard);
+
+bool write_manifest(const std::string& filename, const std::vector<Shard>& shards);
+
+bool read_manifest(const std::string& filename, std::vector<Shard>& shards);
+
+// Оглавление ли это, а не обычный индекс; сообщений об ошибках не пишет
+bool is_manifest(const std::string& filename);
+
+}
+
+#endif
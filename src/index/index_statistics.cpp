@@ -0,0 +1,127 @@
+#include "index/index_statistics.h"
+#include "index/index_format.h"
+#include "common/mapped_file.h"
+#include "common/varint.h"
+#include <iostream>
+
+namespace index_stats {
+
+void GrowthSampler::observe(uint64_t tokens, uint64_t vocabulary) {
+    last = {tokens, vocabulary};
+    if (tokens < next_sample) return;
+
+    points.push_back(last);
+    // Шаг 2^(1/4): около 13 точек на каждые три порядка
+    while (next_sample <= tokens) {
+        next_sample += next_sample / 4 + 1;
+    }
+}
+
+std::vector<GrowthPoint> GrowthSampler::get_points() const {
+    std::vector<GrowthPoint> result = points;
+    if (last.tokens > 0 && (result.empty() || result.back().tokens != last.tokens)) {
+        result.push_back(last);
+    }
+    return result;
+}
+
+void GrowthSampler::restore(const std::vector<GrowthPoint>& saved) {
+    points = saved;
+    if (!saved.empty()) {
+        last = saved.back();
+        while (next_sample <= last.tokens) {
+            next_sample += next_sample / 4 + 1;
+        }
+    }
+}
+
+void CollectionStatistics::encode(std::string& out) const {
+    varint::put(out, documents);
+    varint::put(out, tokens);
+
+    varint::put(out, growth.size());
+    GrowthPoint previous;
+    for (const auto& point : growth) {
+        varint::put(out, point.tokens - previous.tokens);
+        varint::put(out, point.vocabulary - previous.vocabulary);
+        previous = point;
+    }
+
+    varint::put(out, terms.size());
+    std::string_view previous_term;
+    for (const auto& stats : terms) {
+        size_t prefix = 0;
+        while (prefix < stats.term.size() && prefix < previous_term.size() &&
+               stats.term[prefix] == previous_term[prefix]) {
+            prefix++;
+        }
+        varint::put(out, prefix);
+        varint::put_string(out, std::string_view(stats.term).substr(prefix));
+        varint::put(out, stats.collection_frequency);
+        varint::put(out, stats.document_frequency);
+        previous_term = stats.term;
+    }
+}
+
+bool CollectionStatistics::decode(std::string_view data) {
+    const char* p = data.data();
+    const char* end = p + data.size();
+
+    uint64_t growth_count;
+    if (!varint::get(p, end, documents) || !varint::get(p, end, tokens) ||
+        !varint::get(p, end, growth_count) || growth_count > data.size()) {
+        return false;
+    }
+
+    growth.resize(growth_count);
+    GrowthPoint previous;
+    for (auto& point : growth) {
+        uint64_t tokens_gap, vocabulary_gap;
+        if (!varint::get(p, end, tokens_gap) || !varint::get(p, end, vocabulary_gap)) return false;
+        point.tokens = previous.tokens + tokens_gap;
+        point.vocabulary = previous.vocabulary + vocabulary_gap;
+        previous = point;
+    }
+
+    uint64_t terms_count;
+    if (!varint::get(p, end, terms_count) || terms_count > data.size()) return false;
+
+    terms.resize(terms_count);
+    std::string_view previous_term;
+    for (auto& stats : terms) {
+        uint64_t prefix;
+        std::string_view suffix;
+        if (!varint::get(p, end, prefix) || prefix > previous_term.size() ||
+            !varint::get_string(p, end, suffix) ||
+            !varint::get(p, end, stats.collection_frequency) ||
+            !varint::get(p, end, stats.document_frequency)) {
+            return false;
+        }
+        stats.term.reserve(prefix + suffix.size());
+        stats.term.assign(previous_term.data(), prefix);
+        stats.term.append(suffix.data(), suffix.size());
+        previous_term = stats.term;
+    }
+    return true;
+}
+
+bool read_from_index(const std::string& filename, CollectionStatistics& stats) {
+    utils::MappedFile file;
+    if (!file.open(filename)) return false;
+
+    std::map<uint32_t, std::string_view> sections;
+    if (!index_format::read_sections(file, sections)) return false;
+
+    auto it = sections.find(index_format::SECTION_STATISTICS);
+    if (it == sections.end()) {
+        std::cerr << "В индексе нет секции статистики; пересоздайте его build_index" << std::endl;
+        return false;
+    }
+    if (!stats.decode(it->second)) {
+        std::cerr << "Секция статистики повреждена: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}
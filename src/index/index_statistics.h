@@ -0,0 +1,62 @@
+#ifndef INDEX_STATISTICS_H
+#define INDEX_STATISTICS_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Статистика коллекции, которую build_index сохраняет отдельной секцией
+// индекса: по ней zipf_analyzer строит таблицу ранг/частота и законы
+// Ципфа и Хипса, не перечитывая корпус.
+namespace index_stats {
+
+struct TermStatistics {
+    std::string term;
+    // Сколько раз терм встретился во всей коллекции
+    uint64_t collection_frequency = 0;
+    // В скольких документах он встретился
+    uint64_t document_frequency = 0;
+};
+
+// Размер словаря после tokens словоупотреблений — точка кривой Хипса
+struct GrowthPoint {
+    uint64_t tokens = 0;
+    uint64_t vocabulary = 0;
+};
+
+// Запоминает рост словаря в точках, идущих в геометрической прогрессии
+// по числу словоупотреблений: для подгонки в log-log нужны точки,
+// равномерные по логарифму, а не по самому числу.
+class GrowthSampler {
+private:
+    std::vector<GrowthPoint> points;
+    uint64_t next_sample = 1024;
+    GrowthPoint last;
+
+public:
+    void observe(uint64_t tokens, uint64_t vocabulary);
+
+    // Точки вместе с последним наблюдением
+    std::vector<GrowthPoint> get_points() const;
+
+    void restore(const std::vector<GrowthPoint>& saved);
+};
+
+struct CollectionStatistics {
+    uint64_t documents = 0;
+    uint64_t tokens = 0;
+    // Термы по возрастанию
+    std::vector<TermStatistics> terms;
+    std::vector<GrowthPoint> growth;
+
+    void encode(std::string& out) const;
+    bool decode(std::string_view data);
+};
+
+// Читает только секцию статистики, остальной индекс не разбирается
+bool read_from_index(const std::string& filename, CollectionStatistics& stats);
+
+}
+
+#endif
@@ -1,33 +1,203 @@
 #include "index/inverted_index.h"
 #include "common/utils.h"
+#include "common/corpus_format.h"
+#include "common/line_reader.h"
+#include "common/mapped_file.h"
+#include "common/thread_pool.h"
+#include "common/trace.h"
+#include "common/varint.h"
+#include "index/index_format.h"
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+// Идентификаторы кодируются разностями по модулю 2^32: списки
+// отсортированы, поэтому разность всегда неотрицательна
+void put_gap(std::string& out, int value, int& previous) {
+    varint::put(out, static_cast<uint32_t>(value) - static_cast<uint32_t>(previous));
+    previous = value;
+}
+
+bool get_gap(const char*& p, const char* end, int& previous) {
+    uint64_t gap;
+    if (!varint::get(p, end, gap) || gap > UINT32_MAX) return false;
+    previous = static_cast<int>(static_cast<uint32_t>(previous) + static_cast<uint32_t>(gap));
+    return true;
+}
+
+bool by_doc_id(const Posting& a, const Posting& b) {
+    return a.doc_id < b.doc_id;
+}
+
+}
+
+namespace posting_codec {
+
+void encode(std::string& out, const std::vector<Posting>& postings) {
+    varint::put(out, postings.size());
+    int previous_doc = 0;
+    for (const auto& posting : postings) {
+        put_gap(out, posting.doc_id, previous_doc);
+        varint::put(out, posting.positions.size());
+        int previous_position = 0;
+        for (int position : posting.positions) {
+            put_gap(out, position, previous_position);
+        }
+    }
+}
+
+bool decode(const char*& p, const char* end, std::vector<Posting>& postings) {
+    uint64_t postings_count;
+    if (!varint::get(p, end, postings_count) ||
+        postings_count > static_cast<uint64_t>(end - p)) {
+        return false;
+    }
+    
+    postings.reserve(postings.size() + postings_count);
+    int previous_doc = 0;
+    for (uint64_t j = 0; j < postings_count; ++j) {
+        uint64_t positions_count;
+        if (!get_gap(p, end, previous_doc) ||
+            !varint::get(p, end, positions_count) ||
+            positions_count > static_cast<uint64_t>(end - p)) {
+            return false;
+        }
+        
+        postings.emplace_back(previous_doc);
+        auto& positions = postings.back().positions;
+        positions.resize(positions_count);
+        int previous_position = 0;
+        for (uint64_t k = 0; k < positions_count; ++k) {
+            if (!get_gap(p, end, previous_position)) return false;
+            positions[k] = previous_position;
+        }
+    }
+    return true;
+}
+
+}
+
+namespace {
+
+// Термы идут по возрастанию, поэтому общий префикс с предыдущим
+// термом не повторяется; номера документов и позиции — разностями
+void encode_terms(std::string& out, const std::map<std::string, std::vector<Posting>>& terms) {
+    varint::put(out, terms.size());
+    std::string_view previous_term;
+    std::vector<Posting> sorted;
+    for (const auto& entry : terms) {
+        const std::string& term = entry.first;
+        size_t prefix = 0;
+        while (prefix < term.size() && prefix < previous_term.size() &&
+               term[prefix] == previous_term[prefix]) {
+            prefix++;
+        }
+        varint::put(out, prefix);
+        varint::put_string(out, std::string_view(term).substr(prefix));
+        previous_term = term;
+        
+        const std::vector<Posting>* postings = &entry.second;
+        if (!std::is_sorted(postings->begin(), postings->end(), by_doc_id)) {
+            sorted = *postings;
+            std::stable_sort(sorted.begin(), sorted.end(), by_doc_id);
+            postings = &sorted;
+        }
+        
+        posting_codec::encode(out, *postings);
+    }
+}
+
+// progress — печатать ход загрузки, для основного словаря
+bool decode_terms(const char*& p, const char* end,
+                  std::map<std::string, std::vector<Posting>>& terms, bool progress) {
+    uint64_t terms_count = 0;
+    if (!varint::get(p, end, terms_count) || terms_count > static_cast<uint64_t>(end - p)) {
+        return false;
+    }
+    
+    if (progress) std::cout << "Загрузка " << terms_count << " терминов..." << std::endl;
+    
+    bool ok = true;
+    std::string term;
+    for (uint64_t i = 0; ok && i < terms_count; ++i) {
+        uint64_t prefix;
+        std::string_view suffix;
+        std::vector<Posting> postings;
+        ok = varint::get(p, end, prefix) && prefix <= term.size() &&
+             varint::get_string(p, end, suffix) &&
+             posting_codec::decode(p, end, postings);
+        if (!ok) break;
+        
+        term.resize(prefix);
+        term.append(suffix.data(), suffix.size());
+        
+        terms.emplace_hint(terms.end(), term, std::move(postings));
+        
+        if (progress && (i + 1) % 10000 == 0) {
+            std::cout << "\rЗагружено терминов: " << (i + 1) << " / " << terms_count << std::flush;
+        }
+    }
+    if (progress && terms_count >= 10000) std::cout << std::endl;
+    return ok;
+}
+
+}
 
 void InvertedIndex::build_from_file(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Ошибка открытия файла: " << filename << std::endl;
+    trace::Span span("index_build");
+    if (corpus::is_binary_file(filename)) {
+        build_from_binary(filename);
         return;
     }
     
-    std::string line;
+    utils::LineReader reader;
+    if (!reader.open(filename)) {
+        return;
+    }
+    
+    std::string_view line;
+    corpus::TermsView doc;
+    std::vector<std::string> terms;
     int docs_processed = 0;
     
     std::cout << "Построение индекса..." << std::endl;
     
-    while (std::getline(file, line)) {
-        auto parts = utils::split(line, '|');
-        if (parts.size() < 4) continue;
+    while (reader.next(line)) {
+        if (!corpus::parse_terms_line(line, doc)) continue;
         
-        int doc_id = std::stoi(parts[0]);
-        std::string source = parts[1];
-        std::string title = parts[2];
-        std::string terms_str = parts[3];
+        terms.assign(doc.terms.begin(), doc.terms.end());
+        add_document(doc.doc_id, std::string(doc.title), std::string(doc.source), terms);
         
-        auto terms = utils::split(terms_str, ' ');
+        docs_processed++;
+        if (docs_processed % 1000 == 0) {
+            std::cout << "\rОбработано: " << docs_processed << std::flush;
+        }
+    }
+    
+    std::cout << "\nИндекс построен: " << docs_processed << " документов" << std::endl;
+}
+
+void InvertedIndex::build_from_binary(const std::string& filename) {
+    corpus::Reader reader;
+    if (!reader.open(filename)) {
+        return;
+    }
+    
+    std::cout << "Построение индекса (двоичный корпус)..." << std::endl;
+    
+    corpus::TermsView doc;
+    std::vector<std::string> terms;
+    int docs_processed = 0;
+    
+    for (size_t i = 0; i < reader.size(); ++i) {
+        if (!reader.read_terms(i, doc)) continue;
         
-        add_document(doc_id, title, source, terms);
+        terms.assign(doc.terms.begin(), doc.terms.end());
+        add_document(doc.doc_id, std::string(doc.title), std::string(doc.source), terms);
         
         docs_processed++;
         if (docs_processed % 1000 == 0) {
@@ -36,12 +206,18 @@ void InvertedIndex::build_from_file(const std::string& filename) {
     }
     
     std::cout << "\nИндекс построен: " << docs_processed << " документов" << std::endl;
-    file.close();
 }
 
 void InvertedIndex::add_document(int doc_id, const std::string& title,
                                  const std::string& source,
                                  const std::vector<std::string>& terms) {
+    static trace::Counter& documents_total = trace::counter(
+        "index_documents_total", "Документов добавлено в индекс");
+    static trace::Counter& postings_total = trace::counter(
+        "index_terms_total", "Словоупотреблений добавлено в индекс");
+    documents_total.add();
+    postings_total.add(terms.size());
+    
     DocumentMeta meta;
     meta.doc_id = doc_id;
     meta.title = title;
@@ -60,6 +236,242 @@ void InvertedIndex::add_document(int doc_id, const std::string& title,
         
         postings.back().positions.push_back(position);
     }
+    
+    total_tokens += terms.size();
+    vocabulary_growth.observe(total_tokens, index.size());
+}
+
+void InvertedIndex::reorder_documents(const doc_reorder::Options& options) {
+    if (options.mode == doc_reorder::Mode::NONE || documents.empty()) return;
+    
+    trace::Span span("index_reorder");
+    utils::Timer timer;
+    
+    // Плотные номера документов в текущем порядке
+    std::vector<int> keys;
+    std::vector<doc_reorder::Document> docs;
+    keys.reserve(documents.size());
+    docs.reserve(documents.size());
+    for (const auto& entry : documents) {
+        keys.push_back(entry.first);
+        docs.push_back({&entry.second.source, &entry.second.title});
+    }
+    // Обычно идентификаторы и так идут подряд, и поиск не нужен
+    bool contiguous = static_cast<size_t>(keys.back()) - keys.front() + 1 == keys.size();
+    auto dense_id = [&](int doc_id) {
+        if (contiguous) return static_cast<uint32_t>(doc_id - keys.front());
+        return static_cast<uint32_t>(std::lower_bound(keys.begin(), keys.end(), doc_id) - keys.begin());
+    };
+    
+    // Граф документ-терм без термов из одного документа
+    doc_reorder::DocumentTerms doc_terms;
+    doc_terms.offsets.assign(keys.size() + 1, 0);
+    for (const auto& entry : index) {
+        if (entry.second.size() < 2) continue;
+        for (const auto& posting : entry.second) {
+            doc_terms.offsets[dense_id(posting.doc_id) + 1]++;
+        }
+    }
+    for (size_t i = 1; i < doc_terms.offsets.size(); ++i) {
+        doc_terms.offsets[i] += doc_terms.offsets[i - 1];
+    }
+    
+    doc_terms.terms.resize(doc_terms.offsets.back());
+    std::vector<uint32_t> fill(doc_terms.offsets.begin(), doc_terms.offsets.end() - 1);
+    for (const auto& entry : index) {
+        if (entry.second.size() < 2) continue;
+        for (const auto& posting : entry.second) {
+            doc_terms.terms[fill[dense_id(posting.doc_id)]++] = doc_terms.terms_count;
+        }
+        doc_terms.terms_count++;
+    }
+    
+    std::vector<uint32_t> identity(keys.size());
+    for (size_t i = 0; i < identity.size(); ++i) identity[i] = static_cast<uint32_t>(i);
+    double gap_before = doc_reorder::average_log_gap(doc_terms, identity);
+    
+    std::vector<uint32_t> order = doc_reorder::compute_order(docs, doc_terms, options);
+    double gap_after = doc_reorder::average_log_gap(doc_terms, order);
+    
+    std::vector<int> new_ids(keys.size());
+    std::map<int, DocumentMeta> renumbered;
+    for (size_t n = 0; n < order.size(); ++n) {
+        new_ids[order[n]] = static_cast<int>(n);
+        renumbered.emplace_hint(renumbered.end(), static_cast<int>(n),
+                                std::move(documents[keys[order[n]]]));
+    }
+    documents.swap(renumbered);
+    
+    for (auto& entry : index) {
+        for (auto& posting : entry.second) {
+            posting.doc_id = new_ids[dense_id(posting.doc_id)];
+        }
+        std::sort(entry.second.begin(), entry.second.end(), by_doc_id);
+    }
+    for (auto& entry : bigrams) {
+        for (auto& posting : entry.second) {
+            posting.doc_id = new_ids[dense_id(posting.doc_id)];
+        }
+        std::sort(entry.second.begin(), entry.second.end(), by_doc_id);
+    }
+    if (!doc_sets.empty()) build_doc_sets();
+    
+    std::cout << "Перенумерация документов (" << doc_reorder::mode_name(options.mode) << "): "
+              << timer.elapsed_ms() << " мс" << std::endl;
+    std::cout << "Средний log2 разрыва в постингах: " << gap_before
+              << " -> " << gap_after << std::endl;
+}
+
+InvertedIndex InvertedIndex::extract_documents(int first_doc, int end_doc) const {
+    InvertedIndex part;
+    part.documents.insert(documents.lower_bound(first_doc), documents.lower_bound(end_doc));
+    
+    // Для роста словаря шарда: сколько термов впервые встречается в
+    // каждом документе, если читать шард по возрастанию номеров
+    std::map<int, uint64_t> new_terms;
+    for (const auto& entry : index) {
+        std::vector<Posting> postings;
+        int first = end_doc;
+        for (const auto& posting : entry.second) {
+            if (posting.doc_id >= first_doc && posting.doc_id < end_doc) {
+                postings.push_back(posting);
+                first = std::min(first, posting.doc_id);
+            }
+        }
+        if (!postings.empty()) {
+            part.index.emplace_hint(part.index.end(), entry.first, std::move(postings));
+            new_terms[first]++;
+        }
+    }
+    
+    uint64_t vocabulary = 0;
+    for (const auto& entry : part.documents) {
+        part.total_tokens += entry.second.length;
+        auto it = new_terms.find(entry.first);
+        if (it != new_terms.end()) vocabulary += it->second;
+        part.vocabulary_growth.observe(part.total_tokens, vocabulary);
+    }
+    return part;
+}
+
+size_t InvertedIndex::build_bigrams(uint64_t min_document_frequency) {
+    trace::Span span("index_bigrams");
+    utils::Timer timer;
+    bigrams.clear();
+    bigram_min_df = min_document_frequency;
+    if (min_document_frequency == 0 || documents.empty()) return 0;
+    
+    // Частые термы по статистике коллекции; термы в ней в том же
+    // порядке, что и в словаре
+    index_stats::CollectionStatistics stats = get_collection_statistics();
+    std::vector<const std::string*> frequent_terms;
+    std::vector<const std::vector<Posting>*> frequent_postings;
+    auto stat = stats.terms.begin();
+    for (auto& entry : index) {
+        if ((stat++)->document_frequency < min_document_frequency) continue;
+        // Ниже списки обходятся курсорами по возрастанию документов
+        if (!std::is_sorted(entry.second.begin(), entry.second.end(), by_doc_id)) {
+            std::stable_sort(entry.second.begin(), entry.second.end(), by_doc_id);
+        }
+        frequent_terms.push_back(&entry.first);
+        frequent_postings.push_back(&entry.second);
+    }
+    
+    // Документы обходятся диапазонами: вхождения частых термов диапазона
+    // сортируются по (документ, позиция), соседние дают пары. Так в памяти
+    // одновременно только вхождения одного диапазона.
+    struct Occurrence {
+        int doc_id;
+        int position;
+        uint32_t term;
+        
+        bool operator<(const Occurrence& other) const {
+            return doc_id != other.doc_id ? doc_id < other.doc_id : position < other.position;
+        }
+    };
+    
+    std::map<std::pair<uint32_t, uint32_t>, std::vector<Posting>> pairs;
+    std::vector<size_t> cursors(frequent_postings.size(), 0);
+    std::vector<Occurrence> occurrences;
+    const int64_t range = 4096;
+    int64_t last_doc = documents.rbegin()->first;
+    for (int64_t lo = documents.begin()->first; lo <= last_doc; lo += range) {
+        int64_t hi = lo + range;
+        occurrences.clear();
+        for (size_t t = 0; t < frequent_postings.size(); ++t) {
+            const auto& postings = *frequent_postings[t];
+            size_t& cursor = cursors[t];
+            for (; cursor < postings.size() && postings[cursor].doc_id < hi; ++cursor) {
+                for (int position : postings[cursor].positions) {
+                    occurrences.push_back({postings[cursor].doc_id, position, static_cast<uint32_t>(t)});
+                }
+            }
+        }
+        std::sort(occurrences.begin(), occurrences.end());
+        
+        for (size_t i = 1; i < occurrences.size(); ++i) {
+            const Occurrence& a = occurrences[i - 1];
+            const Occurrence& b = occurrences[i];
+            if (a.doc_id != b.doc_id || b.position != a.position + 1) continue;
+            
+            auto& postings = pairs[{a.term, b.term}];
+            if (postings.empty() || postings.back().doc_id != a.doc_id) {
+                postings.emplace_back(a.doc_id);
+            }
+            postings.back().positions.push_back(a.position);
+        }
+    }
+    
+    for (auto& entry : pairs) {
+        bigrams.emplace(bigram_key(*frequent_terms[entry.first.first], *frequent_terms[entry.first.second]),
+                        std::move(entry.second));
+    }
+    
+    std::cout << "Биграммы: " << bigrams.size() << " пар из " << frequent_terms.size()
+              << " термов с df >= " << min_document_frequency << ", "
+              << timer.elapsed_ms() << " мс" << std::endl;
+    return bigrams.size();
+}
+
+void InvertedIndex::build_doc_sets() {
+    trace::Span span("index_doc_sets");
+    doc_sets.clear();
+    
+    // Множества термов независимы и строятся задачами пула,
+    // в словарь вставляются по порядку
+    std::vector<const std::pair<const std::string, std::vector<Posting>>*> entries;
+    entries.reserve(index.size() + bigrams.size());
+    for (const auto& entry : index) {
+        entries.push_back(&entry);
+    }
+    // Ключи биграмм содержат пробел и с термами не пересекаются
+    for (const auto& entry : bigrams) {
+        entries.push_back(&entry);
+    }
+    
+    std::vector<RoaringBitmap> sets(entries.size());
+    utils::ThreadPool::shared().parallel_for(0, entries.size(), 256, [&](size_t lo, size_t hi) {
+        std::vector<int> doc_ids;
+        for (size_t i = lo; i < hi; ++i) {
+            doc_ids.clear();
+            for (const auto& posting : entries[i]->second) {
+                doc_ids.push_back(posting.doc_id);
+            }
+            if (!std::is_sorted(doc_ids.begin(), doc_ids.end())) {
+                std::sort(doc_ids.begin(), doc_ids.end());
+            }
+            sets[i] = RoaringBitmap::from_sorted(doc_ids);
+        }
+    });
+    
+    for (size_t i = 0; i < entries.size(); ++i) {
+        doc_sets.emplace(entries[i]->first, std::move(sets[i]));
+    }
+}
+
+const RoaringBitmap* InvertedIndex::get_doc_set(const std::string& term) const {
+    auto it = doc_sets.find(term);
+    return it != doc_sets.end() ? &it->second : nullptr;
 }
 
 std::vector<int> InvertedIndex::get_postings(const std::string& term) const {
@@ -83,63 +495,76 @@ const std::vector<Posting>* InvertedIndex::get_postings_with_positions(const std
     return &(it->second);
 }
 
+const std::vector<Posting>* InvertedIndex::get_bigram_postings(const std::string& key) const {
+    auto it = bigrams.find(key);
+    return it != bigrams.end() ? &it->second : nullptr;
+}
+
 void InvertedIndex::save_to_file(const std::string& filename) const {
-    std::ofstream file(filename, std::ios::binary);
+    trace::Span span("index_save");
+    // Пишем во временный файл и переименовываем: работающий bool_search
+    // никогда не увидит наполовину записанный индекс
+    std::string tmp_filename = filename + ".tmp";
+    std::ofstream file(tmp_filename, std::ios::binary);
     if (!file.is_open()) {
-        std::cerr << "Ошибка создания файла: " << filename << std::endl;
+        std::cerr << "Ошибка создания файла: " << tmp_filename << std::endl;
         return;
     }
     
-    size_t terms_count = index.size();
-    file.write(reinterpret_cast<const char*>(&terms_count), sizeof(terms_count));
-    
-    for (const auto& entry : index) {
-        const std::string& term = entry.first;
-        const auto& postings = entry.second;
-        
-        size_t term_len = term.length();
-        file.write(reinterpret_cast<const char*>(&term_len), sizeof(term_len));
-        file.write(term.c_str(), term_len);
-        
-        size_t postings_count = postings.size();
-        file.write(reinterpret_cast<const char*>(&postings_count), sizeof(postings_count));
-        
-        for (const auto& posting : postings) {
-            file.write(reinterpret_cast<const char*>(&posting.doc_id), sizeof(posting.doc_id));
-            
-            size_t positions_count = posting.positions.size();
-            file.write(reinterpret_cast<const char*>(&positions_count), sizeof(positions_count));
-            file.write(reinterpret_cast<char*>(const_cast<int*>(posting.positions.data())),
-                      positions_count * sizeof(int));
-        }
+    std::string documents_section;
+    varint::put(documents_section, documents.size());
+    int previous_id = 0;
+    for (const auto& entry : documents) {
+        const auto& meta = entry.second;
+        put_gap(documents_section, entry.first, previous_id);
+        varint::put(documents_section, static_cast<uint32_t>(meta.doc_id));
+        varint::put(documents_section, static_cast<uint32_t>(meta.length));
+        varint::put_string(documents_section, meta.title);
+        varint::put_string(documents_section, meta.source);
     }
     
-    size_t docs_count = documents.size();
-    file.write(reinterpret_cast<const char*>(&docs_count), sizeof(docs_count));
+    std::string terms_section;
+    encode_terms(terms_section, index);
     
-    for (const auto& entry : documents) {
-        const auto& meta = entry.second;
-        file.write(reinterpret_cast<const char*>(&meta.doc_id), sizeof(meta.doc_id));
-        file.write(reinterpret_cast<const char*>(&meta.length), sizeof(meta.length));
-        
-        size_t title_len = meta.title.length();
-        file.write(reinterpret_cast<const char*>(&title_len), sizeof(title_len));
-        file.write(meta.title.c_str(), title_len);
-        
-        size_t source_len = meta.source.length();
-        file.write(reinterpret_cast<const char*>(&source_len), sizeof(source_len));
-        file.write(meta.source.c_str(), source_len);
+    // Биграммы — отдельной секцией: старые читатели её пропускают
+    std::string bigrams_section;
+    if (!bigrams.empty()) {
+        varint::put(bigrams_section, bigram_min_df);
+        encode_terms(bigrams_section, bigrams);
     }
     
+    std::string statistics_section;
+    get_collection_statistics().encode(statistics_section);
+    
+    uint64_t file_size = index_format::write_sections(file, {
+        {index_format::SECTION_DOCUMENTS, &documents_section},
+        {index_format::SECTION_TERMS, &terms_section},
+        {index_format::SECTION_STATISTICS, &statistics_section},
+        {index_format::SECTION_BIGRAMS, &bigrams_section},
+    });
+    
     file.close();
-    std::cout << "Индекс сохранён: " << filename << std::endl;
+    if (file.fail()) {
+        std::cerr << "Ошибка записи файла: " << tmp_filename << std::endl;
+        std::remove(tmp_filename.c_str());
+        return;
+    }
+    
+    if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+        std::cerr << "Ошибка переименования " << tmp_filename << " -> " << filename << std::endl;
+        std::remove(tmp_filename.c_str());
+        return;
+    }
+    
+    std::cout << "Индекс сохранён: " << filename << " (" << file_size << " байт)" << std::endl;
 }
 
-void InvertedIndex::load_from_file(const std::string& filename) {
+bool InvertedIndex::load_from_file(const std::string& filename) {
+    trace::Span span("index_load");
     std::ifstream file(filename, std::ios::binary);
     if (!file.is_open()) {
         std::cerr << "Ошибка открытия: " << filename << std::endl;
-        return;
+        return false;
     }
     
     file.seekg(0, std::ios::end);
@@ -149,11 +574,109 @@ void InvertedIndex::load_from_file(const std::string& filename) {
     if (file_size < 8) {
         std::cerr << "Файл индекса повреждён (слишком мал)" << std::endl;
         file.close();
-        return;
+        return false;
+    }
+    
+    if (!quiet) std::cout << "📂 Загрузка индекса (" << file_size << " байт)..." << std::endl;
+    
+    char magic[sizeof(index_format::MAGIC)];
+    file.read(magic, sizeof(magic));
+    bool loaded;
+    if (index_format::has_magic(magic, sizeof(magic))) {
+        file.close();
+        loaded = load_sections(filename);
+    } else {
+        // Индексы, записанные до появления формата v2
+        file.seekg(0, std::ios::beg);
+        loaded = load_legacy(file);
     }
     
-    std::cout << "📂 Загрузка индекса (" << file_size << " байт)..." << std::endl;
+    if (loaded) {
+        total_tokens = 0;
+        for (const auto& entry : documents) {
+            total_tokens += entry.second.length;
+        }
+        build_doc_sets();
+    }
+    return loaded;
+}
+
+bool InvertedIndex::load_sections(const std::string& filename) {
+    utils::MappedFile file;
+    if (!file.open(filename)) return false;
+    
+    std::map<uint32_t, std::string_view> sections;
+    if (!index_format::read_sections(file, sections)) return false;
+    
+    if (sections.count(index_format::SECTION_SHARDS)) {
+        std::cerr << "Это оглавление шардированного индекса, шарды загружает bool_search: "
+                  << filename << std::endl;
+        return false;
+    }
     
+    std::string_view documents_section = sections[index_format::SECTION_DOCUMENTS];
+    std::string_view terms_section = sections[index_format::SECTION_TERMS];
+    
+    // Из статистики нужен только рост словаря: остальное пересчитывается
+    // по постингам при следующем сохранении
+    auto statistics = sections.find(index_format::SECTION_STATISTICS);
+    if (statistics != sections.end()) {
+        index_stats::CollectionStatistics saved;
+        if (saved.decode(statistics->second)) {
+            vocabulary_growth.restore(saved.growth);
+        }
+    }
+    
+    bool ok = true;
+    
+    const char* p = documents_section.data();
+    const char* end = p + documents_section.size();
+    uint64_t docs_count = 0;
+    ok = ok && varint::get(p, end, docs_count) && docs_count <= documents_section.size();
+    
+    if (!quiet) std::cout << "Загрузка метаданных " << docs_count << " документов..." << std::endl;
+    
+    int doc_id = 0;
+    for (uint64_t i = 0; ok && i < docs_count; ++i) {
+        DocumentMeta meta;
+        std::string_view title, source;
+        ok = get_gap(p, end, doc_id) &&
+             varint::get_int(p, end, meta.doc_id) &&
+             varint::get_int(p, end, meta.length) &&
+             varint::get_string(p, end, title) &&
+             varint::get_string(p, end, source);
+        if (!ok) break;
+        
+        meta.title.assign(title.data(), title.size());
+        meta.source.assign(source.data(), source.size());
+        documents.emplace_hint(documents.end(), doc_id, std::move(meta));
+    }
+    
+    p = terms_section.data();
+    end = p + terms_section.size();
+    ok = ok && decode_terms(p, end, index, !quiet);
+    
+    auto bigrams_section = sections.find(index_format::SECTION_BIGRAMS);
+    if (ok && bigrams_section != sections.end() && !bigrams_section->second.empty()) {
+        p = bigrams_section->second.data();
+        end = p + bigrams_section->second.size();
+        ok = varint::get(p, end, bigram_min_df) && decode_terms(p, end, bigrams, false);
+        if (ok && !quiet) std::cout << "Загружено биграмм: " << bigrams.size() << std::endl;
+    }
+    
+    if (!ok) {
+        std::cerr << "Индекс повреждён. Пересоздайте его." << std::endl;
+        index.clear();
+        bigrams.clear();
+        documents.clear();
+        return false;
+    }
+    
+    if (!quiet) std::cout << "Индекс загружен успешно" << std::endl;
+    return true;
+}
+
+bool InvertedIndex::load_legacy(std::ifstream& file) {
     size_t terms_count;
     file.read(reinterpret_cast<char*>(&terms_count), sizeof(terms_count));
     
@@ -161,10 +684,10 @@ void InvertedIndex::load_from_file(const std::string& filename) {
         std::cerr << "Ошибка: слишком много терминов (" << terms_count << ")" << std::endl;
         std::cerr << "Индекс повреждён. Пересоздайте его." << std::endl;
         file.close();
-        return;
+        return false;
     }
     
-    std::cout << "Загрузка " << terms_count << " терминов..." << std::endl;
+    if (!quiet) std::cout << "Загрузка " << terms_count << " терминов..." << std::endl;
     
     for (size_t i = 0; i < terms_count; ++i) {
         size_t term_len;
@@ -173,7 +696,7 @@ void InvertedIndex::load_from_file(const std::string& filename) {
         if (term_len > 1000) {
             std::cerr << "Ошибка: слишком длинный термин (" << term_len << ")" << std::endl;
             file.close();
-            return;
+            return false;
         }
         
         std::string term(term_len, '\0');
@@ -185,7 +708,7 @@ void InvertedIndex::load_from_file(const std::string& filename) {
         if (postings_count > 1000000) {
             std::cerr << "Ошибка: слишком много постингов для '" << term << "' (" << postings_count << ")" << std::endl;
             file.close();
-            return;
+            return false;
         }
         
         std::vector<Posting> postings;
@@ -201,7 +724,7 @@ void InvertedIndex::load_from_file(const std::string& filename) {
             if (positions_count > 100000) {
                 std::cerr << "Ошибка: слишком много позиций (" << positions_count << ")" << std::endl;
                 file.close();
-                return;
+                return false;
             }
             
             posting.positions.resize(positions_count);
@@ -214,11 +737,11 @@ void InvertedIndex::load_from_file(const std::string& filename) {
         index[term] = postings;
         
         if ((i + 1) % 10000 == 0) {
-            std::cout << "\rЗагружено терминов: " << (i + 1) << " / " << terms_count << std::flush;
+            if (!quiet) std::cout << "\rЗагружено терминов: " << (i + 1) << " / " << terms_count << std::flush;
         }
     }
     
-    std::cout << std::endl;
+    if (!quiet) std::cout << std::endl;
     
     size_t docs_count;
     file.read(reinterpret_cast<char*>(&docs_count), sizeof(docs_count));
@@ -226,10 +749,10 @@ void InvertedIndex::load_from_file(const std::string& filename) {
     if (docs_count > 10000000) {
         std::cerr << "Ошибка: слишком много документов (" << docs_count << ")" << std::endl;
         file.close();
-        return;
+        return false;
     }
     
-    std::cout << "Загрузка метаданных " << docs_count << " документов..." << std::endl;
+    if (!quiet) std::cout << "Загрузка метаданных " << docs_count << " документов..." << std::endl;
     
     for (size_t i = 0; i < docs_count; ++i) {
         DocumentMeta meta;
@@ -242,7 +765,7 @@ void InvertedIndex::load_from_file(const std::string& filename) {
         if (title_len > 1000) {
             std::cerr << "Ошибка: слишком длинный заголовок (" << title_len << ")" << std::endl;
             file.close();
-            return;
+            return false;
         }
         
         meta.title.resize(title_len);
@@ -254,7 +777,7 @@ void InvertedIndex::load_from_file(const std::string& filename) {
         if (source_len > 100) {
             std::cerr << "Ошибка: слишком длинное имя источника (" << source_len << ")" << std::endl;
             file.close();
-            return;
+            return false;
         }
         
         meta.source.resize(source_len);
@@ -263,11 +786,11 @@ void InvertedIndex::load_from_file(const std::string& filename) {
         documents[meta.doc_id] = meta;
         
         if ((i + 1) % 10000 == 0) {
-            std::cout << "\rЗагружено документов: " << (i + 1) << " / " << docs_count << std::flush;
+            if (!quiet) std::cout << "\rЗагружено документов: " << (i + 1) << " / " << docs_count << std::flush;
         }
     }
     
-    std::cout << std::endl;
+    if (!quiet) std::cout << std::endl;
     
     file.close();
     
@@ -275,10 +798,11 @@ void InvertedIndex::load_from_file(const std::string& filename) {
         std::cerr << "Ошибка чтения файла" << std::endl;
         index.clear();
         documents.clear();
-        return;
+        return false;
     }
     
-    std::cout << "Индекс загружен успешно" << std::endl;
+    if (!quiet) std::cout << "Индекс загружен успешно" << std::endl;
+    return true;
 }
 
 void InvertedIndex::print_statistics() const {
@@ -293,9 +817,50 @@ void InvertedIndex::print_statistics() const {
     std::cout << "Документов: " << documents.size() << std::endl;
     std::cout << "Уникальных термов: " << index.size() << std::endl;
     std::cout << "Средняя длина постинг-листа: " << avg_postings << std::endl;
+    if (!bigrams.empty()) {
+        size_t bigram_postings = 0;
+        for (const auto& entry : bigrams) {
+            bigram_postings += entry.second.size();
+        }
+        std::cout << "Биграмм: " << bigrams.size() << " (df термов >= " << bigram_min_df
+                  << ", постингов " << bigram_postings << ")" << std::endl;
+    }
+    
+    if (!doc_sets.empty()) {
+        RoaringBitmap::Statistics containers;
+        for (const auto& entry : doc_sets) {
+            containers.merge(entry.second.get_statistics());
+        }
+        std::cout << "Контейнеры: массивов " << containers.arrays
+                  << ", битовых карт " << containers.bitmaps
+                  << ", серий " << containers.runs
+                  << " (" << containers.bytes / 1024 << " КБ)" << std::endl;
+    }
     std::cout << "==============================\n" << std::endl;
 }
 
+index_stats::CollectionStatistics InvertedIndex::get_collection_statistics() const {
+    index_stats::CollectionStatistics stats;
+    stats.documents = documents.size();
+    for (const auto& entry : documents) {
+        stats.tokens += entry.second.length;
+    }
+    
+    stats.terms.reserve(index.size());
+    for (const auto& entry : index) {
+        index_stats::TermStatistics term;
+        term.term = entry.first;
+        term.document_frequency = entry.second.size();
+        for (const auto& posting : entry.second) {
+            term.collection_frequency += posting.positions.size();
+        }
+        stats.terms.push_back(std::move(term));
+    }
+    
+    stats.growth = vocabulary_growth.get_points();
+    return stats;
+}
+
 const DocumentMeta* InvertedIndex::get_document_meta(int doc_id) const {
     auto it = documents.find(doc_id);
     if (it == documents.end()) {
@@ -5,6 +5,9 @@
 #include <vector>
 #include <map>
 #include <fstream>
+#include "index/doc_reorder.h"
+#include "index/roaring.h"
+#include "index/index_statistics.h"
 
 struct Posting {
     int doc_id;
@@ -13,6 +16,21 @@ struct Posting {
     Posting(int id) : doc_id(id) {}
 };
 
+// Список постингов терма в секции термов индекса: число постингов, затем
+// для каждого разность doc_id, число позиций и разности позиций (varint).
+// Постинги должны идти по возрастанию doc_id.
+namespace posting_codec {
+
+void encode(std::string& out, const std::vector<Posting>& postings);
+
+// Дописывает постинги в postings; false, если данные повреждены
+bool decode(const char*& p, const char* end, std::vector<Posting>& postings);
+
+}
+
+// Ключ в documents и doc_id в постингах — внутренний номер документа.
+// После перенумерации он отличается от внешнего идентификатора из
+// корпуса, который хранится здесь в doc_id.
 struct DocumentMeta {
     int doc_id;
     std::string title;
@@ -24,6 +42,26 @@ class InvertedIndex {
 private:
     std::map<std::string, std::vector<Posting>> index;
     std::map<int, DocumentMeta> documents;
+    // Множества документов для булева поиска, по одному на терм и биграмму
+    std::map<std::string, RoaringBitmap> doc_sets;
+    
+    // Пары соседних частых термов под ключом bigram_key; позиция
+    // в постинге — позиция первого терма пары
+    std::map<std::string, std::vector<Posting>> bigrams;
+    // Порог частоты, по которому выбирались термы пар; 0 — биграмм нет
+    uint64_t bigram_min_df = 0;
+    
+    // Не печатать ход загрузки; ошибки печатаются всегда
+    bool quiet = false;
+    
+    // Рост словаря по мере добавления документов, для закона Хипса
+    uint64_t total_tokens = 0;
+    index_stats::GrowthSampler vocabulary_growth;
+    
+    void build_from_binary(const std::string& filename);
+    
+    bool load_legacy(std::ifstream& file);
+    bool load_sections(const std::string& filename);
     
 public:
     void build_from_file(const std::string& filename);
@@ -32,18 +70,59 @@ public:
                      const std::string& source,
                      const std::vector<std::string>& terms);
     
+    // Перенумеровывает документы подряд с нуля в порядке, который
+    // выбирает options.mode; внешние идентификаторы сохраняются в meta.
+    // Вызывается после добавления всех документов.
+    void reorder_documents(const doc_reorder::Options& options);
+    
+    // Копия документов [first_doc, end_doc) с их постингами, номера
+    // документов те же; из неё пишется шард. Биграммы не копируются:
+    // порог частоты у шарда свой. Рост словаря считается заново по
+    // документам шарда в порядке номеров.
+    InvertedIndex extract_documents(int first_doc, int end_doc) const;
+    
+    // Индексирует все пары соседних термов, у которых оба терма встречаются
+    // не меньше чем в min_document_frequency документах. Пары, которой
+    // нет среди биграмм, в тексте нет ни разу. 0 — удалить биграммы.
+    // Возвращает число биграмм.
+    size_t build_bigrams(uint64_t min_document_frequency);
+    
+    // Строит doc_sets по постингам; вызывается после построения или загрузки
+    void build_doc_sets();
+    
     std::vector<int> get_postings(const std::string& term) const;
     
+    // nullptr, если терма нет или doc_sets ещё не построены
+    const RoaringBitmap* get_doc_set(const std::string& term) const;
+    
     const std::vector<Posting>* get_postings_with_positions(const std::string& term) const;
     
+    // Ключ пары в словаре биграмм; пробел не встречается в термах
+    static std::string bigram_key(const std::string& first, const std::string& second) {
+        return first + ' ' + second;
+    }
+    
+    const std::vector<Posting>* get_bigram_postings(const std::string& key) const;
+    
+    uint64_t get_bigram_min_df() const { return bigram_min_df; }
+    size_t get_bigrams_count() const { return bigrams.size(); }
+    
     void save_to_file(const std::string& filename) const;
     
-    void load_from_file(const std::string& filename);
+    bool load_from_file(const std::string& filename);
+    
+    void set_quiet(bool value) { quiet = value; }
     
     void print_statistics() const;
     
+    // Частоты термов, число документов и словоупотреблений, рост словаря
+    index_stats::CollectionStatistics get_collection_statistics() const;
+    
     const DocumentMeta* get_document_meta(int doc_id) const;
     
+    const std::map<std::string, std::vector<Posting>>& get_terms() const { return index; }
+    const std::map<int, DocumentMeta>& get_documents() const { return documents; }
+    
     size_t get_index_size() const { return index.size(); }
     size_t get_documents_count() const { return documents.size(); }
 };
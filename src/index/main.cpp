@@ -1,20 +1,134 @@
 #include "index/inverted_index.h"
+#include "index/index_shards.h"
+#include "common/thread_pool.h"
+#include "common/trace.h"
+#include "common/utils.h"
 #include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+struct BigramThreshold {
+    double value = 0;
+    bool percent = false;
+    
+    // Порог не ниже 2: пары редких термов фразовый поиск находит и так
+    // быстро. 0 — биграммы не строятся.
+    uint64_t min_df(size_t documents) const {
+        if (value <= 0) return 0;
+        uint64_t df = percent ? static_cast<uint64_t>(value / 100 * documents)
+                              : static_cast<uint64_t>(value);
+        return std::max<uint64_t>(2, df);
+    }
+};
+
+// Документы делятся на shards_count диапазонов поровну по числу
+// документов; каждый шард — обычный индекс со своими биграммами,
+// доля в пороге биграмм считается от шарда
+bool write_shards(const InvertedIndex& index, const std::string& output_file,
+                  size_t shards_count, const BigramThreshold& bigrams) {
+    const auto& documents = index.get_documents();
+    std::vector<index_shards::Shard> shards;
+    auto it = documents.begin();
+    for (size_t i = 0; i < shards_count && it != documents.end(); ++i) {
+        size_t docs = documents.size() / shards_count + (i < documents.size() % shards_count);
+        index_shards::Shard shard;
+        shard.file = index_shards::shard_file_name(output_file, i);
+        shard.first_doc = it->first;
+        std::advance(it, docs);
+        shard.end_doc = it == documents.end() ? documents.rbegin()->first + 1 : it->first;
+        
+        utils::Timer timer;
+        InvertedIndex part = index.extract_documents(shard.first_doc, shard.end_doc);
+        if (uint64_t min_df = bigrams.min_df(part.get_documents_count())) {
+            part.build_bigrams(min_df);
+        }
+        part.save_to_file(index_shards::shard_path(output_file, shard));
+        std::cout << "Шард " << i << ": документы [" << shard.first_doc << ", " << shard.end_doc
+                  << "), " << part.get_documents_count() << " документов, "
+                  << part.get_index_size() << " термов, " << timer.elapsed_ms() << " мс" << std::endl;
+        shards.push_back(std::move(shard));
+    }
+    
+    if (!index_shards::write_manifest(output_file, shards)) return false;
+    std::cout << "Оглавление шардов: " << output_file << " (" << shards.size() << " шардов)" << std::endl;
+    return true;
+}
+
+}
 
 int main(int argc, char* argv[]) {
-    if (argc < 3) {
-        std::cout << "Использование: " << argv[0] << " <input_stems> <output_index>" << std::endl;
+    int threads = utils::extract_threads_option(argc, argv, utils::default_thread_count());
+    bool pool_stats = utils::extract_flag(argc, argv, "--pool-stats");
+    utils::ThreadPool::configure_shared(threads);
+    trace::Session tracing(argc, argv);
+    
+    doc_reorder::Options reorder;
+    reorder.mode = doc_reorder::Mode::NONE;
+    // Порог частоты термов для биграмм: число документов или доля коллекции
+    std::string bigram_min_df = "1%";
+    size_t shards = 1;
+    
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--reorder") == 0 && i + 1 < argc) {
+            if (!doc_reorder::parse_mode(argv[++i], reorder.mode)) {
+                std::cerr << "Неизвестный режим перенумерации: " << argv[i]
+                          << " (none, source, bisection)" << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--bigram-min-df") == 0 && i + 1 < argc) {
+            bigram_min_df = argv[++i];
+        } else if (std::strcmp(argv[i], "--shards") == 0 && i + 1 < argc) {
+            shards = std::max(1, std::atoi(argv[++i]));
+        } else {
+            positional.push_back(argv[i]);
+        }
+    }
+    
+    if (positional.size() < 2) {
+        std::cout << "Использование: " << argv[0] << " <input_stems> <output_index>"
+                  << " [--reorder none|source|bisection] [--bigram-min-df N|P%] [--shards N]"
+                  << " [--threads N] [--pool-stats] [--trace FILE] [--metrics FILE]" << std::endl;
+        std::cout << "  --bigram-min-df  пары соседних термов, оба из которых встречаются"
+                  << " хотя бы в N документах (или P% коллекции), индексируются как"
+                  << " отдельные термы; 0 — без биграмм (1%)" << std::endl;
+        std::cout << "  --shards N       разбить индекс на N диапазонов документов:"
+                  << " <output_index> — оглавление, шарды — <output_index>.shard0, ..." << std::endl;
         return 1;
     }
     
-    std::string input_file = argv[1];
-    std::string output_file = argv[2];
+    char* end = nullptr;
+    BigramThreshold bigrams;
+    bigrams.value = std::strtod(bigram_min_df.c_str(), &end);
+    bigrams.percent = *end == '%';
+    if (end == bigram_min_df.c_str() || bigrams.value < 0 || (*end && !(bigrams.percent && !end[1]))) {
+        std::cerr << "Неверный порог биграмм: " << bigram_min_df << std::endl;
+        return 1;
+    }
+    
+    std::string input_file = positional[0];
+    std::string output_file = positional[1];
     
     InvertedIndex index;
     
     index.build_from_file(input_file);
-    index.print_statistics();
-    index.save_to_file(output_file);
+    index.reorder_documents(reorder);
+    
+    if (shards > 1) {
+        index.print_statistics();
+        if (!write_shards(index, output_file, shards, bigrams)) return 1;
+    } else {
+        if (uint64_t min_df = bigrams.min_df(index.get_documents_count())) {
+            index.build_bigrams(min_df);
+        }
+        index.build_doc_sets();
+        index.print_statistics();
+        index.save_to_file(output_file);
+    }
+    if (pool_stats) utils::ThreadPool::shared().print_statistics();
     
     return 0;
 }
@@ -0,0 +1,351 @@
+#include "index/roaring.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+void set_range(uint64_t* words, uint32_t begin, uint32_t end) {
+    // Биты [begin, end] включительно
+    uint32_t first = begin / 64;
+    uint32_t last = end / 64;
+    uint64_t first_mask = ~0ULL << (begin % 64);
+    uint64_t last_mask = ~0ULL >> (63 - end % 64);
+
+    if (first == last) {
+        words[first] |= first_mask & last_mask;
+        return;
+    }
+    words[first] |= first_mask;
+    for (uint32_t w = first + 1; w < last; ++w) {
+        words[w] = ~0ULL;
+    }
+    words[last] |= last_mask;
+}
+
+template <typename F>
+void for_each_bit(const uint64_t* words, size_t count, F&& f) {
+    for (size_t w = 0; w < count; ++w) {
+        uint64_t word = words[w];
+        while (word != 0) {
+            f(static_cast<uint32_t>(w * 64 + __builtin_ctzll(word)));
+            word &= word - 1;
+        }
+    }
+}
+
+}
+
+bool RoaringBitmap::Container::contains(uint16_t value) const {
+    switch (type) {
+        case ContainerType::ARRAY:
+            return std::binary_search(values.begin(), values.end(), value);
+        case ContainerType::BITMAP:
+            return (words[value / 64] >> (value % 64)) & 1;
+        case ContainerType::RUN: {
+            // Последняя серия, начинающаяся не позже value
+            size_t lo = 0, hi = values.size() / 2;
+            while (lo < hi) {
+                size_t mid = (lo + hi) / 2;
+                if (values[mid * 2] <= value) lo = mid + 1;
+                else hi = mid;
+            }
+            if (lo == 0) return false;
+            uint32_t start = values[(lo - 1) * 2];
+            return value <= start + values[(lo - 1) * 2 + 1];
+        }
+    }
+    return false;
+}
+
+void RoaringBitmap::Container::fill_words(uint64_t* out) const {
+    if (type == ContainerType::BITMAP) {
+        std::memcpy(out, words.data(), BITMAP_WORDS * sizeof(uint64_t));
+        return;
+    }
+    std::memset(out, 0, BITMAP_WORDS * sizeof(uint64_t));
+    if (type == ContainerType::ARRAY) {
+        for (uint16_t value : values) {
+            out[value / 64] |= 1ULL << (value % 64);
+        }
+    } else {
+        for (size_t i = 0; i < values.size(); i += 2) {
+            set_range(out, values[i], static_cast<uint32_t>(values[i]) + values[i + 1]);
+        }
+    }
+}
+
+size_t RoaringBitmap::Container::size_in_bytes() const {
+    return values.size() * sizeof(uint16_t) + words.size() * sizeof(uint64_t);
+}
+
+RoaringBitmap::Container RoaringBitmap::make_container(uint16_t key, const uint16_t* values,
+                                                       size_t count) {
+    Container container;
+    container.key = key;
+    container.cardinality = static_cast<uint32_t>(count);
+
+    size_t runs = count > 0 ? 1 : 0;
+    for (size_t i = 1; i < count; ++i) {
+        if (values[i] != values[i - 1] + 1) runs++;
+    }
+
+    size_t array_bytes = count * sizeof(uint16_t);
+    size_t bitmap_bytes = BITMAP_WORDS * sizeof(uint64_t);
+    size_t run_bytes = runs * 2 * sizeof(uint16_t);
+
+    if (run_bytes < std::min(array_bytes, bitmap_bytes)) {
+        container.type = ContainerType::RUN;
+        container.values.reserve(runs * 2);
+        size_t start = 0;
+        for (size_t i = 1; i <= count; ++i) {
+            if (i == count || values[i] != values[i - 1] + 1) {
+                container.values.push_back(values[start]);
+                container.values.push_back(static_cast<uint16_t>(i - 1 - start));
+                start = i;
+            }
+        }
+    } else if (count <= ARRAY_MAX) {
+        container.type = ContainerType::ARRAY;
+        container.values.assign(values, values + count);
+    } else {
+        container.type = ContainerType::BITMAP;
+        container.words.assign(BITMAP_WORDS, 0);
+        for (size_t i = 0; i < count; ++i) {
+            container.words[values[i] / 64] |= 1ULL << (values[i] % 64);
+        }
+    }
+    return container;
+}
+
+bool RoaringBitmap::from_words(uint16_t key, const uint64_t* words, Container& out) {
+    uint32_t cardinality = 0;
+    for (size_t w = 0; w < BITMAP_WORDS; ++w) {
+        cardinality += __builtin_popcountll(words[w]);
+    }
+    if (cardinality == 0) return false;
+
+    out.key = key;
+    out.cardinality = cardinality;
+    if (cardinality <= ARRAY_MAX) {
+        out.type = ContainerType::ARRAY;
+        out.values.clear();
+        out.values.reserve(cardinality);
+        for_each_bit(words, BITMAP_WORDS, [&](uint32_t bit) {
+            out.values.push_back(static_cast<uint16_t>(bit));
+        });
+    } else {
+        out.type = ContainerType::BITMAP;
+        out.words.assign(words, words + BITMAP_WORDS);
+    }
+    return true;
+}
+
+void RoaringBitmap::Container::append_values(std::vector<uint16_t>& out) const {
+    switch (type) {
+        case ContainerType::ARRAY:
+            out.insert(out.end(), values.begin(), values.end());
+            break;
+        case ContainerType::BITMAP:
+            for_each_bit(words.data(), BITMAP_WORDS, [&](uint32_t bit) {
+                out.push_back(static_cast<uint16_t>(bit));
+            });
+            break;
+        case ContainerType::RUN:
+            for (size_t i = 0; i < values.size(); i += 2) {
+                uint32_t start = values[i];
+                for (uint32_t v = start; v <= start + values[i + 1]; ++v) {
+                    out.push_back(static_cast<uint16_t>(v));
+                }
+            }
+            break;
+    }
+}
+
+bool RoaringBitmap::combine(const Container& a, const Container& b, Operation op, Container& out) {
+    // Маленькие блоки любого вида дешевле обработать поэлементно,
+    // чем разворачивать в две битовые карты по 8 КБ
+    std::vector<uint16_t> result;
+    
+    if (op == Operation::OR && a.type == ContainerType::ARRAY && b.type == ContainerType::ARRAY) {
+        result.reserve(a.values.size() + b.values.size());
+        std::set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(),
+                       std::back_inserter(result));
+        out = make_container(a.key, result.data(), result.size());
+        return true;
+    }
+    if (op == Operation::OR && a.cardinality + b.cardinality <= ARRAY_MAX) {
+        std::vector<uint16_t> left, right;
+        a.append_values(left);
+        b.append_values(right);
+        std::set_union(left.begin(), left.end(), right.begin(), right.end(),
+                       std::back_inserter(result));
+        out = make_container(a.key, result.data(), result.size());
+        return true;
+    }
+
+    const Container* probe = nullptr;
+    const Container* other = nullptr;
+    if (op == Operation::AND) {
+        probe = a.cardinality <= b.cardinality ? &a : &b;
+        other = probe == &a ? &b : &a;
+    } else if (op == Operation::AND_NOT) {
+        probe = &a;
+        other = &b;
+    }
+
+    if (probe && probe->cardinality <= ARRAY_MAX) {
+        if (op == Operation::AND && probe->type == ContainerType::ARRAY &&
+            other->type == ContainerType::ARRAY) {
+            std::set_intersection(probe->values.begin(), probe->values.end(),
+                                  other->values.begin(), other->values.end(),
+                                  std::back_inserter(result));
+        } else {
+            std::vector<uint16_t> candidates;
+            probe->append_values(candidates);
+            bool keep_present = op == Operation::AND;
+            for (uint16_t value : candidates) {
+                if (other->contains(value) == keep_present) result.push_back(value);
+            }
+        }
+        if (result.empty()) return false;
+        out = make_container(a.key, result.data(), result.size());
+        return true;
+    }
+
+    // Плотные блоки: пословные операции над битовыми картами
+    uint64_t left[BITMAP_WORDS];
+    uint64_t right[BITMAP_WORDS];
+    a.fill_words(left);
+    b.fill_words(right);
+    switch (op) {
+        case Operation::AND:
+            for (size_t w = 0; w < BITMAP_WORDS; ++w) left[w] &= right[w];
+            break;
+        case Operation::OR:
+            for (size_t w = 0; w < BITMAP_WORDS; ++w) left[w] |= right[w];
+            break;
+        case Operation::AND_NOT:
+            for (size_t w = 0; w < BITMAP_WORDS; ++w) left[w] &= ~right[w];
+            break;
+    }
+    return from_words(a.key, left, out);
+}
+
+void RoaringBitmap::push(Container&& container) {
+    total += container.cardinality;
+    containers.push_back(std::move(container));
+}
+
+RoaringBitmap RoaringBitmap::apply(const RoaringBitmap& a, const RoaringBitmap& b, Operation op) {
+    RoaringBitmap result;
+    size_t i = 0, j = 0;
+
+    while (i < a.containers.size() || j < b.containers.size()) {
+        bool has_a = i < a.containers.size();
+        bool has_b = j < b.containers.size();
+
+        if (has_a && has_b && a.containers[i].key == b.containers[j].key) {
+            Container combined;
+            if (combine(a.containers[i], b.containers[j], op, combined)) {
+                result.push(std::move(combined));
+            }
+            i++;
+            j++;
+        } else if (has_a && (!has_b || a.containers[i].key < b.containers[j].key)) {
+            if (op != Operation::AND) result.push(Container(a.containers[i]));
+            i++;
+        } else {
+            if (op == Operation::OR) result.push(Container(b.containers[j]));
+            j++;
+        }
+
+        // Дальше в пересечении и разности ничего не появится
+        if (op != Operation::OR && i == a.containers.size()) break;
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::from_sorted(const std::vector<int>& ids) {
+    RoaringBitmap result;
+    std::vector<uint16_t> low;
+    low.reserve(std::min(ids.size(), static_cast<size_t>(65536)));
+
+    size_t i = 0;
+    while (i < ids.size()) {
+        uint32_t key = static_cast<uint32_t>(ids[i]) >> 16;
+        low.clear();
+        for (; i < ids.size() && (static_cast<uint32_t>(ids[i]) >> 16) == key; ++i) {
+            uint16_t value = static_cast<uint16_t>(ids[i]);
+            if (low.empty() || low.back() != value) low.push_back(value);
+        }
+        result.push(make_container(static_cast<uint16_t>(key), low.data(), low.size()));
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::intersect(const RoaringBitmap& a, const RoaringBitmap& b) {
+    return apply(a, b, Operation::AND);
+}
+
+RoaringBitmap RoaringBitmap::unite(const RoaringBitmap& a, const RoaringBitmap& b) {
+    return apply(a, b, Operation::OR);
+}
+
+RoaringBitmap RoaringBitmap::subtract(const RoaringBitmap& a, const RoaringBitmap& b) {
+    return apply(a, b, Operation::AND_NOT);
+}
+
+bool RoaringBitmap::contains(int id) const {
+    uint16_t key = static_cast<uint16_t>(static_cast<uint32_t>(id) >> 16);
+    auto it = std::lower_bound(containers.begin(), containers.end(), key,
+                               [](const Container& c, uint16_t k) { return c.key < k; });
+    return it != containers.end() && it->key == key && it->contains(static_cast<uint16_t>(id));
+}
+
+std::vector<int> RoaringBitmap::to_vector(size_t limit) const {
+    size_t count = limit > 0 ? std::min(limit, total) : total;
+    std::vector<int> ids;
+    ids.reserve(count);
+
+    // Контейнеры идут по возрастанию ключа: после count номеров дальше не смотрим
+    for (const auto& container : containers) {
+        if (ids.size() == count) break;
+        uint32_t base = static_cast<uint32_t>(container.key) << 16;
+        switch (container.type) {
+            case ContainerType::ARRAY:
+                for (uint16_t value : container.values) {
+                    if (ids.size() == count) break;
+                    ids.push_back(static_cast<int>(base | value));
+                }
+                break;
+            case ContainerType::BITMAP:
+                for_each_bit(container.words.data(), BITMAP_WORDS, [&](uint32_t bit) {
+                    if (ids.size() < count) ids.push_back(static_cast<int>(base | bit));
+                });
+                break;
+            case ContainerType::RUN:
+                for (size_t i = 0; i < container.values.size() && ids.size() < count; i += 2) {
+                    uint32_t start = container.values[i];
+                    uint32_t last = start + container.values[i + 1];
+                    for (uint32_t v = start; v <= last && ids.size() < count; ++v) {
+                        ids.push_back(static_cast<int>(base | v));
+                    }
+                }
+                break;
+        }
+    }
+    return ids;
+}
+
+RoaringBitmap::Statistics RoaringBitmap::get_statistics() const {
+    Statistics stats;
+    for (const auto& container : containers) {
+        switch (container.type) {
+            case ContainerType::ARRAY: stats.arrays++; break;
+            case ContainerType::BITMAP: stats.bitmaps++; break;
+            case ContainerType::RUN: stats.runs++; break;
+        }
+        stats.bytes += container.size_in_bytes();
+    }
+    return stats;
+}
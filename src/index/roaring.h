@@ -0,0 +1,87 @@
+#ifndef ROARING_H
+#define ROARING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Множество номеров документов в духе Roaring (Lemire et al.).
+// Номера делятся на блоки по 65536 по старшим 16 битам, и для каждого
+// блока выбирается свой контейнер:
+//   ARRAY  — отсортированный массив младших 16 бит (до 4096 значений),
+//   BITMAP — 1024 слова по 64 бита,
+//   RUN    — серии подряд идущих номеров (начало, длина - 1).
+// AND, OR и NOT между плотными блоками выполняются по словам, а не по
+// отдельным номерам. Номера документов неотрицательны.
+class RoaringBitmap {
+public:
+    enum class ContainerType : uint8_t {
+        ARRAY,
+        BITMAP,
+        RUN
+    };
+
+    static const size_t ARRAY_MAX = 4096;
+    static const size_t BITMAP_WORDS = 1024;
+
+    struct Statistics {
+        size_t arrays = 0;
+        size_t bitmaps = 0;
+        size_t runs = 0;
+        size_t bytes = 0;
+
+        void merge(const Statistics& other) {
+            arrays += other.arrays;
+            bitmaps += other.bitmaps;
+            runs += other.runs;
+            bytes += other.bytes;
+        }
+    };
+
+private:
+    struct Container {
+        uint16_t key = 0;
+        ContainerType type = ContainerType::ARRAY;
+        uint32_t cardinality = 0;
+        // ARRAY: значения; RUN: пары (начало, длина - 1)
+        std::vector<uint16_t> values;
+        // BITMAP: BITMAP_WORDS слов
+        std::vector<uint64_t> words;
+
+        bool contains(uint16_t value) const;
+        void fill_words(uint64_t* out) const;
+        void append_values(std::vector<uint16_t>& out) const;
+        size_t size_in_bytes() const;
+    };
+
+    std::vector<Container> containers;
+    size_t total = 0;
+
+    static Container make_container(uint16_t key, const uint16_t* values, size_t count);
+    static bool from_words(uint16_t key, const uint64_t* words, Container& out);
+
+    enum class Operation { AND, OR, AND_NOT };
+    static bool combine(const Container& a, const Container& b, Operation op, Container& out);
+    static RoaringBitmap apply(const RoaringBitmap& a, const RoaringBitmap& b, Operation op);
+
+    void push(Container&& container);
+
+public:
+    // ids — по возрастанию; повторы пропускаются
+    static RoaringBitmap from_sorted(const std::vector<int>& ids);
+
+    static RoaringBitmap intersect(const RoaringBitmap& a, const RoaringBitmap& b);
+    static RoaringBitmap unite(const RoaringBitmap& a, const RoaringBitmap& b);
+    static RoaringBitmap subtract(const RoaringBitmap& a, const RoaringBitmap& b);
+
+    bool contains(int id) const;
+    // Первые limit номеров по возрастанию; 0 — все
+    std::vector<int> to_vector(size_t limit = 0) const;
+
+    size_t cardinality() const { return total; }
+    bool empty() const { return total == 0; }
+
+    Statistics get_statistics() const;
+};
+
+#endif
@@ -0,0 +1,254 @@
+#include "ingest/ingest_pipeline.h"
+#include "common/bounded_queue.h"
+#include "common/corpus_format.h"
+#include "common/trace.h"
+#include "crawler/crawler.h"
+#include "tokenizer/tokenizer.h"
+#include "stemmer/stemmer.h"
+#include "stemmer/stem_cache.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// Время в микросекундах копится атомарно: стадию обслуживают несколько потоков
+void add_elapsed(std::atomic<uint64_t>& total_us, const utils::Timer& timer) {
+    total_us += static_cast<uint64_t>(timer.elapsed_ms() * 1000);
+}
+
+void write_terms_line(std::ostream& out, const utils::Document& doc,
+                      const std::vector<std::string>& terms) {
+    std::string line;
+    corpus::append_terms_line(line, doc.doc_id, doc.source, doc.title, terms);
+    out << line;
+}
+
+}
+
+bool IngestPipeline::run(const std::vector<std::string>& json_files, InvertedIndex& index) {
+    utils::Timer total_timer;
+    stats = Statistics();
+
+    std::ofstream corpus_dump, tokens_dump, stems_dump;
+    if (!options.dump_dir.empty()) {
+        corpus_dump.open(options.dump_dir + "/corpus.txt");
+        tokens_dump.open(options.dump_dir + "/tokens.txt");
+        stems_dump.open(options.dump_dir + "/stems.txt");
+        if (!corpus_dump.is_open() || !tokens_dump.is_open() || !stems_dump.is_open()) {
+            std::cerr << "Ошибка: не удалось создать файлы в " << options.dump_dir << std::endl;
+            return false;
+        }
+    }
+
+    int threads = std::max(1, options.threads);
+    int tokenizer_threads = std::max(1, threads / 2);
+    int stemmer_threads = std::max(1, threads - tokenizer_threads);
+    size_t max_in_flight = std::max<size_t>(1, options.max_batches_in_flight);
+    size_t batch_size = std::max<size_t>(1, options.batch_size);
+
+    std::cout << "Сквозная загрузка: " << json_files.size() << " файл(ов), "
+              << tokenizer_threads << " поток(ов) токенизации, "
+              << stemmer_threads << " поток(ов) стемминга" << std::endl;
+
+    utils::BoundedQueue<Batch> to_tokenize(max_in_flight);
+    utils::BoundedQueue<Batch> to_stem(max_in_flight);
+    utils::BoundedQueue<Batch> to_index(max_in_flight);
+
+    // Пакет занимает слот от чтения до добавления в индекс, поэтому
+    // в памяти никогда не больше max_in_flight пакетов, даже если
+    // индексатор отстаёт и копит пакеты для восстановления порядка
+    std::mutex flight_mutex;
+    std::condition_variable flight_released;
+    size_t in_flight = 0;
+
+    ConcurrentStemCache stem_cache(options.stem_cache_entries);
+
+    std::atomic<uint64_t> tokenize_us{0};
+    std::atomic<uint64_t> stem_us{0};
+    std::atomic<int> tokenizers_left{tokenizer_threads};
+    std::atomic<int> stemmers_left{stemmer_threads};
+
+    std::vector<std::thread> workers;
+
+    static trace::Counter& documents_total = trace::counter(
+        "ingest_documents_total", "Документов добавлено в индекс при сквозной загрузке");
+    static trace::Histogram& batch_latency = trace::histogram(
+        "ingest_batch_latency_us", "Время пакета от чтения до добавления в индекс, мкс");
+    
+    for (int t = 0; t < tokenizer_threads; ++t) {
+        workers.emplace_back([&, t]() {
+            trace::set_thread_name("tokenize-" + std::to_string(t));
+            Tokenizer tokenizer;
+            Batch batch;
+            while (to_tokenize.pop(batch)) {
+                trace::Span span("ingest_tokenize");
+                utils::Timer timer;
+                batch.tokens.resize(batch.documents.size());
+                for (size_t i = 0; i < batch.documents.size(); ++i) {
+                    const auto& views = tokenizer.tokenize_view(batch.documents[i].text);
+                    batch.tokens[i].assign(views.begin(), views.end());
+                }
+                add_elapsed(tokenize_us, timer);
+                to_stem.push(std::move(batch));
+            }
+            if (--tokenizers_left == 0) to_stem.close();
+        });
+    }
+
+    for (int t = 0; t < stemmer_threads; ++t) {
+        workers.emplace_back([&, t]() {
+            trace::set_thread_name("stem-" + std::to_string(t));
+            // Собственный кэш стеммера отключён: потоки делят общий кэш
+            Stemmer stemmer(0);
+            std::string cached;
+            Batch batch;
+            while (to_stem.pop(batch)) {
+                trace::Span span("ingest_stem");
+                utils::Timer timer;
+                batch.stems.resize(batch.tokens.size());
+                for (size_t i = 0; i < batch.tokens.size(); ++i) {
+                    auto& stems = batch.stems[i];
+                    stems.clear();
+                    stems.reserve(batch.tokens[i].size());
+                    for (const auto& token : batch.tokens[i]) {
+                        if (stem_cache.lookup(token, cached)) {
+                            stems.push_back(cached);
+                            continue;
+                        }
+                        std::string_view stem = stemmer.stem_view(token);
+                        stem_cache.insert(token, stem);
+                        stems.emplace_back(stem);
+                    }
+                }
+                add_elapsed(stem_us, timer);
+                to_index.push(std::move(batch));
+            }
+            if (--stemmers_left == 0) to_index.close();
+        });
+    }
+
+    workers.emplace_back([&]() {
+        trace::set_thread_name("index");
+        // Пакеты приходят в произвольном порядке; индекс заполняется по seq,
+        // чтобы результат не зависел от числа потоков
+        std::map<size_t, Batch> pending;
+        size_t next_seq = 0;
+        Batch batch;
+
+        while (to_index.pop(batch)) {
+            pending.emplace(batch.seq, std::move(batch));
+
+            for (auto it = pending.find(next_seq); it != pending.end();
+                 it = pending.find(next_seq)) {
+                trace::Span span("ingest_index");
+                utils::Timer timer;
+                Batch& ready = it->second;
+
+                for (size_t i = 0; i < ready.documents.size(); ++i) {
+                    const utils::Document& doc = ready.documents[i];
+                    index.add_document(doc.doc_id, doc.title, doc.source, ready.stems[i]);
+                    stats.tokens += ready.tokens[i].size();
+
+                    if (corpus_dump.is_open()) {
+                        utils::write_document_line(corpus_dump, doc);
+                        write_terms_line(tokens_dump, doc, ready.tokens[i]);
+                        write_terms_line(stems_dump, doc, ready.stems[i]);
+                    }
+
+                    stats.documents++;
+                    if (stats.documents % 5000 == 0) {
+                        std::cout << "Проиндексировано документов: " << stats.documents << std::endl;
+                    }
+                }
+
+                stats.index_ms += timer.elapsed_ms();
+                documents_total.add(ready.documents.size());
+                batch_latency.record(static_cast<uint64_t>(ready.age.elapsed_ms() * 1000));
+                pending.erase(it);
+                next_seq++;
+
+                {
+                    std::lock_guard<std::mutex> lock(flight_mutex);
+                    in_flight--;
+                }
+                flight_released.notify_one();
+            }
+        }
+    });
+
+    // Стадия обхода работает в вызывающем потоке
+    Crawler crawler;
+    if (options.dedup) {
+        NearDuplicateFilter::Options dedup_options;
+        dedup_options.threshold = options.dedup_threshold;
+        crawler.enable_dedup(dedup_options);
+    }
+    size_t next_seq = 0;
+    Batch current;
+
+    auto flush = [&]() {
+        {
+            std::unique_lock<std::mutex> lock(flight_mutex);
+            flight_released.wait(lock, [&] { return in_flight < max_in_flight; });
+            in_flight++;
+        }
+        current.seq = next_seq++;
+        to_tokenize.push(std::move(current));
+        current = Batch();
+        current.documents.reserve(batch_size);
+    };
+
+    bool ok = true;
+    for (const auto& file : json_files) {
+        // Идентификаторы назначает Crawler, как при отдельном запуске crawler:
+        // номер объекта в JSON, отклонённые тоже занимают номер. Счётчик
+        // общий, поэтому номера сквозные по всем входным файлам
+        ok &= crawler.crawl_stream(file, [&](utils::Document& doc) {
+            current.documents.push_back(std::move(doc));
+            if (current.documents.size() >= batch_size) flush();
+        });
+    }
+    if (!current.documents.empty()) flush();
+    to_tokenize.close();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    stats.json_documents = crawler.get_total_count();
+    stats.rejected = crawler.get_failed_count();
+    stats.duplicates = crawler.get_duplicate_count();
+    stats.tokenize_ms = tokenize_us / 1000.0;
+    stats.stem_ms = stem_us / 1000.0;
+    stats.stem_cache_hit_rate = stem_cache.get_statistics().hit_rate();
+    stats.elapsed_ms = total_timer.elapsed_ms();
+
+    return ok;
+}
+
+void IngestPipeline::print_statistics() const {
+    std::cout << "\n=== Статистика сквозной загрузки ===" << std::endl;
+    std::cout << "Документов в JSON: " << stats.json_documents << std::endl;
+    std::cout << "Отклонено при обходе: " << stats.rejected << std::endl;
+    if (options.dedup) {
+        std::cout << "Почти-дубликатов удалено: " << stats.duplicates << std::endl;
+    }
+    std::cout << "Проиндексировано документов: " << stats.documents << std::endl;
+    std::cout << "Всего токенов: " << stats.tokens << std::endl;
+    std::cout << "Токенизация (сумма по потокам): " << stats.tokenize_ms << " мс" << std::endl;
+    std::cout << "Стемминг (сумма по потокам): " << stats.stem_ms << " мс" << std::endl;
+    std::cout << "Добавление в индекс: " << stats.index_ms << " мс" << std::endl;
+    std::cout << "Попадания в кэш стемов: " << (stats.stem_cache_hit_rate * 100) << "%" << std::endl;
+    std::cout << "Общее время: " << stats.elapsed_ms << " мс" << std::endl;
+
+    if (stats.elapsed_ms > 0) {
+        std::cout << "Скорость: " << (stats.documents * 1000.0 / stats.elapsed_ms)
+                  << " док/сек" << std::endl;
+    }
+}
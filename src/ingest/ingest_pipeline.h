@@ -0,0 +1,61 @@
+#ifndef INGEST_PIPELINE_H
+#define INGEST_PIPELINE_H
+
+#include "common/utils.h"
+#include "index/inverted_index.h"
+#include <string>
+#include <vector>
+
+// Сквозная загрузка JSON -> index.bin в одном процессе.
+// Стадии Crawler, Tokenizer, Stemmer и InvertedIndex работают одновременно
+// и передают друг другу пакеты документов через ограниченные очереди,
+// без промежуточных corpus.txt / tokens.txt / stems.txt.
+class IngestPipeline {
+public:
+    struct Options {
+        int threads = 1;
+        size_t batch_size = 256;
+        // Пакетов в работе одновременно, от чтения до добавления в индекс
+        size_t max_batches_in_flight = 64;
+        size_t stem_cache_entries = 262144;
+        // Отбрасывать почти-дубликаты при обходе
+        bool dedup = false;
+        double dedup_threshold = 0.8;
+        // Если задан — туда пишутся corpus.txt, tokens.txt и stems.txt для отладки
+        std::string dump_dir;
+    };
+
+    struct Batch {
+        size_t seq = 0;
+        std::vector<utils::Document> documents;
+        std::vector<std::vector<std::string>> tokens;
+        std::vector<std::vector<std::string>> stems;
+        // С начала наполнения пакета
+        utils::Timer age;
+    };
+
+private:
+    Options options;
+
+    struct Statistics {
+        size_t json_documents = 0;
+        size_t documents = 0;
+        size_t rejected = 0;
+        size_t duplicates = 0;
+        size_t tokens = 0;
+        double tokenize_ms = 0;
+        double stem_ms = 0;
+        double index_ms = 0;
+        double elapsed_ms = 0;
+        double stem_cache_hit_rate = 0;
+    } stats;
+
+public:
+    explicit IngestPipeline(const Options& opts) : options(opts) {}
+
+    bool run(const std::vector<std::string>& json_files, InvertedIndex& index);
+
+    void print_statistics() const;
+};
+
+#endif
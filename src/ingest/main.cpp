@@ -0,0 +1,71 @@
+#include "ingest/ingest_pipeline.h"
+#include "crawler/dedup.h"
+#include "common/thread_pool.h"
+#include "common/trace.h"
+#include "common/utils.h"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char* argv[]) {
+    int threads = utils::extract_threads_option(argc, argv, utils::default_thread_count());
+    utils::ThreadPool::configure_shared(threads);
+    trace::Session tracing(argc, argv);
+    
+    IngestPipeline::Options options;
+    options.threads = threads;
+    
+    doc_reorder::Options reorder;
+    reorder.mode = doc_reorder::Mode::NONE;
+    
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--dump-dir") == 0 && i + 1 < argc) {
+            options.dump_dir = argv[++i];
+        } else if (std::strcmp(argv[i], "--dedup") == 0) {
+            options.dedup = true;
+        } else if (std::strcmp(argv[i], "--dedup-threshold") == 0 && i + 1 < argc) {
+            options.dedup = true;
+            if (!NearDuplicateFilter::parse_threshold(argv[++i], options.dedup_threshold)) {
+                std::cerr << "Неверный порог дубликатов: " << argv[i]
+                          << " (ожидается число в (0, 1])" << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--reorder") == 0 && i + 1 < argc) {
+            if (!doc_reorder::parse_mode(argv[++i], reorder.mode)) {
+                std::cerr << "Неизвестный режим перенумерации: " << argv[i]
+                          << " (none, source, bisection)" << std::endl;
+                return 1;
+            }
+        } else {
+            positional.push_back(argv[i]);
+        }
+    }
+    
+    if (positional.size() < 2) {
+        std::cout << "Использование: " << argv[0]
+                 << " <output_index> <input_json>... [--threads N] [--trace FILE] [--metrics FILE] [--dump-dir DIR]"
+                 << " [--dedup] [--dedup-threshold J] [--reorder none|source|bisection]" << std::endl;
+        std::cout << "Пример: ./ingest data/index/index.bin data/raw/wikipedia_cars.json data/raw/wikipedia_moto.json"
+                 << std::endl;
+        return 1;
+    }
+    
+    std::string output_file = positional[0];
+    std::vector<std::string> input_files(positional.begin() + 1, positional.end());
+    
+    IngestPipeline pipeline(options);
+    InvertedIndex index;
+    
+    if (!pipeline.run(input_files, index)) {
+        return 1;
+    }
+    
+    index.reorder_documents(reorder);
+    index.print_statistics();
+    index.save_to_file(output_file);
+    
+    pipeline.print_statistics();
+    
+    return 0;
+}
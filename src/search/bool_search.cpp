@@ -1,8 +1,11 @@
 #include "search/bool_search.h"
+#include "common/trace.h"
+#include "common/utf8.h"
 #include <iostream>
 #include <sstream>
 #include <chrono>
 #include <algorithm>
+#include <cstdio>
 
 SearchResult BoolSearch::search_term(const std::string& term) {
     auto start = std::chrono::high_resolution_clock::now();
@@ -17,61 +20,292 @@ SearchResult BoolSearch::search_term(const std::string& term) {
     return result;
 }
 
-std::set<int> BoolSearch::intersect(const std::set<int>& s1, const std::set<int>& s2) {
-    std::set<int> result;
-    std::set_intersection(s1.begin(), s1.end(), s2.begin(), s2.end(),
-                         std::inserter(result, result.begin()));
-    return result;
+const RoaringBitmap& BoolSearch::doc_set(const std::string& term) {
+    if (const RoaringBitmap* set = index.get_doc_set(term)) {
+        return *set;
+    }
+    fallback = RoaringBitmap::from_sorted(index.get_postings(term));
+    return fallback;
 }
 
-std::set<int> BoolSearch::union_sets(const std::set<int>& s1, const std::set<int>& s2) {
-    std::set<int> result;
-    std::set_union(s1.begin(), s1.end(), s2.begin(), s2.end(),
-                  std::inserter(result, result.begin()));
-    return result;
+const RoaringBitmap& BoolSearch::doc_set(const std::string& key, const std::vector<Posting>& postings) {
+    if (const RoaringBitmap* set = index.get_doc_set(key)) {
+        return *set;
+    }
+    std::vector<int> doc_ids;
+    doc_ids.reserve(postings.size());
+    for (const auto& posting : postings) {
+        doc_ids.push_back(posting.doc_id);
+    }
+    fallback = RoaringBitmap::from_sorted(doc_ids);
+    return fallback;
 }
 
-std::set<int> BoolSearch::difference(const std::set<int>& s1, const std::set<int>& s2) {
-    std::set<int> result;
-    std::set_difference(s1.begin(), s1.end(), s2.begin(), s2.end(),
-                       std::inserter(result, result.begin()));
-    return result;
+namespace {
+
+std::string operand_text(const std::string* terms, size_t count) {
+    if (count == 1) return terms[0];
+    
+    std::string text = "\"";
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) text += ' ';
+        text += terms[i];
+    }
+    return text + "\"";
+}
+
+}
+
+std::string QueryOperand::to_string() const {
+    return terms.empty() ? std::string() : operand_text(terms.data(), terms.size());
+}
+
+void QueryExplain::print(std::ostream& out) const {
+    out << "  шаг     операнд                          докум.       итог   постинги        мкс\n";
+    char numbers[128];
+    for (const auto& step : steps) {
+        // Ширина столбца операнда — в символах, а не байтах UTF-8
+        std::string operand = step.operand;
+        size_t width = utf8::length(operand);
+        if (width < 28) operand.append(28 - width, ' ');
+        
+        std::snprintf(numbers, sizeof(numbers), " %10zu %10zu %10zu %10.1f\n",
+                      step.operand_docs, step.result_docs, step.postings_scanned, step.time_us);
+        std::string operation = step.operation;
+        operation.resize(7, ' ');
+        out << "  " << operation << " " << operand << numbers;
+        if (!step.plan.empty()) out << "          план: " << step.plan << "\n";
+    }
+    out << "  всего просмотрено постингов: " << postings_scanned << "\n";
+}
+
+bool BoolSearch::plan_phrase(const std::string* terms, size_t count,
+                             std::vector<PhraseUnit>& units) const {
+    uint64_t min_df = use_bigrams ? index.get_bigram_min_df() : 0;
+    
+    std::vector<const std::vector<Posting>*> lists(count);
+    for (size_t i = 0; i < count; ++i) {
+        lists[i] = index.get_postings_with_positions(terms[i]);
+        if (!lists[i]) return false;
+    }
+    
+    // Пара берётся, если покрывает ещё не покрытый терм: для "a b c"
+    // это [a b] и [b c] со смещением 1
+    std::vector<bool> covered(count, false);
+    for (size_t i = 0; min_df > 0 && i + 1 < count; ++i) {
+        if (lists[i]->size() < min_df || lists[i + 1]->size() < min_df) continue;
+        if (covered[i] && covered[i + 1]) continue;
+        
+        std::string key = InvertedIndex::bigram_key(terms[i], terms[i + 1]);
+        const std::vector<Posting>* postings = index.get_bigram_postings(key);
+        // Индексируются все пары частых термов, так что пары нет в тексте
+        if (!postings) return false;
+        
+        units.push_back({std::move(key), postings, static_cast<int>(i)});
+        covered[i] = covered[i + 1] = true;
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        if (!covered[i]) units.push_back({terms[i], lists[i], static_cast<int>(i)});
+    }
+    return true;
+}
+
+RoaringBitmap BoolSearch::phrase_set(const std::string* terms, size_t count, size_t& postings_scanned,
+                                     std::string* plan) {
+    std::vector<PhraseUnit> units;
+    bool possible = plan_phrase(terms, count, units);
+    if (plan) {
+        for (const auto& unit : units) {
+            if (!plan->empty()) *plan += ' ';
+            *plan += unit.key.find(' ') != std::string::npos ? "[" + unit.key + "]" : unit.key;
+            if (unit.offset > 0) *plan += "@" + std::to_string(unit.offset);
+        }
+        if (!possible) *plan += plan->empty() ? "нет в индексе" : " (нет в индексе)";
+    }
+    if (!possible) return RoaringBitmap();
+    
+    const size_t n = units.size();
+    if (n == 1) {
+        const RoaringBitmap& set = doc_set(units[0].key, *units[0].postings);
+        postings_scanned += set.cardinality();
+        return set;
+    }
+    
+    std::sort(units.begin(), units.end(), [](const PhraseUnit& a, const PhraseUnit& b) {
+        return a.postings->size() < b.postings->size();
+    });
+    
+    RoaringBitmap candidates = doc_set(units[0].key, *units[0].postings);
+    postings_scanned += candidates.cardinality();
+    for (size_t k = 1; k < n && !candidates.empty(); ++k) {
+        const RoaringBitmap& next = doc_set(units[k].key, *units[k].postings);
+        postings_scanned += next.cardinality();
+        candidates = RoaringBitmap::intersect(candidates, next);
+    }
+    
+    // Кандидаты идут по возрастанию, поэтому позиция в каждом списке
+    // постингов только сдвигается вперёд
+    std::vector<size_t> cursor(n, 0);
+    std::vector<const std::vector<int>*> positions(n);
+    std::vector<int> matched;
+    for (int doc_id : candidates.to_vector()) {
+        for (size_t i = 0; i < n; ++i) {
+            const std::vector<Posting>& list = *units[i].postings;
+            auto it = std::lower_bound(list.begin() + cursor[i], list.end(), doc_id,
+                                       [](const Posting& p, int id) { return p.doc_id < id; });
+            cursor[i] = it - list.begin();
+            positions[i] = &it->positions;
+        }
+        
+        // Опорная часть — с наименьшим числом вхождений в документе
+        size_t anchor = 0;
+        for (size_t i = 1; i < n; ++i) {
+            if (positions[i]->size() < positions[anchor]->size()) anchor = i;
+        }
+        postings_scanned += positions[anchor]->size();
+        
+        for (int position : *positions[anchor]) {
+            int start = position - units[anchor].offset;
+            if (start < 0) continue;
+            
+            bool found = true;
+            for (size_t i = 0; i < n && found; ++i) {
+                if (i == anchor) continue;
+                found = std::binary_search(positions[i]->begin(), positions[i]->end(),
+                                           start + units[i].offset);
+            }
+            if (found) {
+                matched.push_back(doc_id);
+                break;
+            }
+        }
+    }
+    return RoaringBitmap::from_sorted(matched);
+}
+
+ParsedQuery BoolSearch::parse_query(const std::string& query) {
+    std::istringstream iss(query);
+    ParsedQuery parsed;
+    
+    std::string token;
+    while (iss >> token) {
+        if (token == "AND") {
+            parsed.operators.push_back(BoolOperator::AND);
+        } else if (token == "OR") {
+            parsed.operators.push_back(BoolOperator::OR);
+        } else if (token == "NOT") {
+            parsed.operators.push_back(BoolOperator::NOT);
+        } else if (token[0] == '"') {
+            // Фраза до слова, которое кончается кавычкой, или до конца запроса
+            QueryOperand operand;
+            token.erase(0, 1);
+            bool closed = false;
+            while (true) {
+                if (!token.empty() && token.back() == '"') {
+                    token.pop_back();
+                    closed = true;
+                }
+                if (!token.empty()) operand.terms.push_back(token);
+                if (closed || !(iss >> token)) break;
+            }
+            if (!operand.terms.empty()) parsed.operands.push_back(std::move(operand));
+        } else {
+            parsed.operands.push_back({{token}});
+        }
+    }
+    return parsed;
 }
 
 SearchResult BoolSearch::search_query(const std::vector<std::string>& terms,
                                      const std::vector<BoolOperator>& operators) {
+    std::vector<OperandView> operands;
+    operands.reserve(terms.size());
+    for (const auto& term : terms) {
+        operands.push_back({&term, 1});
+    }
+    return evaluate(operands, operators, nullptr);
+}
+
+SearchResult BoolSearch::search_parsed(const ParsedQuery& query, QueryExplain* explain,
+                                      size_t limit) {
+    std::vector<OperandView> operands;
+    operands.reserve(query.operands.size());
+    for (const auto& operand : query.operands) {
+        if (!operand.terms.empty()) operands.push_back({operand.terms.data(), operand.terms.size()});
+    }
+    return evaluate(operands, query.operators, explain, limit);
+}
+
+SearchResult BoolSearch::evaluate(const std::vector<OperandView>& operands,
+                                  const std::vector<BoolOperator>& operators, QueryExplain* explain,
+                                  size_t limit) {
     auto start = std::chrono::high_resolution_clock::now();
     
     SearchResult result;
     
-    if (terms.empty()) {
+    if (operands.empty()) {
         result.total_found = 0;
         result.search_time_ms = 0;
         return result;
     }
     
-    auto doc_ids = index.get_postings(terms[0]);
-    std::set<int> result_set(doc_ids.begin(), doc_ids.end());
-    
-    for (size_t i = 0; i < operators.size() && i + 1 < terms.size(); ++i) {
-        auto next_docs = index.get_postings(terms[i + 1]);
-        std::set<int> next_set(next_docs.begin(), next_docs.end());
+    RoaringBitmap result_set;
+    RoaringBitmap phrase;
+    size_t steps = std::min(operands.size(), operators.size() + 1);
+    for (size_t i = 0; i < steps; ++i) {
+        auto step_start = std::chrono::high_resolution_clock::now();
+        const OperandView& operand = operands[i];
+        bool is_phrase = operand.count > 1;
+        size_t scanned = 0;
         
-        switch (operators[i]) {
-            case BoolOperator::AND:
-                result_set = intersect(result_set, next_set);
-                break;
-            case BoolOperator::OR:
-                result_set = union_sets(result_set, next_set);
-                break;
-            case BoolOperator::NOT:
-                result_set = difference(result_set, next_set);
-                break;
+        const RoaringBitmap* set;
+        std::string plan;
+        if (is_phrase) {
+            phrase = phrase_set(operand.terms, operand.count, scanned, explain ? &plan : nullptr);
+            set = &phrase;
+        } else {
+            set = &doc_set(operand.terms[0]);
+            scanned = set->cardinality();
+        }
+        
+        const char* operation = is_phrase ? "phrase" : "term";
+        if (i == 0) {
+            result_set = *set;
+        } else {
+            switch (operators[i - 1]) {
+                case BoolOperator::AND:
+                    result_set = RoaringBitmap::intersect(result_set, *set);
+                    operation = "AND";
+                    break;
+                case BoolOperator::OR:
+                    result_set = RoaringBitmap::unite(result_set, *set);
+                    operation = "OR";
+                    break;
+                case BoolOperator::NOT:
+                    result_set = RoaringBitmap::subtract(result_set, *set);
+                    operation = "NOT";
+                    break;
+            }
+        }
+        
+        if (explain) {
+            QueryExplain::Step step;
+            step.operation = operation;
+            step.operand = operand_text(operand.terms, operand.count);
+            step.operand_docs = set->cardinality();
+            step.result_docs = result_set.cardinality();
+            step.postings_scanned = scanned;
+            step.plan = std::move(plan);
+            step.time_us = std::chrono::duration<double, std::micro>(
+                std::chrono::high_resolution_clock::now() - step_start).count();
+            explain->steps.push_back(step);
+            explain->postings_scanned += scanned;
         }
     }
     
-    result.doc_ids = std::vector<int>(result_set.begin(), result_set.end());
-    result.total_found = result.doc_ids.size();
+    result.doc_ids = result_set.to_vector(limit);
+    result.total_found = result_set.cardinality();
     
     auto end = std::chrono::high_resolution_clock::now();
     result.search_time_ms = std::chrono::duration<double, std::milli>(end - start).count();
@@ -79,23 +313,17 @@ SearchResult BoolSearch::search_query(const std::vector<std::string>& terms,
     return result;
 }
 
-SearchResult BoolSearch::execute_query(const std::string& query) {
-    std::istringstream iss(query);
-    std::vector<std::string> terms;
-    std::vector<BoolOperator> operators;
+SearchResult BoolSearch::execute_query(const std::string& query, QueryExplain* explain) {
+    static trace::Histogram& latency = trace::histogram(
+        "search_query_duration_us", "Время выполнения запроса, мкс");
+    static trace::Counter& queries_total = trace::counter(
+        "search_queries_total", "Выполнено запросов");
+    static trace::Counter& results_total = trace::counter(
+        "search_results_total", "Найдено документов по всем запросам");
+    trace::Span span("query", &latency);
     
-    std::string token;
-    while (iss >> token) {
-        if (token == "AND") {
-            operators.push_back(BoolOperator::AND);
-        } else if (token == "OR") {
-            operators.push_back(BoolOperator::OR);
-        } else if (token == "NOT") {
-            operators.push_back(BoolOperator::NOT);
-        } else {
-            terms.push_back(token);
-        }
-    }
-    
-    return search_query(terms, operators);
+    SearchResult result = search_parsed(parse_query(query), explain);
+    queries_total.add();
+    results_total.add(result.total_found);
+    return result;
 }
@@ -2,9 +2,9 @@
 #define BOOL_SEARCH_H
 
 #include "index/inverted_index.h"
+#include <ostream>
 #include <string>
 #include <vector>
-#include <set>
 
 enum class BoolOperator {
     AND,
@@ -18,21 +18,94 @@ struct SearchResult {
     double search_time_ms;
 };
 
+// Операнд запроса: один терм или фраза — термы подряд в тексте
+struct QueryOperand {
+    std::vector<std::string> terms;
+
+    bool is_phrase() const { return terms.size() > 1; }
+    std::string to_string() const;
+};
+
+// Операнды вычисляются слева направо, без приоритетов:
+// a AND b OR c = (a AND b) OR c
+struct ParsedQuery {
+    std::vector<QueryOperand> operands;
+    std::vector<BoolOperator> operators;
+};
+
+// Как выполнялся запрос: по шагу на операнд
+struct QueryExplain {
+    struct Step {
+        std::string operation;     // "term", "phrase", "AND", "OR", "NOT"
+        std::string operand;
+        size_t operand_docs = 0;   // документов у операнда
+        size_t result_docs = 0;    // документов после шага
+        size_t postings_scanned = 0;
+        double time_us = 0;
+        std::string plan;          // для фразы: биграммы и термы со смещениями
+    };
+
+    std::vector<Step> steps;
+    size_t postings_scanned = 0;
+
+    void print(std::ostream& out) const;
+};
+
 class BoolSearch {
 private:
-    InvertedIndex& index;
+    const InvertedIndex& index;
     
-    std::set<int> intersect(const std::set<int>& s1, const std::set<int>& s2);
-    std::set<int> union_sets(const std::set<int>& s1, const std::set<int>& s2);
-    std::set<int> difference(const std::set<int>& s1, const std::set<int>& s2);
+    RoaringBitmap fallback;
+    bool use_bigrams = true;
+    
+    // Множество документов терма; если индекс не строил doc_sets,
+    // оно собирается из постингов во временный fallback
+    const RoaringBitmap& doc_set(const std::string& term);
+    const RoaringBitmap& doc_set(const std::string& key, const std::vector<Posting>& postings);
+    
+    // Часть фразы: терм или биграмма, начинающаяся со слова offset
+    struct PhraseUnit {
+        std::string key;
+        const std::vector<Posting>* postings;
+        int offset;
+    };
+    
+    // Заменяет пары частых термов фразы биграммами. false, если фраза
+    // заведомо не встречается: терма нет или нет пары частых термов.
+    bool plan_phrase(const std::string* terms, size_t count, std::vector<PhraseUnit>& units) const;
+    
+    // Документы, где термы фразы идут подряд: пересечение множеств
+    // от редкой части плана к частой, затем проверка позиций
+    RoaringBitmap phrase_set(const std::string* terms, size_t count, size_t& postings_scanned,
+                             std::string* plan = nullptr);
+    
+    // Операнд без копирования термов: count термов подряд с terms
+    struct OperandView {
+        const std::string* terms;
+        size_t count;
+    };
+    
+    SearchResult evaluate(const std::vector<OperandView>& operands,
+                          const std::vector<BoolOperator>& operators, QueryExplain* explain,
+                          size_t limit = 0);
     
 public:
-    BoolSearch(InvertedIndex& idx) : index(idx) {}
+    BoolSearch(const InvertedIndex& idx) : index(idx) {}
+    
+    // Использовать ли биграммы индекса во фразах; без них — только термы
+    void set_bigrams(bool enabled) { use_bigrams = enabled; }
+    
+    // Термы через пробел, операторы AND, OR, NOT, фраза — в кавычках:
+    // "с пробег" AND toyota
+    static ParsedQuery parse_query(const std::string& query);
     
     SearchResult search_term(const std::string& term);
     SearchResult search_query(const std::vector<std::string>& terms,
                              const std::vector<BoolOperator>& operators);
-    SearchResult execute_query(const std::string& query);
+    // limit > 0 — в doc_ids только первые limit документов, total_found полное
+    SearchResult search_parsed(const ParsedQuery& query, QueryExplain* explain = nullptr,
+                               size_t limit = 0);
+    SearchResult execute_query(const std::string& query, QueryExplain* explain = nullptr);
 };
 
 #endif
@@ -0,0 +1,137 @@
+#include "search/index_snapshot.h"
+#include "common/utils.h"
+#include <iostream>
+#include <sstream>
+
+IndexSnapshotManager::~IndexSnapshotManager() {
+    stop_watching();
+}
+
+std::shared_ptr<const InvertedIndex> IndexSnapshotManager::snapshot() const {
+    return std::atomic_load(&current);
+}
+
+bool IndexSnapshotManager::read_file_state(std::filesystem::file_time_type& mtime,
+                                           uintmax_t& size) const {
+    std::error_code ec;
+    mtime = std::filesystem::last_write_time(index_file, ec);
+    if (ec) return false;
+    size = std::filesystem::file_size(index_file, ec);
+    return !ec;
+}
+
+bool IndexSnapshotManager::reload() {
+    return load(std::cout, std::cerr, false);
+}
+
+bool IndexSnapshotManager::load(std::ostream& out, std::ostream& err, bool quiet) {
+    std::lock_guard<std::mutex> lock(reload_mutex);
+
+    std::filesystem::file_time_type mtime;
+    uintmax_t size = 0;
+    if (!read_file_state(mtime, size)) {
+        err << "Файл индекса недоступен: " << index_file << std::endl;
+        return false;
+    }
+
+    utils::Timer timer;
+
+    // Новый индекс собирается целиком в стороне, запросы в это время
+    // продолжают читать предыдущую версию
+    auto fresh = std::make_shared<InvertedIndex>();
+    fresh->set_quiet(quiet);
+    if (!fresh->load_from_file(index_file)) {
+        // Запоминаем состояние битого файла, чтобы наблюдатель не перечитывал
+        // его по кругу до следующей пересборки
+        loaded_mtime = mtime;
+        loaded_size = size;
+        err << "Индекс не перезагружен, используется версия " << version.load() << std::endl;
+        return false;
+    }
+
+    std::shared_ptr<const InvertedIndex> next = std::move(fresh);
+    std::atomic_store(&current, next);
+
+    loaded_mtime = mtime;
+    loaded_size = size;
+    uint64_t v = ++version;
+
+    out << "Индекс версии " << v << " загружен за " << timer.elapsed_ms() << " мс" << std::endl;
+    return true;
+}
+
+void IndexSnapshotManager::start_watching(int interval_ms) {
+    if (watcher.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(watcher_mutex);
+        stop_requested = false;
+    }
+    watcher = std::thread(&IndexSnapshotManager::watch_loop, this, interval_ms);
+}
+
+void IndexSnapshotManager::stop_watching() {
+    {
+        std::lock_guard<std::mutex> lock(watcher_mutex);
+        stop_requested = true;
+    }
+    watcher_cv.notify_all();
+
+    if (watcher.joinable()) {
+        watcher.join();
+    }
+}
+
+void IndexSnapshotManager::watch_loop(int interval_ms) {
+    std::filesystem::file_time_type pending_mtime{};
+    uintmax_t pending_size = 0;
+    bool pending = false;
+
+    std::unique_lock<std::mutex> lock(watcher_mutex);
+    while (!watcher_cv.wait_for(lock, std::chrono::milliseconds(interval_ms),
+                                [this] { return stop_requested; })) {
+        std::filesystem::file_time_type mtime;
+        uintmax_t size = 0;
+        if (!read_file_state(mtime, size)) {
+            pending = false;
+            continue;
+        }
+
+        bool changed;
+        {
+            std::lock_guard<std::mutex> reload_lock(reload_mutex);
+            changed = mtime != loaded_mtime || size != loaded_size;
+        }
+        if (!changed) {
+            pending = false;
+            continue;
+        }
+
+        // Перезагружаем только после того, как файл не менялся целый интервал:
+        // так не читаем индекс, который ещё дописывается не через rename
+        if (!pending || mtime != pending_mtime || size != pending_size) {
+            pending = true;
+            pending_mtime = mtime;
+            pending_size = size;
+            continue;
+        }
+
+        pending = false;
+        lock.unlock();
+        std::ostringstream report;
+        report << "Обнаружен новый индекс, перезагрузка..." << std::endl;
+        load(report, report, true);
+        {
+            std::lock_guard<std::mutex> messages_lock(messages_mutex);
+            messages.push_back(report.str());
+        }
+        lock.lock();
+    }
+}
+
+std::vector<std::string> IndexSnapshotManager::take_messages() {
+    std::lock_guard<std::mutex> lock(messages_mutex);
+    std::vector<std::string> taken;
+    taken.swap(messages);
+    return taken;
+}
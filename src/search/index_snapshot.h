@@ -0,0 +1,67 @@
+#ifndef INDEX_SNAPSHOT_H
+#define INDEX_SNAPSHOT_H
+
+#include "index/inverted_index.h"
+#include <string>
+#include <vector>
+#include <ostream>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+
+// Текущая версия индекса для поискового процесса.
+// Запрос берёт snapshot() один раз и работает с ним до конца, даже если
+// в это время подменили индекс. Старая версия освобождается, когда
+// её отпускает последний читатель.
+class IndexSnapshotManager {
+private:
+    std::string index_file;
+
+    std::shared_ptr<const InvertedIndex> current;
+    std::atomic<uint64_t> version{0};
+
+    std::mutex reload_mutex;
+
+    std::thread watcher;
+    std::mutex watcher_mutex;
+    std::condition_variable watcher_cv;
+    bool stop_requested = false;
+
+    std::filesystem::file_time_type loaded_mtime{};
+    uintmax_t loaded_size = 0;
+
+    // Сообщения наблюдателя: печатает их основной цикл, а не фоновый поток,
+    // чтобы не разрывать строку, которую пользователь набирает после "> "
+    std::mutex messages_mutex;
+    std::vector<std::string> messages;
+
+    bool read_file_state(std::filesystem::file_time_type& mtime, uintmax_t& size) const;
+    bool load(std::ostream& out, std::ostream& err, bool quiet);
+    void watch_loop(int interval_ms);
+
+public:
+    explicit IndexSnapshotManager(const std::string& filename) : index_file(filename) {}
+    ~IndexSnapshotManager();
+
+    IndexSnapshotManager(const IndexSnapshotManager&) = delete;
+    IndexSnapshotManager& operator=(const IndexSnapshotManager&) = delete;
+
+    std::shared_ptr<const InvertedIndex> snapshot() const;
+
+    // Загружает индекс с диска в новый объект и атомарно подменяет текущий.
+    // Если загрузка не удалась, продолжаем работать со старой версией.
+    bool reload();
+
+    void start_watching(int interval_ms = 1000);
+    void stop_watching();
+
+    // Забирает накопленные наблюдателем сообщения о перезагрузке
+    std::vector<std::string> take_messages();
+
+    uint64_t get_version() const { return version.load(); }
+};
+
+#endif
@@ -1,5 +1,12 @@
 #include "search/bool_search.h"
+#include "search/index_snapshot.h"
+#include "search/sharded_search.h"
+#include "common/thread_pool.h"
+#include "common/trace.h"
+#include "common/utils.h"
+#include <functional>
 #include <iostream>
+#include <memory>
 #include <unistd.h>
 
 void print_usage(const char* program_name) {
@@ -7,9 +14,42 @@ void print_usage(const char* program_name) {
     std::cout << "  Интерактивный режим: " << program_name << " <index_file>" << std::endl;
     std::cout << "  Одиночный запрос:    echo 'запрос' | " << program_name << " <index_file>" << std::endl;
     std::cout << "  С аргументом:        " << program_name << " <index_file> <запрос>" << std::endl;
+    std::cout << "  --trace FILE    трасса Chrome (chrome://tracing), --metrics FILE  метрики Prometheus" << std::endl;
+    std::cout << "  --threads N     потоков для шардов индекса (build_index --shards), по умолчанию ядра" << std::endl;
+}
+
+// Индекс — InvertedIndex или ShardedIndex: нужны только метаданные документов
+template <typename Index>
+void print_results(const Index& index, const SearchResult& result) {
+    std::cout << "Найдено: " << result.total_found << std::endl;
+    std::cout << "Время: " << result.search_time_ms << " мс" << std::endl;
+    
+    int limit = std::min(10, result.total_found);
+    if (limit > 0) {
+        std::cout << "\nТоп-" << limit << ":" << std::endl;
+        for (int i = 0; i < limit; ++i) {
+            auto* meta = index.get_document_meta(result.doc_ids[i]);
+            if (meta) {
+                std::cout << (i+1) << ". [" << meta->source << "] "
+                         << meta->title << std::endl;
+            }
+        }
+    }
+}
+
+void print_shard_timings(const std::vector<ShardTiming>& timings) {
+    std::cout << "Шарды:";
+    for (size_t i = 0; i < timings.size(); ++i) {
+        std::cout << " #" << i << " " << timings[i].time_ms << " мс (" << timings[i].found << ")";
+    }
+    std::cout << std::endl;
 }
 
 int main(int argc, char* argv[]) {
+    int threads = utils::extract_threads_option(argc, argv, utils::default_thread_count());
+    utils::ThreadPool::configure_shared(threads);
+    trace::Session tracing(argc, argv);
+    
     if (argc < 2) {
         print_usage(argv[0]);
         return 1;
@@ -17,12 +57,43 @@ int main(int argc, char* argv[]) {
     
     std::string index_file = argv[1];
     
-    InvertedIndex index;
+    // Обычный индекс читается через снапшоты с горячей подменой; шарды
+    // загружаются целиком, :reload перечитывает их все
+    IndexSnapshotManager snapshots(index_file);
+    std::shared_ptr<const ShardedIndex> sharded;
+    auto load_shards = [&]() {
+        auto fresh = std::make_shared<ShardedIndex>();
+        if (!fresh->load(index_file)) return false;
+        sharded = std::move(fresh);
+        return true;
+    };
+    
+    bool is_sharded = index_shards::is_manifest(index_file);
     std::cout << "Загрузка индекса..." << std::endl;
-    index.load_from_file(index_file);
-    index.print_statistics();
+    if (is_sharded) {
+        if (!load_shards()) return 1;
+        sharded->print_statistics();
+    } else {
+        if (!snapshots.reload()) return 1;
+        snapshots.snapshot()->print_statistics();
+    }
     
-    BoolSearch search(index);
+    // Запрос целиком выполняется на одной версии индекса, даже если
+    // наблюдатель подменит её посреди обработки
+    std::function<void(const std::string&)> answer = [&](const std::string& query) {
+        auto index = snapshots.snapshot();
+        BoolSearch search(*index);
+        print_results(*index, search.execute_query(query));
+    };
+    if (is_sharded) {
+        answer = [&](const std::string& query) {
+            auto index = sharded;
+            ShardedSearch search(*index);
+            // Печатаются только первые 10, остальное шардам склеивать незачем
+            print_results(*index, search.execute_query(query, 10));
+            print_shard_timings(search.last_timings());
+        };
+    }
     
     if (argc >= 3) {
         std::string query;
@@ -31,23 +102,8 @@ int main(int argc, char* argv[]) {
             query += argv[i];
         }
         
-        auto result = search.execute_query(query);
-        
         std::cout << "\nЗапрос: " << query << std::endl;
-        std::cout << "Найдено: " << result.total_found << std::endl;
-        std::cout << "Время: " << result.search_time_ms << " мс" << std::endl;
-        
-        int limit = std::min(10, result.total_found);
-        if (limit > 0) {
-            std::cout << "\nТоп-" << limit << ":" << std::endl;
-            for (int i = 0; i < limit; ++i) {
-                auto* meta = index.get_document_meta(result.doc_ids[i]);
-                if (meta) {
-                    std::cout << (i+1) << ". [" << meta->source << "] "
-                             << meta->title << std::endl;
-                }
-            }
-        }
+        answer(query);
         
         return 0;
     }
@@ -57,14 +113,23 @@ int main(int argc, char* argv[]) {
     if (!is_pipe) {
         std::cout << "\nБУЛЕВ ПОИСК (интерактивный режим)" << std::endl;
         std::cout << "Введите запрос (или 'exit' для выхода):" << std::endl;
-        std::cout << "Примеры: toyota, bmw AND x5, audi OR mercedes" << std::endl;
+        std::cout << "Примеры: toyota, bmw AND x5, audi OR mercedes, \"с пробег\" NOT lada" << std::endl;
+        std::cout << "Команда ':reload' перечитывает индекс, новый файл подхватывается автоматически" << std::endl;
         std::cout << "==============================\n" << std::endl;
+        
+        if (!is_sharded) snapshots.start_watching();
     }
     
     std::string query;
     int queries_processed = 0;
     
     while (std::getline(std::cin, query)) {
+        // Сообщения наблюдателя печатаются здесь, между запросами, а не
+        // посреди строки, которую пользователь набирает
+        for (const auto& message : snapshots.take_messages()) {
+            std::cout << message;
+        }
+        
         if (query.empty()) {
             if (is_pipe) break;
             continue;
@@ -74,26 +139,24 @@ int main(int argc, char* argv[]) {
             break;
         }
         
-        auto result = search.execute_query(query);
+        if (query == ":reload") {
+            if (is_sharded) {
+                load_shards();
+            } else {
+                snapshots.reload();
+            }
+            if (!is_pipe) {
+                std::cout << "> ";
+                std::cout.flush();
+            }
+            continue;
+        }
         
         if (!is_pipe) {
             std::cout << "\nЗапрос: " << query << std::endl;
         }
         
-        std::cout << "Найдено: " << result.total_found << std::endl;
-        std::cout << "Время: " << result.search_time_ms << " мс" << std::endl;
-        
-        int limit = std::min(10, result.total_found);
-        if (limit > 0) {
-            std::cout << "\nТоп-" << limit << ":" << std::endl;
-            for (int i = 0; i < limit; ++i) {
-                auto* meta = index.get_document_meta(result.doc_ids[i]);
-                if (meta) {
-                    std::cout << (i+1) << ". [" << meta->source << "] "
-                             << meta->title << std::endl;
-                }
-            }
-        }
+        answer(query);
         std::cout << std::endl;
         
         queries_processed++;
@@ -108,6 +171,8 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    snapshots.stop_watching();
+    
     if (!is_pipe) {
         std::cout << "\nДо свидания! Обработано запросов: " << queries_processed << std::endl;
     }
@@ -0,0 +1,134 @@
+#include "search/sharded_search.h"
+#include "common/thread_pool.h"
+#include "common/trace.h"
+#include "common/utils.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+bool ShardedIndex::load(const std::string& manifest) {
+    ranges.clear();
+    shards.clear();
+    if (!index_shards::read_manifest(manifest, ranges)) return false;
+
+    utils::Timer timer;
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        auto shard = std::make_unique<InvertedIndex>();
+        if (!shard->load_from_file(index_shards::shard_path(manifest, ranges[i]))) {
+            std::cerr << "Шард " << i << " не загружен: " << ranges[i].file << std::endl;
+            ranges.clear();
+            shards.clear();
+            return false;
+        }
+        shards.push_back(std::move(shard));
+    }
+    std::cout << "Загружено шардов: " << shards.size() << " за " << timer.elapsed_ms()
+              << " мс" << std::endl;
+    return true;
+}
+
+size_t ShardedIndex::get_documents_count() const {
+    size_t count = 0;
+    for (const auto& shard : shards) count += shard->get_documents_count();
+    return count;
+}
+
+const DocumentMeta* ShardedIndex::get_document_meta(int doc_id) const {
+    auto it = std::upper_bound(ranges.begin(), ranges.end(), doc_id,
+                               [](int id, const index_shards::Shard& s) { return id < s.end_doc; });
+    if (it == ranges.end()) return nullptr;
+    return shards[it - ranges.begin()]->get_document_meta(doc_id);
+}
+
+void ShardedIndex::print_statistics() const {
+    std::cout << "\nШАРДЫ:" << std::endl;
+    std::cout << "==============================" << std::endl;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        std::cout << i << ". " << ranges[i].file << ": документы [" << ranges[i].first_doc << ", "
+                  << ranges[i].end_doc << "), термов " << shards[i]->get_index_size()
+                  << ", биграмм " << shards[i]->get_bigrams_count() << std::endl;
+    }
+    std::cout << "Всего документов: " << get_documents_count() << std::endl;
+    std::cout << "==============================\n" << std::endl;
+}
+
+SearchResult ShardedSearch::search_parsed(const ParsedQuery& query, size_t limit,
+                                          QueryExplain* explain) {
+    auto start = std::chrono::high_resolution_clock::now();
+    const size_t n = index.size();
+
+    std::vector<SearchResult> parts(n);
+    std::vector<QueryExplain> explains(explain ? n : 0);
+    timings.assign(n, ShardTiming());
+
+    auto run_shard = [&](size_t i) {
+        trace::Span span("shard_query");
+        BoolSearch search(index.shard(i));
+        search.set_bigrams(use_bigrams);
+        // Каждому шарду хватит первых limit: склейка берёт не больше
+        parts[i] = search.search_parsed(query, explain ? &explains[i] : nullptr, limit);
+        timings[i].found = parts[i].total_found;
+        timings[i].time_ms = parts[i].search_time_ms;
+    };
+    {
+        // Последний шард выполняет вызывающий поток, пока остальные в пуле
+        utils::TaskGroup group(utils::ThreadPool::shared());
+        for (size_t i = 0; i + 1 < n; ++i) {
+            group.run([&run_shard, i] { run_shard(i); });
+        }
+        if (n > 0) run_shard(n - 1);
+        group.wait();
+    }
+
+    SearchResult result;
+    result.total_found = 0;
+    for (const auto& part : parts) result.total_found += part.total_found;
+
+    size_t keep = limit > 0 ? std::min<size_t>(limit, result.total_found) : result.total_found;
+    result.doc_ids.reserve(keep);
+    for (const auto& part : parts) {
+        if (result.doc_ids.size() == keep) break;
+        size_t take = std::min(keep - result.doc_ids.size(), part.doc_ids.size());
+        result.doc_ids.insert(result.doc_ids.end(), part.doc_ids.begin(), part.doc_ids.begin() + take);
+    }
+
+    if (explain) {
+        // У всех шардов одни и те же шаги; план фразы может отличаться,
+        // показывается план первого шарда
+        for (const auto& shard_explain : explains) {
+            for (size_t s = 0; s < shard_explain.steps.size(); ++s) {
+                const QueryExplain::Step& step = shard_explain.steps[s];
+                if (s == explain->steps.size()) {
+                    explain->steps.push_back(step);
+                    continue;
+                }
+                QueryExplain::Step& total = explain->steps[s];
+                total.operand_docs += step.operand_docs;
+                total.result_docs += step.result_docs;
+                total.postings_scanned += step.postings_scanned;
+                total.time_us = std::max(total.time_us, step.time_us);
+            }
+            explain->postings_scanned += shard_explain.postings_scanned;
+        }
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    result.search_time_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    return result;
+}
+
+SearchResult ShardedSearch::execute_query(const std::string& query, size_t limit,
+                                          QueryExplain* explain) {
+    static trace::Histogram& latency = trace::histogram(
+        "search_query_duration_us", "Время выполнения запроса, мкс");
+    static trace::Counter& queries_total = trace::counter(
+        "search_queries_total", "Выполнено запросов");
+    static trace::Counter& results_total = trace::counter(
+        "search_results_total", "Найдено документов по всем запросам");
+    trace::Span span("query", &latency);
+
+    SearchResult result = search_parsed(BoolSearch::parse_query(query), limit, explain);
+    queries_total.add();
+    results_total.add(result.total_found);
+    return result;
+}
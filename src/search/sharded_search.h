@@ -0,0 +1,64 @@
+#ifndef SHARDED_SEARCH_H
+#define SHARDED_SEARCH_H
+
+#include "search/bool_search.h"
+#include "index/index_shards.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Индекс, разбитый build_index --shards на диапазоны документов
+class ShardedIndex {
+private:
+    std::vector<index_shards::Shard> ranges;
+    std::vector<std::unique_ptr<InvertedIndex>> shards;
+
+public:
+    // Читает оглавление и загружает все шарды
+    bool load(const std::string& manifest);
+
+    size_t size() const { return shards.size(); }
+    const InvertedIndex& shard(size_t i) const { return *shards[i]; }
+    const index_shards::Shard& range(size_t i) const { return ranges[i]; }
+
+    size_t get_documents_count() const;
+
+    // Метаданные из шарда, которому принадлежит документ
+    const DocumentMeta* get_document_meta(int doc_id) const;
+
+    void print_statistics() const;
+};
+
+// Время и число найденных документов одного шарда в последнем запросе
+struct ShardTiming {
+    size_t found = 0;
+    double time_ms = 0;
+};
+
+// Запрос выполняется на всех шардах параллельно задачами общего пула,
+// каждый шард — своим BoolSearch. Диапазоны шардов идут по возрастанию,
+// поэтому результат булева запроса — склейка результатов по порядку
+// шардов. Задержка запроса — самый медленный шард плюс склейка.
+class ShardedSearch {
+private:
+    const ShardedIndex& index;
+    bool use_bigrams = true;
+    std::vector<ShardTiming> timings;
+
+public:
+    explicit ShardedSearch(const ShardedIndex& idx) : index(idx) {}
+
+    void set_bigrams(bool enabled) { use_bigrams = enabled; }
+
+    // limit > 0 — собрать только первые limit документов; total_found
+    // всё равно полное. В explain шаги шардов сложены: документы и
+    // постинги — сумма по шардам, время — самый медленный шард.
+    SearchResult search_parsed(const ParsedQuery& query, size_t limit = 0,
+                               QueryExplain* explain = nullptr);
+    SearchResult execute_query(const std::string& query, size_t limit = 0,
+                               QueryExplain* explain = nullptr);
+
+    const std::vector<ShardTiming>& last_timings() const { return timings; }
+};
+
+#endif
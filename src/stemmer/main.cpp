@@ -1,10 +1,18 @@
 #include "stemmer/stemmer.h"
+#include "common/utils.h"
+#include "common/thread_pool.h"
+#include "common/trace.h"
 #include <iostream>
 
 int main(int argc, char* argv[]) {
+    int threads = utils::extract_threads_option(argc, argv, utils::default_thread_count());
+    bool pool_stats = utils::extract_flag(argc, argv, "--pool-stats");
+    utils::ThreadPool::configure_shared(threads);
+    trace::Session tracing(argc, argv);
+    
     if (argc < 3) {
         std::cout << "Использование: " << argv[0] 
-                 << " <input_tokens> <output_stems>" << std::endl;
+                 << " <input_tokens> <output_stems> [--threads N] [--pool-stats] [--trace FILE] [--metrics FILE]" << std::endl;
         std::cout << "Пример: ./stemmer data/processed/tokens.txt data/processed/stems.txt" 
                  << std::endl;
         return 1;
@@ -16,11 +24,14 @@ int main(int argc, char* argv[]) {
     
     Stemmer stemmer;
     
-    stemmer.stem_corpus(input_file, output_file);
+    if (!stemmer.stem_corpus(input_file, output_file)) {
+        return 1;
+    }
     
     stemmer.save_vocabulary(vocab_file);
     
     stemmer.print_statistics();
+    if (pool_stats) utils::ThreadPool::shared().print_statistics();
     
     return 0;
 }
@@ -0,0 +1,103 @@
+#include "stemmer/stem_cache.h"
+#include <cstring>
+#include <functional>
+
+StemCache::StemCache(size_t max_entries)
+    : capacity(max_entries > 0 ? max_entries : 1),
+      entries(capacity),
+      arena(new char[capacity * SLOT_BYTES]) {
+    slots.reserve(capacity);
+}
+
+bool StemCache::lookup(std::string_view token, std::string_view& stem) {
+    auto it = slots.find(token);
+    if (it == slots.end()) {
+        stats.misses++;
+        return false;
+    }
+
+    Entry& entry = entries[it->second];
+    entry.referenced = true;
+    stem = std::string_view(slot_data(it->second) + entry.key_length, entry.stem_length);
+    stats.hits++;
+    return true;
+}
+
+size_t StemCache::pick_victim() {
+    // CLOCK: стрелка снимает бит обращения, пока не найдёт слот без него
+    while (true) {
+        Entry& entry = entries[hand];
+        size_t slot = hand;
+        hand = (hand + 1) % capacity;
+
+        if (!entry.occupied) return slot;
+        if (!entry.referenced) return slot;
+        entry.referenced = false;
+    }
+}
+
+void StemCache::insert(std::string_view token, std::string_view stem) {
+    if (token.empty() || token.size() + stem.size() > SLOT_BYTES) {
+        stats.bypassed++;
+        return;
+    }
+    if (slots.count(token)) return;
+
+    size_t slot = pick_victim();
+    Entry& entry = entries[slot];
+    char* data = slot_data(slot);
+
+    if (entry.occupied) {
+        slots.erase(std::string_view(data, entry.key_length));
+        stats.evictions++;
+    } else {
+        occupied++;
+    }
+
+    std::memcpy(data, token.data(), token.size());
+    std::memcpy(data + token.size(), stem.data(), stem.size());
+    entry.key_length = static_cast<uint8_t>(token.size());
+    entry.stem_length = static_cast<uint8_t>(stem.size());
+    entry.occupied = true;
+    entry.referenced = false;
+
+    slots.emplace(std::string_view(data, token.size()), static_cast<uint32_t>(slot));
+}
+
+ConcurrentStemCache::ConcurrentStemCache(size_t max_entries, size_t shard_count) {
+    if (shard_count == 0) shard_count = 1;
+    size_t per_shard = (max_entries + shard_count - 1) / shard_count;
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards.push_back(std::make_unique<Shard>(per_shard));
+    }
+}
+
+ConcurrentStemCache::Shard& ConcurrentStemCache::shard_for(std::string_view token) {
+    size_t h = std::hash<std::string_view>()(token);
+    return *shards[h % shards.size()];
+}
+
+bool ConcurrentStemCache::lookup(std::string_view token, std::string& stem) {
+    Shard& shard = shard_for(token);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    std::string_view cached;
+    if (!shard.cache.lookup(token, cached)) return false;
+    stem.assign(cached.data(), cached.size());
+    return true;
+}
+
+void ConcurrentStemCache::insert(std::string_view token, std::string_view stem) {
+    Shard& shard = shard_for(token);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.cache.insert(token, stem);
+}
+
+StemCache::Statistics ConcurrentStemCache::get_statistics() const {
+    StemCache::Statistics total;
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total.merge(shard->cache.get_statistics());
+    }
+    return total;
+}
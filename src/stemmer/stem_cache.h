@@ -0,0 +1,99 @@
+#ifndef STEM_CACHE_H
+#define STEM_CACHE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <memory>
+#include <cstdint>
+
+// Ограниченный кэш токен -> стем с вытеснением CLOCK.
+// По закону Ципфа несколько тысяч частых токенов дают большую часть
+// вхождений, поэтому повторный прогон алгоритма Портера почти всегда лишний.
+// Токен и стем хранятся в слоте фиксированного размера внутри одной арены;
+// пары, которые в слот не помещаются, не кэшируются.
+class StemCache {
+public:
+    static const size_t SLOT_BYTES = 64;
+
+    struct Statistics {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t bypassed = 0;
+
+        double hit_rate() const {
+            uint64_t lookups = hits + misses;
+            return lookups > 0 ? static_cast<double>(hits) / lookups : 0;
+        }
+
+        void merge(const Statistics& other) {
+            hits += other.hits;
+            misses += other.misses;
+            evictions += other.evictions;
+            bypassed += other.bypassed;
+        }
+    };
+
+private:
+    struct Entry {
+        uint8_t key_length = 0;
+        uint8_t stem_length = 0;
+        bool occupied = false;
+        bool referenced = false;
+    };
+
+    size_t capacity;
+    std::vector<Entry> entries;
+    std::unique_ptr<char[]> arena;
+    std::unordered_map<std::string_view, uint32_t> slots;
+    size_t hand = 0;
+    size_t occupied = 0;
+
+    Statistics stats;
+
+    char* slot_data(size_t slot) const { return arena.get() + slot * SLOT_BYTES; }
+    size_t pick_victim();
+
+public:
+    explicit StemCache(size_t max_entries = 65536);
+
+    // При попадании stem указывает в арену и действителен до следующего insert
+    bool lookup(std::string_view token, std::string_view& stem);
+
+    void insert(std::string_view token, std::string_view stem);
+
+    size_t size() const { return occupied; }
+    size_t get_capacity() const { return capacity; }
+    const Statistics& get_statistics() const { return stats; }
+};
+
+// Потокобезопасный вариант для многопоточного стемминга: ключи
+// распределяются по шардам по хэшу, у каждого шарда свой StemCache и мьютекс
+class ConcurrentStemCache {
+private:
+    struct Shard {
+        std::mutex mutex;
+        StemCache cache;
+
+        explicit Shard(size_t entries) : cache(entries) {}
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    Shard& shard_for(std::string_view token);
+
+public:
+    explicit ConcurrentStemCache(size_t max_entries = 262144, size_t shard_count = 16);
+
+    // Стем копируется в stem, потому что слот может вытеснить другой поток
+    bool lookup(std::string_view token, std::string& stem);
+
+    void insert(std::string_view token, std::string_view stem);
+
+    StemCache::Statistics get_statistics() const;
+};
+
+#endif
@@ -1,108 +1,148 @@
 #include "stemmer/stemmer.h"
 #include "common/utils.h"
+#include "common/corpus_format.h"
+#include "common/ordered_pipeline.h"
+#include "common/trace.h"
+#include "common/utf8.h"
+#include "stemmer/suffix_trie.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <cctype>
+
+namespace {
+
+// Группы окончаний алгоритма Портера. Бор по каждой группе строится
+// на этапе компиляции, окончание снимается одним обратным проходом.
+constexpr const char* PERFECTIVEGROUND[] = {"в", "вши", "вшись"};
+constexpr const char* REFLEXIVE[] = {"ся", "сь"};
+constexpr const char* ADJECTIVE[] = {
+    "ее", "ие", "ые", "ое", "ими", "ыми", "ей", "ий", "ый", "ой",
+    "ем", "им", "ым", "ом", "его", "ого", "ему", "ому", "их", "ых",
+    "ую", "юю", "ая", "яя", "ою", "ею"
+};
+constexpr const char* PARTICIPLE[] = {"ивш", "ывш", "ующ"};
+constexpr const char* VERB[] = {
+    "ла", "на", "ете", "йте", "ли", "й", "л", "ем", "н", "ло", "но",
+    "ет", "ют", "ны", "ть", "ешь", "нно"
+};
+constexpr const char* NOUN[] = {
+    "а", "ев", "ов", "ие", "ье", "е", "иями", "ями", "ами", "еи", "ии",
+    "и", "ией", "ей", "ой", "ий", "й", "иям", "ям", "ием", "ем", "ам",
+    "ом", "о", "у", "ах", "иях", "ях", "ы", "ь", "ию", "ью", "ю", "ия",
+    "ья", "я"
+};
+constexpr const char* SUPERLATIVE[] = {"ейш", "ейше"};
+constexpr const char* DERIVATIONAL[] = {"ост", "ость"};
+
+constexpr auto PERFECTIVEGROUND_TRIE =
+    suffix_trie::build<suffix_trie::node_bound(PERFECTIVEGROUND)>(PERFECTIVEGROUND);
+constexpr auto REFLEXIVE_TRIE = suffix_trie::build<suffix_trie::node_bound(REFLEXIVE)>(REFLEXIVE);
+constexpr auto ADJECTIVE_TRIE = suffix_trie::build<suffix_trie::node_bound(ADJECTIVE)>(ADJECTIVE);
+constexpr auto PARTICIPLE_TRIE = suffix_trie::build<suffix_trie::node_bound(PARTICIPLE)>(PARTICIPLE);
+constexpr auto VERB_TRIE = suffix_trie::build<suffix_trie::node_bound(VERB)>(VERB);
+constexpr auto NOUN_TRIE = suffix_trie::build<suffix_trie::node_bound(NOUN)>(NOUN);
+constexpr auto SUPERLATIVE_TRIE = suffix_trie::build<suffix_trie::node_bound(SUPERLATIVE)>(SUPERLATIVE);
+constexpr auto DERIVATIONAL_TRIE = suffix_trie::build<suffix_trie::node_bound(DERIVATIONAL)>(DERIVATIONAL);
+
+constexpr char32_t RAW_BYTE = 0xDC00;
+
+constexpr bool is_vowel(char32_t c) {
+    return c == U'а' || c == U'е' || c == U'и' || c == U'о' || c == U'у' ||
+           c == U'ы' || c == U'э' || c == U'ю' || c == U'я';
+}
+
+// Снимает самое длинное окончание группы в пределах RV
+template <typename Trie>
+bool remove_ending(const Trie& trie, const std::u32string& word, size_t rv, size_t& end) {
+    size_t matched = trie.longest_match(word.data(), rv, end);
+    end -= matched;
+    return matched > 0;
+}
+
+bool ends_with(const std::u32string& word, size_t rv, size_t end, char32_t c) {
+    return end > rv && word[end - 1] == c;
+}
 
-PorterStemmerRu::PorterStemmerRu() {
-    vowels = {"а", "е", "и", "о", "у", "ы", "э", "ю", "я"};
-    
-    perfectiveground = {"в", "вши", "вшись"};
-    reflexive = {"ся", "сь"};
-    adjective = {"ее", "ие", "ые", "ое", "ими", "ыми", "ей", "ий", "ый", "ой",
-                 "ем", "им", "ым", "ом", "его", "ого", "ему", "ому", "их", "ых",
-                 "ую", "юю", "ая", "яя", "ою", "ею"};
-    participle = {"ивш", "ывш", "ующ"};
-    verb = {"ла", "на", "ете", "йте", "ли", "й", "л", "ем", "н", "ло", "но",
-            "ет", "ют", "ны", "ть", "ешь", "нно"};
-    noun = {"а", "ев", "ов", "ие", "ье", "е", "иями", "ями", "ами", "еи", "ии",
-            "и", "ией", "ей", "ой", "ий", "й", "иям", "ям", "ием", "ем", "ам",
-            "ом", "о", "у", "ах", "иях", "ях", "ы", "ь", "ию", "ью", "ю", "ия",
-            "ья", "я"};
-    superlative = {"ейш", "ейше"};
-    derivational = {"ост", "ость"};
-}
-
-bool PorterStemmerRu::ends_with(const std::string& str, const std::string& suffix) const {
-    if (suffix.length() > str.length()) return false;
-    return str.compare(str.length() - suffix.length(), suffix.length(), suffix) == 0;
-}
-
-bool PorterStemmerRu::remove_ending(std::string& word, const std::vector<std::string>& endings) {
-    std::vector<std::string> sorted_endings = endings;
-    std::sort(sorted_endings.begin(), sorted_endings.end(),
-              [](const std::string& a, const std::string& b) {
-                  return a.length() > b.length();
-              });
-    
-    for (const auto& ending : sorted_endings) {
-        if (ends_with(word, ending)) {
-            word = word.substr(0, word.length() - ending.length());
-            return true;
-        }
-    }
-    return false;
 }
 
-size_t PorterStemmerRu::find_rv(const std::string& word) const {
-    for (size_t i = 0; i < word.length(); ++i) {
-        std::string ch(1, word[i]);
-        if (vowels.find(ch) != vowels.end()) {
+size_t PorterStemmerRu::find_rv(size_t length) const {
+    for (size_t i = 0; i < length; ++i) {
+        if (is_vowel(chars[i])) {
             return i + 1;
         }
     }
-    return word.length();
+    return length;
 }
 
 std::string PorterStemmerRu::stem(const std::string& word) {
-    if (word.length() < 3) return word;
-    
-    std::string w = utils::to_lower(word);
-    size_t rv_pos = find_rv(w);
-    
-    if (rv_pos >= w.length()) return w;
-    
-    std::string rv = w.substr(rv_pos);
-    std::string stem_word = w.substr(0, rv_pos);
-    
-    if (remove_ending(rv, perfectiveground)) {
-        return stem_word + rv;
-    }
-    
-    remove_ending(rv, reflexive);
-    
-    bool removed = remove_ending(rv, adjective);
-    if (removed) {
-        remove_ending(rv, participle);
-    } else {
-        removed = remove_ending(rv, verb);
-        if (!removed) {
-            remove_ending(rv, noun);
-        }
+    return std::string(stem_view(word));
+}
+
+std::string_view PorterStemmerRu::stem_view(std::string_view word) {
+    chars.clear();
+    const char* p = word.data();
+    const char* stop = p + word.size();
+    while (p < stop) {
+        int len;
+        char32_t cp = utf8::decode(p, stop, len);
+        // Битый байт сохраняем как есть через суррогат U+DC80..U+DCFF
+        chars.push_back(cp == utf8::INVALID
+            ? RAW_BYTE | static_cast<unsigned char>(*p)
+            : utf8::to_lower(cp));
+        p += len;
     }
     
-    if (ends_with(rv, "и")) {
-        rv = rv.substr(0, rv.length() - 1);
-    }
+    size_t length = chars.size();
     
-    remove_ending(rv, derivational);
+    size_t rv = find_rv(length);
+    size_t end = length;
     
-    if (ends_with(rv, "ь")) {
-        rv = rv.substr(0, rv.length() - 1);
+    if (length >= 3 && rv < length) {
+        if (!remove_ending(PERFECTIVEGROUND_TRIE, chars, rv, end)) {
+            remove_ending(REFLEXIVE_TRIE, chars, rv, end);
+            
+            if (remove_ending(ADJECTIVE_TRIE, chars, rv, end)) {
+                remove_ending(PARTICIPLE_TRIE, chars, rv, end);
+            } else if (!remove_ending(VERB_TRIE, chars, rv, end)) {
+                remove_ending(NOUN_TRIE, chars, rv, end);
+            }
+            
+            if (ends_with(chars, rv, end, U'и')) {
+                end--;
+            }
+            
+            remove_ending(DERIVATIONAL_TRIE, chars, rv, end);
+            
+            bool superlative = remove_ending(SUPERLATIVE_TRIE, chars, rv, end);
+            if (ends_with(chars, rv, end, U'н') && ends_with(chars, rv, end - 1, U'н')) {
+                end--;
+            } else if (!superlative && ends_with(chars, rv, end, U'ь')) {
+                end--;
+            }
+        }
     }
     
-    if (ends_with(rv, "нн")) {
-        rv = rv.substr(0, rv.length() - 1);
+    result.clear();
+    for (size_t i = 0; i < end; ++i) {
+        if ((chars[i] & 0xFFFFFF00) == RAW_BYTE) {
+            result.push_back(static_cast<char>(chars[i] & 0xFF));
+        } else {
+            utf8::append(result, chars[i]);
+        }
     }
-    
-    return stem_word + rv;
+    return result;
 }
 
-std::string Stemmer::stem_english(const std::string& word) {
-    std::string w = utils::to_lower(word);
+std::string_view Stemmer::stem_english(std::string_view word) {
+    static const std::string_view suffixes[] = {"ing", "ed", "es", "s", "er", "ly"};
     
-    std::vector<std::string> suffixes = {"ing", "ed", "es", "s", "er", "ly"};
+    english_result.assign(word.data(), word.size());
+    for (auto& c : english_result) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
     
+    std::string_view w = english_result;
     for (const auto& suffix : suffixes) {
         if (w.length() > suffix.length() + 2 && 
             w.substr(w.length() - suffix.length()) == suffix) {
@@ -113,98 +153,207 @@ std::string Stemmer::stem_english(const std::string& word) {
     return w;
 }
 
+std::string_view Stemmer::compute_stem(std::string_view token) {
+    if (utf8::has_cyrillic(token)) {
+        return stemmer_ru.stem_view(token);
+    } else {
+        return stem_english(token);
+    }
+}
+
+Stemmer::Stemmer(size_t cache_entries)
+    : cache(cache_entries > 0 ? cache_entries : 1),
+      cache_enabled(cache_entries > 0),
+      cache_capacity(cache_entries) {
+}
+
+void Stemmer::set_cache_capacity(size_t entries) {
+    cache_capacity = entries;
+    cache_enabled = entries > 0;
+    cache = StemCache(cache_enabled ? entries : 1);
+}
+
+std::string_view Stemmer::stem_view(std::string_view token) {
+    if (!cache_enabled) {
+        return compute_stem(token);
+    }
+    
+    std::string_view stem;
+    if (cache.lookup(token, stem)) {
+        return stem;
+    }
+    
+    stem = compute_stem(token);
+    cache.insert(token, stem);
+    return stem;
+}
+
 std::string Stemmer::stem_token(const std::string& token) {
-    bool is_cyrillic = false;
-    for (char c : token) {
-        if (utils::is_cyrillic(c)) {
-            is_cyrillic = true;
-            break;
-        }
+    return std::string(stem_view(token));
+}
+
+void Stemmer::stem_document(const std::vector<std::string_view>& tokens,
+                            std::vector<std::string>& stems) {
+    stems.resize(tokens.size());
+    
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        token_frequencies.add(tokens[i]);
+        
+        std::string_view stem = stem_view(tokens[i]);
+        stem_frequencies.add(stem);
+        stems[i].assign(stem.data(), stem.size());
     }
     
-    if (is_cyrillic) {
-        return stemmer_ru.stem(token);
-    } else {
-        return stem_english(token);
+    stats.documents_processed++;
+    stats.tokens_stemmed += tokens.size();
+}
+
+void Stemmer::merge_from(const Stemmer& other) {
+    stats.documents_processed += other.stats.documents_processed;
+    stats.tokens_stemmed += other.stats.tokens_stemmed;
+    
+    token_frequencies.merge(other.token_frequencies);
+    stem_frequencies.merge(other.stem_frequencies);
+    
+    if (other.cache_enabled) {
+        merged_cache_stats.merge(other.cache.get_statistics());
+        merged_cache_entries += other.cache.size();
     }
 }
 
-void Stemmer::stem_corpus(const std::string& input_file, const std::string& output_file) {
-    std::cout << "Начинаем стемминг..." << std::endl;
+namespace {
+
+const size_t CHUNK_LINES = 1024;
+const size_t CHUNK_BYTES = 4 << 20;
+
+// Результат порции: строки stems.txt или записи двоичного корпуса
+struct StemmedChunk {
+    std::string text;
+    corpus::TermsBatch batch;
+    int documents = 0;
+};
+
+}
+
+bool Stemmer::stem_corpus(const std::string& input_file, const std::string& output_file) {
+    // Порции обрабатывает общий пул процесса, размер задаётся --threads
+    utils::ThreadPool& pool = utils::ThreadPool::shared();
+    int threads = static_cast<int>(pool.size());
+    std::cout << "Начинаем стемминг (потоков: " << threads << ")..." << std::endl;
     
     utils::Timer timer;
     
-    std::ifstream in(input_file);
-    std::ofstream out(output_file);
+    corpus::ChunkSource source;
+    if (!source.open(input_file)) {
+        return false;
+    }
     
-    if (!in.is_open() || !out.is_open()) {
-        std::cerr << "Ошибка открытия файлов" << std::endl;
-        return;
+    // Формат выхода выбирается по расширению: .bin — двоичный корпус
+    bool binary_output = corpus::is_binary_name(output_file);
+    std::ofstream out;
+    corpus::Writer writer(corpus::Kind::TERMS);
+    if (binary_output) {
+        if (!writer.open(output_file)) return false;
+    } else {
+        out.open(output_file);
+        if (!out.is_open()) {
+            std::cerr << "Ошибка создания файла: " << output_file << std::endl;
+            return false;
+        }
     }
     
-    std::set<std::string> unique_tokens;
-    std::set<std::string> unique_stems;
+    // У каждого потока свой Stemmer со своим кэшем и счётчиками; стем
+    // зависит только от токена, поэтому вывод совпадает с однопоточным.
+    // Кэш сразу нужной ёмкости, без промежуточного кэша по умолчанию.
+    // Последний элемент — для потока вне пула (current_worker() == size())
+    size_t workers_count = threads > 1 ? pool.size() + 1 : 0;
+    std::vector<Stemmer> workers;
+    workers.reserve(workers_count);
+    for (size_t t = 0; t < workers_count; ++t) {
+        workers.emplace_back(cache_enabled ? cache_capacity : 0);
+    }
     
-    std::string line;
-    while (std::getline(in, line)) {
-        auto parts = utils::split(line, '|');
-        if (parts.size() < 4) continue;
-        
-        std::string doc_id = parts[0];
-        std::string source = parts[1];
-        std::string title = parts[2];
-        std::string tokens_str = parts[3];
-        
-        auto tokens = utils::split(tokens_str, ' ');
-        std::vector<std::string> stems;
-        
-        for (const auto& token : tokens) {
-            unique_tokens.insert(token);
-            
-            std::string stem = stem_token(token);
-            stems.push_back(stem);
+    int documents_written = 0;
+    
+    static trace::Histogram& chunk_latency = trace::histogram(
+        "stemmer_chunk_duration_us", "Время стемминга одной порции, мкс");
+    static trace::Counter& documents_total = trace::counter(
+        "stemmer_documents_total", "Обработано документов");
+    static trace::Counter& terms_total = trace::counter(
+        "stemmer_terms_total", "Получено стемов");
+    
+    utils::run_ordered_pipeline<corpus::InputChunk, StemmedChunk>(
+        pool, pool.size() * 4,
+        [&](corpus::InputChunk& input) {
+            return source.next_chunk(input, CHUNK_LINES, CHUNK_BYTES);
+        },
+        [&](int worker, corpus::InputChunk& input, StemmedChunk& chunk) {
+            trace::Span span("stem_chunk", &chunk_latency);
+            Stemmer& s = threads > 1 ? workers[worker] : *this;
+            corpus::TermsView doc;
+            std::vector<std::string> stems;
+            uint64_t chunk_terms = 0;
+            for (size_t k = 0; k < input.count; ++k) {
+                if (!source.terms_at(input, k, doc)) continue;
+                
+                s.stem_document(doc.terms, stems);
+                chunk.documents++;
+                chunk_terms += stems.size();
+                
+                if (binary_output) {
+                    chunk.batch.add(doc.doc_id, doc.source, doc.title, stems);
+                } else {
+                    corpus::append_terms_line(chunk.text, doc.doc_id, doc.source, doc.title, stems);
+                }
+            }
+            documents_total.add(chunk.documents);
+            terms_total.add(chunk_terms);
+        },
+        [&](StemmedChunk& chunk) {
+            trace::Span span("write_stems");
+            if (binary_output) {
+                writer.add_batch(chunk.batch);
+            } else {
+                out << chunk.text;
+            }
             
-            unique_stems.insert(stem);
-            stem_frequencies[stem]++;
-        }
-        
-        stats.documents_processed++;
-        stats.tokens_stemmed += tokens.size();
-        
-        out << doc_id << "|" << source << "|" << title << "|";
-        for (size_t i = 0; i < stems.size(); ++i) {
-            out << stems[i];
-            if (i < stems.size() - 1) out << " ";
-        }
-        out << "\n";
-        
-        if (stats.documents_processed % 1000 == 0) {
-            std::cout << "\rОбработано документов: " << stats.documents_processed << std::flush;
-        }
+            int before = documents_written;
+            documents_written += chunk.documents;
+            if (documents_written / 1000 != before / 1000) {
+                std::cout << "\rОбработано документов: " << documents_written << std::flush;
+            }
+        });
+    
+    for (const auto& worker : workers) {
+        merge_from(worker);
     }
     
     std::cout << std::endl;
     
-    stats.unique_before = unique_tokens.size();
-    stats.unique_after = unique_stems.size();
+    stats.unique_before = token_frequencies.size();
+    stats.unique_after = stem_frequencies.size();
     
-    in.close();
-    out.close();
+    // Ошибка close означает неполный выход: не сообщаем об успехе
+    bool written = true;
+    if (binary_output) {
+        written = writer.close();
+    } else {
+        out.close();
+        if (!out) {
+            std::cerr << "Ошибка записи файла: " << output_file << std::endl;
+            written = false;
+        }
+    }
+    if (!written) return false;
     
     std::cout << "Стемминг завершён за " << timer.elapsed_ms() / 1000.0 << " сек" << std::endl;
+    return true;
 }
 
 void Stemmer::save_vocabulary(const std::string& vocab_file, int top_n) {
     std::cout << "Сохранение словаря стемов..." << std::endl;
     
-    std::vector<std::pair<std::string, int>> sorted_stems(
-        stem_frequencies.begin(), stem_frequencies.end()
-    );
-    
-    std::sort(sorted_stems.begin(), sorted_stems.end(),
-              [](const auto& a, const auto& b) {
-                  return a.second > b.second;
-              });
+    auto sorted_stems = stem_frequencies.top_n(top_n);
     
     std::ofstream out(vocab_file);
     if (!out.is_open()) {
@@ -215,9 +364,7 @@ void Stemmer::save_vocabulary(const std::string& vocab_file, int top_n) {
     out << "# Словарь стемов (топ-" << top_n << ")\n";
     out << "# Формат: стем частота\n";
     
-    int count = 0;
     for (const auto& [stem, freq] : sorted_stems) {
-        if (count++ >= top_n) break;
         out << stem << " " << freq << "\n";
     }
     
@@ -237,5 +384,17 @@ void Stemmer::print_statistics() const {
     std::cout << "Уникальных токенов до: " << stats.unique_before << std::endl;
     std::cout << "Уникальных стемов после: " << stats.unique_after << std::endl;
     std::cout << "Сокращение словаря: " << reduction << "%" << std::endl;
+    
+    if (cache_enabled) {
+        StemCache::Statistics cache_stats = cache.get_statistics();
+        cache_stats.merge(merged_cache_stats);
+        size_t entries = cache.size() + merged_cache_entries;
+        std::cout << "Кэш стемов: " << entries << " записей (ёмкость " << cache_capacity
+                  << " на поток)" << std::endl;
+        std::cout << "  Попаданий: " << cache_stats.hits << ", промахов: " << cache_stats.misses
+                  << " (hit rate " << cache_stats.hit_rate() * 100.0 << "%)" << std::endl;
+        std::cout << "  Вытеснений: " << cache_stats.evictions
+                  << ", не помещались в слот: " << cache_stats.bypassed << std::endl;
+    }
     std::cout << "==============================\n" << std::endl;
 }
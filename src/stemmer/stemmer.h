@@ -1,30 +1,24 @@
 #ifndef STEMMER_H
 #define STEMMER_H
 
+#include "common/frequency_counter.h"
+#include "stemmer/stem_cache.h"
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
-#include <set>
 
 class PorterStemmerRu {
 private:
-    std::set<std::string> vowels;
+    // Слово в нижнем регистре по символам; переиспользуется между вызовами
+    std::u32string chars;
+    std::string result;
     
-    std::vector<std::string> perfectiveground;
-    std::vector<std::string> reflexive;
-    std::vector<std::string> adjective;
-    std::vector<std::string> participle;
-    std::vector<std::string> verb;
-    std::vector<std::string> noun;
-    std::vector<std::string> superlative;
-    std::vector<std::string> derivational;
-    
-    bool ends_with(const std::string& str, const std::string& suffix) const;
-    bool remove_ending(std::string& word, const std::vector<std::string>& endings);
-    size_t find_rv(const std::string& word) const;
+    size_t find_rv(size_t length) const;
     
 public:
-    PorterStemmerRu();
+    // Результат действителен до следующего вызова
+    std::string_view stem_view(std::string_view word);
+    
     std::string stem(const std::string& word);
 };
 
@@ -39,14 +33,42 @@ private:
         size_t unique_after = 0;
     } stats;
     
-    std::map<std::string, int> stem_frequencies;
+    utils::FrequencyCounter token_frequencies;
+    utils::FrequencyCounter stem_frequencies;
+    
+    StemCache cache;
+    bool cache_enabled;
+    size_t cache_capacity;
+    
+    // Статистика кэшей рабочих потоков, добавленная при слиянии
+    StemCache::Statistics merged_cache_stats;
+    size_t merged_cache_entries = 0;
+    
+    std::string english_result;
     
-    std::string stem_english(const std::string& word);
+    std::string_view stem_english(std::string_view word);
+    std::string_view compute_stem(std::string_view token);
+    
+    // Стеммит токены документа в stems (строки переиспользуются)
+    // и учитывает их в статистике
+    void stem_document(const std::vector<std::string_view>& tokens, std::vector<std::string>& stems);
+    
+    void merge_from(const Stemmer& other);
     
 public:
+    // Ёмкость кэша стемов в записях; 0 — без кэша
+    explicit Stemmer(size_t cache_entries = 65536);
+    
+    // 0 отключает кэш стемов
+    void set_cache_capacity(size_t entries);
+    
+    // Результат действителен до следующего вызова
+    std::string_view stem_view(std::string_view token);
+    
     std::string stem_token(const std::string& token);
     
-    void stem_corpus(const std::string& input_file, const std::string& output_file);
+    // false, если вход не открылся или выход не записан целиком
+    bool stem_corpus(const std::string& input_file, const std::string& output_file);
     
     void save_vocabulary(const std::string& vocab_file, int top_n = 10000);
     
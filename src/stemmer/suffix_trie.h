@@ -0,0 +1,123 @@
+#ifndef SUFFIX_TRIE_H
+#define SUFFIX_TRIE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Бор по перевёрнутым окончаниям, собираемый на этапе компиляции.
+// Окончание ищется одним проходом от конца слова к началу; на каждом шаге
+// запоминается самое длинное совпавшее окончание.
+namespace suffix_trie {
+
+constexpr char32_t decode_at(const char* s, size_t& i) {
+    unsigned char c0 = static_cast<unsigned char>(s[i]);
+    if (c0 < 0x80) {
+        i += 1;
+        return c0;
+    }
+    if ((c0 & 0xE0) == 0xC0) {
+        char32_t cp = ((c0 & 0x1F) << 6) | (static_cast<unsigned char>(s[i + 1]) & 0x3F);
+        i += 2;
+        return cp;
+    }
+    char32_t cp = ((c0 & 0x0F) << 12) |
+                  ((static_cast<unsigned char>(s[i + 1]) & 0x3F) << 6) |
+                  (static_cast<unsigned char>(s[i + 2]) & 0x3F);
+    i += 3;
+    return cp;
+}
+
+constexpr size_t code_points(const char* s) {
+    size_t count = 0;
+    size_t i = 0;
+    while (s[i] != '\0') {
+        decode_at(s, i);
+        count++;
+    }
+    return count;
+}
+
+// Верхняя граница числа узлов: корень плюс все символы всех окончаний
+template <size_t N>
+constexpr size_t node_bound(const char* const (&suffixes)[N]) {
+    size_t total = 1;
+    for (size_t k = 0; k < N; ++k) {
+        total += code_points(suffixes[k]);
+    }
+    return total;
+}
+
+constexpr size_t MAX_SUFFIX_LENGTH = 16;
+
+template <size_t MaxNodes>
+struct Trie {
+    struct Node {
+        char32_t cp = 0;
+        int16_t first_child = -1;
+        int16_t next_sibling = -1;
+        bool terminal = false;
+    };
+
+    std::array<Node, MaxNodes> nodes{};
+    size_t count = 1;
+
+    constexpr int find_child(int node, char32_t cp) const {
+        for (int c = nodes[node].first_child; c != -1; c = nodes[c].next_sibling) {
+            if (nodes[c].cp == cp) return c;
+        }
+        return -1;
+    }
+
+    constexpr void insert(const char* suffix) {
+        char32_t cps[MAX_SUFFIX_LENGTH] = {};
+        size_t n = 0;
+        size_t i = 0;
+        while (suffix[i] != '\0') {
+            cps[n++] = decode_at(suffix, i);
+        }
+
+        int node = 0;
+        for (size_t k = n; k > 0; --k) {
+            int child = find_child(node, cps[k - 1]);
+            if (child == -1) {
+                child = static_cast<int>(count++);
+                nodes[child].cp = cps[k - 1];
+                nodes[child].next_sibling = nodes[node].first_child;
+                nodes[node].first_child = static_cast<int16_t>(child);
+            }
+            node = child;
+        }
+        nodes[node].terminal = true;
+    }
+
+    // Длина (в символах) самого длинного окончания word[begin, end),
+    // не выходящего за begin; 0 — если ни одно не подошло
+    size_t longest_match(const char32_t* word, size_t begin, size_t end) const {
+        size_t best = 0;
+        int node = 0;
+        size_t depth = 0;
+
+        for (size_t pos = end; pos > begin; --pos) {
+            node = find_child(node, word[pos - 1]);
+            if (node == -1) break;
+            depth++;
+            if (nodes[node].terminal) best = depth;
+        }
+        return best;
+    }
+};
+
+template <size_t MaxNodes, size_t N>
+constexpr Trie<MaxNodes> build(const char* const (&suffixes)[N]) {
+    Trie<MaxNodes> trie;
+    for (size_t k = 0; k < N; ++k) {
+        trie.insert(suffixes[k]);
+    }
+    return trie;
+}
+
+}
+
+
+#endif
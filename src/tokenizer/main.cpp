@@ -1,10 +1,17 @@
 #include "tokenizer/tokenizer.h"
+#include "common/thread_pool.h"
+#include "common/trace.h"
 #include <iostream>
 
 int main(int argc, char* argv[]) {
+    int threads = utils::extract_threads_option(argc, argv, utils::default_thread_count());
+    bool pool_stats = utils::extract_flag(argc, argv, "--pool-stats");
+    utils::ThreadPool::configure_shared(threads);
+    trace::Session tracing(argc, argv);
+    
     if (argc < 3) {
         std::cout << "Использование: " << argv[0] 
-                 << " <input_corpus> <output_tokens>" << std::endl;
+                 << " <input_corpus> <output_tokens> [--threads N] [--pool-stats] [--trace FILE] [--metrics FILE]" << std::endl;
         std::cout << "Пример: ./tokenizer data/processed/corpus.txt data/processed/tokens.txt" 
                  << std::endl;
         return 1;
@@ -15,9 +22,12 @@ int main(int argc, char* argv[]) {
     std::string vocab_file = "data/processed/vocabulary.txt";
     
     Tokenizer tokenizer;
-    tokenizer.tokenize_corpus(input_file, output_file);
+    if (!tokenizer.tokenize_corpus(input_file, output_file)) {
+        return 1;
+    }
     tokenizer.save_vocabulary(vocab_file);
     tokenizer.print_statistics();
+    if (pool_stats) utils::ThreadPool::shared().print_statistics();
     
     return 0;
 }
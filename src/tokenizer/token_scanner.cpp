@@ -0,0 +1,269 @@
+#include "tokenizer/token_scanner.h"
+#include "common/utf8.h"
+#include <algorithm>
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define TOKEN_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace token_scanner {
+
+namespace {
+
+const size_t NO_TOKEN = static_cast<size_t>(-1);
+
+struct ScanState {
+    const char* src;
+    const char* end;
+    char* dst;
+    size_t size;
+    size_t token_start = NO_TOKEN;
+    std::vector<std::string_view>* tokens;
+
+    void emit(size_t start, size_t stop) {
+        // Токен короче двух символов отбрасываем. В токен попадают только ASCII
+        // (1 байт) и кириллица (2 байта), поэтому 2 байта — это либо два
+        // ASCII-символа, либо одна кириллическая буква.
+        size_t len = stop - start;
+        if (len >= 3 || (len == 2 && static_cast<unsigned char>(dst[start]) < 0x80)) {
+            tokens->emplace_back(dst + start, len);
+        }
+    }
+
+    void mark(size_t pos, bool token_char) {
+        if (token_char) {
+            if (token_start == NO_TOKEN) token_start = pos;
+        } else if (token_start != NO_TOKEN) {
+            emit(token_start, pos);
+            token_start = NO_TOKEN;
+        }
+    }
+
+    // Один символ скалярного пути, возвращает позицию следующего
+    size_t step(size_t i) {
+        unsigned char c = static_cast<unsigned char>(src[i]);
+
+        if (c < 0x80) {
+            const utf8::CharInfo& info = utf8::ascii_table[c];
+            dst[i] = static_cast<char>(info.lower);
+            mark(i, info.cls != utf8::SEPARATOR);
+            return i + 1;
+        }
+
+        int len;
+        char32_t cp = utf8::decode(src + i, end, len);
+        utf8::CharInfo info = cp == utf8::INVALID
+            ? utf8::CharInfo{utf8::SEPARATOR, cp}
+            : utf8::classify(cp);
+        bool token_char = info.cls != utf8::SEPARATOR;
+
+        // Понижение регистра по таблицам utf8 не меняет длину символа в байтах
+        if (token_char) {
+            utf8::encode(info.lower, dst + i);
+        } else {
+            std::copy(src + i, src + i + len, dst + i);
+        }
+        mark(i, token_char);
+        return i + len;
+    }
+
+    void finish() {
+        if (token_start != NO_TOKEN) {
+            emit(token_start, size);
+            token_start = NO_TOKEN;
+        }
+    }
+
+    // Обработка маски токен-символов ASCII-блока длины width с позиции base.
+    // Начала токенов — переходы 0->1, концы — 1->0; бит "перед блоком"
+    // берётся из того, открыт ли токен.
+    void apply_mask(uint64_t mask, int width, size_t base) {
+        uint64_t all = width == 64 ? ~0ULL : ((1ULL << width) - 1);
+        uint64_t carry = token_start != NO_TOKEN ? 1 : 0;
+        uint64_t prev = ((mask << 1) | carry) & all;
+
+        uint64_t starts = mask & ~prev;
+        uint64_t ends = ~mask & prev & all;
+        uint64_t events = starts | ends;
+
+        while (events) {
+            int bit = __builtin_ctzll(events);
+            uint64_t low = events & (0 - events);
+            if (starts & low) {
+                token_start = base + bit;
+            } else {
+                emit(token_start, base + bit);
+                token_start = NO_TOKEN;
+            }
+            events ^= low;
+        }
+    }
+
+    // Блок с не-ASCII байтами: ASCII-префикс до первого такого байта берём
+    // из маски, затем скалярно проходим не-ASCII участок до ближайшего
+    // ASCII-байта, откуда векторный цикл продолжает работу
+    size_t skip_non_ascii(uint32_t token_mask, uint32_t high, size_t i) {
+        int prefix = __builtin_ctz(high);
+        if (prefix > 0) {
+            apply_mask(token_mask & ((1u << prefix) - 1), prefix, i);
+            i += prefix;
+        }
+
+        do {
+            i = step(i);
+        } while (i < size && static_cast<unsigned char>(src[i]) >= 0x80);
+
+        return i;
+    }
+};
+
+void scan_scalar(ScanState& st, size_t i) {
+    while (i < st.size) {
+        i = st.step(i);
+    }
+}
+
+#ifdef TOKEN_SCANNER_X86
+
+__attribute__((target("sse2")))
+void scan_sse2(ScanState& st) {
+    const __m128i a_lo = _mm_set1_epi8('a' - 1);
+    const __m128i z_hi = _mm_set1_epi8('z' + 1);
+    const __m128i A_lo = _mm_set1_epi8('A' - 1);
+    const __m128i Z_hi = _mm_set1_epi8('Z' + 1);
+    const __m128i d_lo = _mm_set1_epi8('0' - 1);
+    const __m128i d_hi = _mm_set1_epi8('9' + 1);
+    const __m128i dash = _mm_set1_epi8('-');
+    const __m128i quote = _mm_set1_epi8('\'');
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+
+    size_t i = 0;
+    while (i + 16 <= st.size) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(st.src + i));
+
+        // Для байтов >= 0x80 знаковые сравнения дают мусор, но эти позиции
+        // в маску не попадают и перезаписываются скалярным путём
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, A_lo), _mm_cmplt_epi8(v, Z_hi));
+        __m128i lowered = _mm_or_si128(v, _mm_and_si128(upper, case_bit));
+        __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(lowered, a_lo), _mm_cmplt_epi8(lowered, z_hi));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, d_lo), _mm_cmplt_epi8(v, d_hi));
+        __m128i joiner = _mm_or_si128(_mm_cmpeq_epi8(v, dash), _mm_cmpeq_epi8(v, quote));
+        __m128i token = _mm_or_si128(_mm_or_si128(letter, digit), joiner);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(st.dst + i), lowered);
+        uint32_t token_mask = static_cast<uint32_t>(_mm_movemask_epi8(token));
+        uint32_t high = static_cast<uint32_t>(_mm_movemask_epi8(v));
+
+        if (high == 0) {
+            st.apply_mask(token_mask, 16, i);
+            i += 16;
+            continue;
+        }
+
+        i = st.skip_non_ascii(token_mask, high, i);
+    }
+
+    scan_scalar(st, i);
+}
+
+__attribute__((target("avx2")))
+void scan_avx2(ScanState& st) {
+    const __m256i a_lo = _mm256_set1_epi8('a' - 1);
+    const __m256i z_hi = _mm256_set1_epi8('z' + 1);
+    const __m256i A_lo = _mm256_set1_epi8('A' - 1);
+    const __m256i Z_hi = _mm256_set1_epi8('Z' + 1);
+    const __m256i d_lo = _mm256_set1_epi8('0' - 1);
+    const __m256i d_hi = _mm256_set1_epi8('9' + 1);
+    const __m256i dash = _mm256_set1_epi8('-');
+    const __m256i quote = _mm256_set1_epi8('\'');
+    const __m256i case_bit = _mm256_set1_epi8(0x20);
+
+    size_t i = 0;
+    while (i + 32 <= st.size) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(st.src + i));
+
+        __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, A_lo), _mm256_cmpgt_epi8(Z_hi, v));
+        __m256i lowered = _mm256_or_si256(v, _mm256_and_si256(upper, case_bit));
+        __m256i letter = _mm256_and_si256(_mm256_cmpgt_epi8(lowered, a_lo), _mm256_cmpgt_epi8(z_hi, lowered));
+        __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, d_lo), _mm256_cmpgt_epi8(d_hi, v));
+        __m256i joiner = _mm256_or_si256(_mm256_cmpeq_epi8(v, dash), _mm256_cmpeq_epi8(v, quote));
+        __m256i token = _mm256_or_si256(_mm256_or_si256(letter, digit), joiner);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(st.dst + i), lowered);
+        uint32_t token_mask = static_cast<uint32_t>(_mm256_movemask_epi8(token));
+        uint32_t high = static_cast<uint32_t>(_mm256_movemask_epi8(v));
+
+        if (high == 0) {
+            st.apply_mask(token_mask, 32, i);
+            i += 32;
+            continue;
+        }
+
+        i = st.skip_non_ascii(token_mask, high, i);
+    }
+
+    scan_scalar(st, i);
+}
+
+#endif
+
+}
+
+bool is_supported(Backend backend) {
+    switch (backend) {
+        case Backend::SCALAR:
+            return true;
+#ifdef TOKEN_SCANNER_X86
+        case Backend::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case Backend::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+Backend detect_backend() {
+    if (is_supported(Backend::AVX2)) return Backend::AVX2;
+    if (is_supported(Backend::SSE2)) return Backend::SSE2;
+    return Backend::SCALAR;
+}
+
+const char* backend_name(Backend backend) {
+    switch (backend) {
+        case Backend::SSE2: return "sse2";
+        case Backend::AVX2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+void scan(std::string_view text, char* dst, std::vector<std::string_view>& tokens,
+          Backend backend) {
+    ScanState st;
+    st.src = text.data();
+    st.end = text.data() + text.size();
+    st.dst = dst;
+    st.size = text.size();
+    st.tokens = &tokens;
+
+    switch (backend) {
+#ifdef TOKEN_SCANNER_X86
+        case Backend::SSE2:
+            scan_sse2(st);
+            break;
+        case Backend::AVX2:
+            scan_avx2(st);
+            break;
+#endif
+        default:
+            scan_scalar(st, 0);
+            break;
+    }
+
+    st.finish();
+}
+
+}
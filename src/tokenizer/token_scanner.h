@@ -0,0 +1,33 @@
+#ifndef TOKEN_SCANNER_H
+#define TOKEN_SCANNER_H
+
+#include <string_view>
+#include <vector>
+
+// Поиск границ токенов с одновременным понижением регистра.
+// Векторные варианты обрабатывают по 16/32 байта: блоки из одного ASCII
+// классифицируются масками, блоки с не-ASCII байтами уходят в скалярный
+// UTF-8 путь. Результат всех вариантов совпадает байт в байт.
+namespace token_scanner {
+
+enum class Backend {
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+// Лучший вариант, который поддерживает текущий процессор
+Backend detect_backend();
+
+bool is_supported(Backend backend);
+
+const char* backend_name(Backend backend);
+
+// Пишет text в нижнем регистре в dst (text.size() байт, смещения совпадают)
+// и добавляет в tokens string_view на токены внутри dst
+void scan(std::string_view text, char* dst, std::vector<std::string_view>& tokens,
+          Backend backend);
+
+}
+
+#endif
@@ -1,99 +1,185 @@
 #include "tokenizer/tokenizer.h"
+#include "common/corpus_format.h"
+#include "common/ordered_pipeline.h"
+#include "common/trace.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
-#include <cctype>
-#include <set>
 
-bool Tokenizer::is_token_char(unsigned char c) const {
-    return std::isalnum(c) || c == '-' || c == '\'' || 
-           (c >= 0xC0 && c <= 0xFF);
+const std::vector<std::string_view>& Tokenizer::tokenize_view(std::string_view text) {
+    buffer.resize(text.size());
+    token_views.clear();
+    token_scanner::scan(text, &buffer[0], token_views, backend);
+    return token_views;
 }
 
 std::vector<std::string> Tokenizer::tokenize(const std::string& text) {
-    std::vector<std::string> tokens;
-    std::string current_token;
-    
-    for (size_t i = 0; i < text.length(); ++i) {
-        unsigned char c = static_cast<unsigned char>(text[i]);
-        
-        if (is_token_char(c)) {
-            current_token += std::tolower(c);
-        } else {
-            if (!current_token.empty() && current_token.length() >= 2) {
-                tokens.push_back(current_token);
-            }
-            current_token.clear();
-        }
-    }
+    const auto& views = tokenize_view(text);
+    return std::vector<std::string>(views.begin(), views.end());
+}
+
+const std::vector<std::string_view>& Tokenizer::tokenize_document(std::string_view text) {
+    const auto& tokens = tokenize_view(text);
     
-    if (!current_token.empty() && current_token.length() >= 2) {
-        tokens.push_back(current_token);
-    }
+    stats.documents_processed++;
+    stats.total_tokens += tokens.size();
     
+    for (const auto& token : tokens) {
+        token_frequencies.add(token);
+    }
     return tokens;
 }
 
-void Tokenizer::tokenize_corpus(const std::string& input_file, const std::string& output_file) {
-    std::cout << "Начинаем токенизацию..." << std::endl;
+void Tokenizer::merge_from(const Tokenizer& other) {
+    stats.documents_processed += other.stats.documents_processed;
+    stats.total_tokens += other.stats.total_tokens;
+    token_frequencies.merge(other.token_frequencies);
+}
+
+namespace {
+
+const size_t CHUNK_LINES = 1024;
+const size_t CHUNK_BYTES = 4 << 20;
+
+// Результат порции: строки tokens.txt или записи двоичного корпуса
+struct TokenizedChunk {
+    std::string text;
+    corpus::TermsBatch batch;
+    int documents = 0;
+    // Строк во входной порции и номера битых среди них
+    size_t lines = 0;
+    std::vector<size_t> malformed;
+};
+
+}
+
+bool Tokenizer::tokenize_corpus(const std::string& input_file, const std::string& output_file) {
+    // Порции обрабатывает общий пул процесса, размер задаётся --threads
+    utils::ThreadPool& pool = utils::ThreadPool::shared();
+    int threads = static_cast<int>(pool.size());
+    std::cout << "Начинаем токенизацию (потоков: " << threads << ")..." << std::endl;
     
     utils::Timer timer;
     
-    auto documents = utils::read_documents_txt(input_file);
-    
-    std::ofstream out(output_file);
-    if (!out.is_open()) {
-        std::cerr << "Ошибка создания файла: " << output_file << std::endl;
-        return;
+    corpus::ChunkSource source;
+    if (!source.open(input_file)) {
+        return false;
     }
     
-    std::set<std::string> unique_tokens_set;
-    
-    for (const auto& doc : documents) {
-        auto tokens = tokenize(doc.text);
-        
-        stats.documents_processed++;
-        stats.total_tokens += tokens.size();
-        
-        for (const auto& token : tokens) {
-            token_frequencies[token]++;
-            unique_tokens_set.insert(token);
-        }
-        
-        out << doc.doc_id << "|" << doc.source << "|" << doc.title << "|";
-        
-        for (size_t i = 0; i < tokens.size(); ++i) {
-            out << tokens[i];
-            if (i < tokens.size() - 1) out << " ";
-        }
-        out << "\n";
-        
-        if (stats.documents_processed % 1000 == 0) {
-            std::cout << "\rОбработано документов: " << stats.documents_processed 
-                     << " / " << documents.size() << std::flush;
+    // Формат выхода выбирается по расширению: .bin — двоичный корпус
+    bool binary_output = corpus::is_binary_name(output_file);
+    std::ofstream out;
+    corpus::Writer writer(corpus::Kind::TERMS);
+    if (binary_output) {
+        if (!writer.open(output_file)) return false;
+    } else {
+        out.open(output_file);
+        if (!out.is_open()) {
+            std::cerr << "Ошибка создания файла: " << output_file << std::endl;
+            return false;
         }
     }
     
-    std::cout << std::endl;
+    // У каждого потока свой Tokenizer: буфер, частоты и счётчики без
+    // синхронизации, сливаются в this после завершения. Номер потока —
+    // current_worker(), поэтому элементов size() + 1: последний для
+    // потока вне пула, выполняющего задачи через run_pending
+    std::vector<Tokenizer> workers(threads > 1 ? pool.size() + 1 : 0);
+    for (auto& worker : workers) {
+        worker.set_backend(backend);
+    }
     
-    stats.unique_tokens = unique_tokens_set.size();
+    int documents_written = 0;
+    size_t lines_written = 0;
+    
+    static trace::Histogram& chunk_latency = trace::histogram(
+        "tokenizer_chunk_duration_us", "Время токенизации одной порции, мкс");
+    static trace::Counter& documents_total = trace::counter(
+        "tokenizer_documents_total", "Токенизировано документов");
+    static trace::Counter& tokens_total = trace::counter(
+        "tokenizer_tokens_total", "Получено токенов");
+    
+    utils::run_ordered_pipeline<corpus::InputChunk, TokenizedChunk>(
+        pool, pool.size() * 4,
+        [&](corpus::InputChunk& input) {
+            return source.next_chunk(input, CHUNK_LINES, CHUNK_BYTES);
+        },
+        [&](int worker, corpus::InputChunk& input, TokenizedChunk& chunk) {
+            trace::Span span("tokenize_chunk", &chunk_latency);
+            Tokenizer& t = threads > 1 ? workers[worker] : *this;
+            corpus::DocumentView doc;
+            uint64_t chunk_tokens = 0;
+            chunk.lines = input.count;
+            for (size_t k = 0; k < input.count; ++k) {
+                if (!source.document_at(input, k, doc)) {
+                    chunk.malformed.push_back(k);
+                    continue;
+                }
+                
+                const auto& tokens = t.tokenize_document(doc.text);
+                chunk.documents++;
+                chunk_tokens += tokens.size();
+                
+                if (binary_output) {
+                    chunk.batch.add(doc.doc_id, doc.source, doc.title, tokens);
+                } else {
+                    corpus::append_terms_line(chunk.text, doc.doc_id, doc.source, doc.title, tokens);
+                }
+            }
+            documents_total.add(chunk.documents);
+            tokens_total.add(chunk_tokens);
+        },
+        [&](TokenizedChunk& chunk) {
+            trace::Span span("write_tokens");
+            // Порции приходят по порядку, поэтому номер строки во входе известен
+            for (size_t k : chunk.malformed) {
+                std::cerr << "\nОшибка парсинга строки " << lines_written + k + 1 << std::endl;
+            }
+            stats.malformed_lines += static_cast<int>(chunk.malformed.size());
+            lines_written += chunk.lines;
+            
+            if (binary_output) {
+                writer.add_batch(chunk.batch);
+            } else {
+                out << chunk.text;
+            }
+            
+            int before = documents_written;
+            documents_written += chunk.documents;
+            if (documents_written / 1000 != before / 1000) {
+                std::cout << "\rОбработано документов: " << documents_written << std::flush;
+            }
+        });
     
-    out.close();
+    for (const auto& worker : workers) {
+        merge_from(worker);
+    }
+    
+    std::cout << std::endl;
+    
+    stats.unique_tokens = token_frequencies.size();
+    
+    // Без заголовка и таблицы смещений двоичный корпус не прочитать
+    bool written = true;
+    if (binary_output) {
+        written = writer.close();
+    } else {
+        out.close();
+        if (!out) {
+            std::cerr << "Ошибка записи файла: " << output_file << std::endl;
+            written = false;
+        }
+    }
+    if (!written) return false;
     
     std::cout << "Токенизация завершена за " << timer.elapsed_ms() / 1000.0 << " сек" << std::endl;
+    return true;
 }
 
 void Tokenizer::save_vocabulary(const std::string& vocab_file, int top_n) {
     std::cout << "Сохранение словаря..." << std::endl;
     
-    std::vector<std::pair<std::string, int>> sorted_tokens(
-        token_frequencies.begin(), token_frequencies.end()
-    );
-    
-    std::sort(sorted_tokens.begin(), sorted_tokens.end(),
-              [](const auto& a, const auto& b) {
-                  return a.second > b.second;
-              });
+    auto sorted_tokens = token_frequencies.top_n(top_n);
     
     std::ofstream out(vocab_file);
     if (!out.is_open()) {
@@ -104,9 +190,7 @@ void Tokenizer::save_vocabulary(const std::string& vocab_file, int top_n) {
     out << "# Словарь токенов (топ-" << top_n << ")\n";
     out << "# Формат: токен частота\n";
     
-    int count = 0;
     for (const auto& [token, freq] : sorted_tokens) {
-        if (count++ >= top_n) break;
         out << token << " " << freq << "\n";
     }
     
@@ -124,6 +208,9 @@ void Tokenizer::print_statistics() const {
     std::cout << "Документов обработано: " << stats.documents_processed << std::endl;
     std::cout << "Всего токенов: " << stats.total_tokens << std::endl;
     std::cout << "Уникальных токенов: " << stats.unique_tokens << std::endl;
+    if (stats.malformed_lines > 0) {
+        std::cout << "Пропущено битых строк: " << stats.malformed_lines << std::endl;
+    }
     std::cout << "Средняя длина документа: " << avg_tokens << " токенов" << std::endl;
     std::cout << "==============================\n" << std::endl;
 }
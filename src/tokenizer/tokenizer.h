@@ -2,9 +2,11 @@
 #define TOKENIZER_H
 
 #include "common/utils.h"
+#include "common/frequency_counter.h"
+#include "tokenizer/token_scanner.h"
 #include <vector>
 #include <string>
-#include <map>
+#include <string_view>
 
 class Tokenizer {
 private:
@@ -12,16 +14,33 @@ private:
         int documents_processed = 0;
         size_t total_tokens = 0;
         size_t unique_tokens = 0;
+        int malformed_lines = 0;
     } stats;
     
-    std::map<std::string, int> token_frequencies;
+    utils::FrequencyCounter token_frequencies;
     
-    bool is_token_char(unsigned char c) const;
+    // Текст в нижнем регистре; токены из tokenize_view указывают сюда
+    std::string buffer;
+    std::vector<std::string_view> token_views;
+    
+    token_scanner::Backend backend = token_scanner::detect_backend();
+    
+    // Токенизирует текст документа и учитывает его в статистике
+    const std::vector<std::string_view>& tokenize_document(std::string_view text);
+    
+    void merge_from(const Tokenizer& other);
     
 public:
+    void set_backend(token_scanner::Backend b) { backend = b; }
+    token_scanner::Backend get_backend() const { return backend; }
+    
+    // Токены действительны до следующего вызова tokenize_view/tokenize
+    const std::vector<std::string_view>& tokenize_view(std::string_view text);
+    
     std::vector<std::string> tokenize(const std::string& text);
     
-    void tokenize_corpus(const std::string& input_file, const std::string& output_file);
+    // false, если вход не открылся или выход не записан целиком
+    bool tokenize_corpus(const std::string& input_file, const std::string& output_file);
     
     void save_vocabulary(const std::string& vocab_file, int top_n = 10000);
     
@@ -1,26 +1,74 @@
 #include "zipf/zipf_analyzer.h"
+#include "common/thread_pool.h"
+#include "common/trace.h"
+#include "common/utils.h"
+#include "common/heavy_hitters.h"
 #include <iostream>
+#include <cstring>
 
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
+    int threads = utils::extract_threads_option(argc, argv, utils::default_thread_count());
+    bool pool_stats = utils::extract_flag(argc, argv, "--pool-stats");
+    utils::ThreadPool::configure_shared(threads);
+    trace::Session tracing(argc, argv);
+    size_t approx_top = 0;
+    std::string input_file;
+    std::string index_file;
+    
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--approx") == 0 && i + 1 < argc) {
+            if (!utils::SpaceSaving::parse_capacity(argv[++i], approx_top)) {
+                std::cerr << "Неверное значение --approx: " << argv[i]
+                          << " (ожидается целое от 1 до "
+                          << utils::SpaceSaving::MAX_CAPACITY << ")" << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--from-index") == 0 && i + 1 < argc) {
+            index_file = argv[++i];
+        } else {
+            input_file = argv[i];
+        }
+    }
+    
+    if (input_file.empty() && index_file.empty()) {
         std::cout << "Использование: " << argv[0] 
-                 << " <input_stems>" << std::endl;
+                 << " <input_stems> [--approx K] [--threads N] [--pool-stats] [--trace FILE] [--metrics FILE]" << std::endl;
+        std::cout << "               " << argv[0] << " --from-index <index_file>" << std::endl;
         std::cout << "Пример: ./zipf_analyzer data/processed/stems.txt" 
                  << std::endl;
+        std::cout << "  --approx K  приближённый подсчёт K самых частых слов в ограниченной памяти"
+                 << std::endl;
+        std::cout << "  --from-index  частоты из секции статистики индекса, без чтения корпуса"
+                 << std::endl;
+        std::cout << "  --threads N  потоков точного подсчёта (по умолчанию — число ядер)"
+                 << std::endl;
+        std::cout << "  --pool-stats  задачи, занятость и перехваты по потокам пула в конце работы"
+                 << std::endl;
+        std::cout << "  --trace FILE, --metrics FILE  трасса Chrome и метрики Prometheus"
+                 << std::endl;
         return 1;
     }
     
-    std::string input_file = argv[1];
     std::string output_file = "data/processed/zipf_statistics.txt";
     
     ZipfAnalyzer analyzer;
-    
-    analyzer.analyze_corpus(input_file);
+    if (!index_file.empty()) {
+        if (!analyzer.analyze_index(index_file)) {
+            return 1;
+        }
+    } else {
+        if (approx_top > 0) {
+            analyzer.enable_approximation(approx_top);
+        }
+        analyzer.analyze_corpus(input_file);
+    }
 
     analyzer.save_statistics(output_file);
     
     analyzer.print_statistics();
+    analyzer.print_fits();
     analyzer.print_top_words(50);
+    if (pool_stats) utils::ThreadPool::shared().print_statistics();
     
     return 0;
 }
@@ -1,33 +1,212 @@
 #include "zipf/zipf_analyzer.h"
 #include "common/utils.h"
+#include "common/corpus_format.h"
+#include "common/line_reader.h"
+#include "common/mapped_file.h"
+#include "common/thread_pool.h"
+#include "common/trace.h"
+#include "index/index_shards.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
 #include <iomanip>
 #include <cmath>
 
+namespace {
+
+struct PowerLawFit {
+    double exponent = 0;
+    double coefficient = 0;
+    double r_squared = 0;
+    size_t points = 0;
+};
+
+// y = coefficient * x^exponent по точкам (x, y) с положительными координатами
+PowerLawFit fit_power_law(const std::vector<std::pair<double, double>>& points) {
+    PowerLawFit fit;
+    double sx = 0, sy = 0, sxx = 0, sxy = 0, syy = 0;
+    for (const auto& [x, y] : points) {
+        if (x <= 0 || y <= 0) continue;
+        double lx = std::log(x);
+        double ly = std::log(y);
+        sx += lx;
+        sy += ly;
+        sxx += lx * lx;
+        sxy += lx * ly;
+        syy += ly * ly;
+        fit.points++;
+    }
+    if (fit.points < 2) return fit;
+    
+    double n = static_cast<double>(fit.points);
+    double var_x = sxx - sx * sx / n;
+    double var_y = syy - sy * sy / n;
+    double cov = sxy - sx * sy / n;
+    if (var_x <= 0) return fit;
+    
+    fit.exponent = cov / var_x;
+    fit.coefficient = std::exp((sy - fit.exponent * sx) / n);
+    fit.r_squared = var_y > 0 ? (cov * cov) / (var_x * var_y) : 1.0;
+    return fit;
+}
+
+// f(0) ... f(count - 1) задачами общего пула потоков
+template <typename F>
+void for_each_parallel(size_t count, F f) {
+    utils::ThreadPool::shared().parallel_for(0, count, 1, [&f](size_t lo, size_t hi) {
+        for (size_t i = lo; i < hi; ++i) {
+            f(i);
+        }
+    });
+}
+
+// Раздел берётся по старшим битам хэша: младшие задают слот внутри
+// FrequencyCounter, и раздел от них не зависит
+size_t partition_of(uint32_t hash, size_t partitions) {
+    return static_cast<size_t>((static_cast<uint64_t>(hash) * partitions) >> 32);
+}
+
+// Тот же порядок, что у FrequencyCounter: по частоте, затем по слову
+bool ranks_before(const ZipfAnalyzer::RankedTerm& a, const ZipfAnalyzer::RankedTerm& b) {
+    if (a.frequency != b.frequency) return a.frequency > b.frequency;
+    return a.word < b.word;
+}
+
+// Всё, что насчитал один поток по своему куску корпуса
+struct ChunkCounts {
+    struct FirstSeen {
+        std::string_view term;
+        uint32_t hash;
+        uint32_t document;
+    };
+
+    std::vector<utils::FrequencyCounter> partitions;
+    // Словоупотреблений в каждом документе куска
+    std::vector<uint32_t> document_tokens;
+    // Первое появление слова внутри куска
+    std::vector<FirstSeen> first_seen;
+    // Сколько слов документа не встречалось раньше во всём корпусе
+    std::vector<uint32_t> document_new_terms;
+};
+
+}
+
+void ZipfAnalyzer::enable_approximation(size_t top_k) {
+    heavy_hitters = std::make_unique<utils::SpaceSaving>(top_k);
+}
+
+void ZipfAnalyzer::count_term(std::string_view term, uint64_t n) {
+    if (heavy_hitters) {
+        uint64_t hash = utils::HyperLogLog::hash_key(term);
+        unique_terms.add_hash(hash);
+        heavy_hitters->add_hashed(term, static_cast<uint32_t>(hash), n);
+    } else {
+        if (word_frequencies.empty()) word_frequencies.resize(1);
+        word_frequencies.front().add(term, n);
+    }
+}
+
+void ZipfAnalyzer::build_ranking() {
+    ranking.clear();
+    if (heavy_hitters) {
+        for (const auto& entry : heavy_hitters->sorted()) {
+            ranking.push_back({entry.key, entry.count, entry.error});
+        }
+        return;
+    }
+    
+    // Каждый раздел сортируется своим потоком, затем отсортированные
+    // разделы сливаются попарно; уровни слияния тоже параллельны
+    trace::Span span("zipf_rank");
+    std::vector<std::vector<RankedTerm>> runs(word_frequencies.size());
+    for_each_parallel(runs.size(), [&](size_t p) {
+        trace::Span sort_span("zipf_sort_partition");
+        auto sorted_words = word_frequencies[p].sorted();
+        runs[p].reserve(sorted_words.size());
+        for (const auto& [word, freq] : sorted_words) {
+            runs[p].push_back({word, freq, 0});
+        }
+    });
+    
+    while (runs.size() > 1) {
+        std::vector<std::vector<RankedTerm>> merged((runs.size() + 1) / 2);
+        for_each_parallel(merged.size(), [&](size_t k) {
+            if (2 * k + 1 == runs.size()) {
+                merged[k] = std::move(runs[2 * k]);
+                return;
+            }
+            const auto& a = runs[2 * k];
+            const auto& b = runs[2 * k + 1];
+            merged[k].resize(a.size() + b.size());
+            std::merge(a.begin(), a.end(), b.begin(), b.end(), merged[k].begin(), ranks_before);
+        });
+        runs.swap(merged);
+    }
+    if (!runs.empty()) ranking = std::move(runs.front());
+}
+
+uint64_t ZipfAnalyzer::total_words() const {
+    if (heavy_hitters) return heavy_hitters->total();
+    if (collection) return collection->tokens;
+    uint64_t total = 0;
+    for (const auto& partition : word_frequencies) {
+        total += partition.total();
+    }
+    return total;
+}
+
+uint64_t ZipfAnalyzer::unique_words() const {
+    return heavy_hitters ? unique_terms.estimate() : ranking.size();
+}
+
+size_t ZipfAnalyzer::guaranteed_top() const {
+    if (!heavy_hitters) return ranking.size();
+    
+    // Первые i слов — точный топ-i, если нижняя оценка каждого из них
+    // не меньше верхней оценки (i+1)-го; любое неотслеживаемое слово
+    // встречается не чаще max_error
+    uint64_t min_lower = UINT64_MAX;
+    size_t guaranteed = 0;
+    for (size_t i = 0; i < ranking.size(); ++i) {
+        min_lower = std::min(min_lower, ranking[i].frequency - ranking[i].error);
+        uint64_t next = i + 1 < ranking.size() ? ranking[i + 1].frequency : heavy_hitters->max_error();
+        if (min_lower >= next) guaranteed = i + 1;
+    }
+    return guaranteed;
+}
+
 void ZipfAnalyzer::analyze_corpus(const std::string& input_file) {
+    if (corpus::is_binary_file(input_file)) {
+        analyze_binary_corpus(input_file);
+        return;
+    }
+    
     std::cout << "Анализ закона Ципфа..." << std::endl;
     
-    std::ifstream in(input_file);
-    if (!in.is_open()) {
-        std::cerr << "Ошибка открытия файла: " << input_file << std::endl;
+    if (!heavy_hitters) {
+        utils::MappedFile file;
+        if (!file.open(input_file)) {
+            return;
+        }
+        count_text_parallel(std::string_view(file.data(), file.size()));
+        std::cout << "Анализ завершён" << std::endl;
         return;
     }
     
-    std::string line;
+    utils::LineReader reader;
+    if (!reader.open(input_file)) {
+        return;
+    }
+    
+    std::string_view line;
+    corpus::TermsView doc;
     int docs_processed = 0;
     
-    while (std::getline(in, line)) {
-        auto parts = utils::split(line, '|');
-        if (parts.size() < 4) continue;
-        
-        std::string stems_str = parts[3];
-        auto stems = utils::split(stems_str, ' ');
+    while (reader.next(line)) {
+        if (!corpus::parse_terms_line(line, doc)) continue;
         
-        for (const auto& stem : stems) {
-            word_frequencies[stem]++;
-            total_words++;
+        for (const auto& stem : doc.terms) {
+            count_term(stem);
         }
         
         docs_processed++;
@@ -37,23 +216,175 @@ void ZipfAnalyzer::analyze_corpus(const std::string& input_file) {
     }
     
     std::cout << std::endl;
+    build_ranking();
+    std::cout << "Анализ завершён" << std::endl;
+}
+
+void ZipfAnalyzer::count_text_parallel(std::string_view text) {
+    utils::Timer total_timer;
+    utils::Timer timer;
+    
+    // Кусков и разделов столько же, сколько потоков в пуле
+    size_t partitions = utils::ThreadPool::shared().size();
+    std::vector<std::string_view> ranges = utils::split_by_lines(text, partitions);
+    std::vector<ChunkCounts> chunks(ranges.size());
+    
+    // Map: у каждого потока свои таблицы, по одной на раздел
+    for_each_parallel(chunks.size(), [&](size_t c) {
+        trace::Span span("zipf_map");
+        ChunkCounts& counts = chunks[c];
+        counts.partitions.resize(partitions);
+        corpus::TermsView doc;
+        
+        utils::for_each_field(ranges[c], '\n', [&](std::string_view line) {
+            if (!corpus::parse_terms_line(line, doc)) return;
+            
+            uint32_t document = static_cast<uint32_t>(counts.document_tokens.size());
+            for (const auto& term : doc.terms) {
+                uint32_t hash = utils::FrequencyCounter::hash_key(term);
+                auto& partition = counts.partitions[partition_of(hash, partitions)];
+                size_t known = partition.size();
+                partition.add_hashed(term, hash);
+                if (partition.size() != known) {
+                    counts.first_seen.push_back({term, hash, document});
+                }
+            }
+            counts.document_tokens.push_back(static_cast<uint32_t>(doc.terms.size()));
+        });
+    });
+    double map_ms = timer.elapsed_ms();
+    
+    // Слово новое для корпуса, если его нет ни в одном из предыдущих кусков.
+    // Таблицы кусков пока не тронуты слиянием, поэтому проверка параллельна.
+    timer.reset();
+    for_each_parallel(chunks.size(), [&](size_t c) {
+        trace::Span span("zipf_first_seen");
+        ChunkCounts& counts = chunks[c];
+        counts.document_new_terms.assign(counts.document_tokens.size(), 0);
+        for (const auto& first : counts.first_seen) {
+            size_t p = partition_of(first.hash, partitions);
+            bool seen = false;
+            for (size_t prev = 0; prev < c && !seen; ++prev) {
+                seen = chunks[prev].partitions[p].count_hashed(first.term, first.hash) > 0;
+            }
+            if (!seen) counts.document_new_terms[first.document]++;
+        }
+        counts.first_seen = {};
+    });
+    
+    // Reduce: раздел p собирается из разделов p всех кусков одним потоком
+    word_frequencies.clear();
+    word_frequencies.resize(partitions);
+    for_each_parallel(partitions, [&](size_t p) {
+        trace::Span span("zipf_reduce");
+        for (auto& counts : chunks) {
+            if (word_frequencies[p].size() == 0) {
+                word_frequencies[p] = std::move(counts.partitions[p]);
+            } else {
+                word_frequencies[p].merge(counts.partitions[p]);
+                counts.partitions[p] = utils::FrequencyCounter();
+            }
+        }
+    });
+    double reduce_ms = timer.elapsed_ms();
+    
+    // Рост словаря восстанавливается по документам в исходном порядке,
+    // точки те же, что при однопоточном проходе
+    uint64_t tokens = 0;
+    uint64_t vocabulary = 0;
+    size_t documents = 0;
+    for (const auto& counts : chunks) {
+        for (size_t d = 0; d < counts.document_tokens.size(); ++d) {
+            tokens += counts.document_tokens[d];
+            vocabulary += counts.document_new_terms[d];
+            vocabulary_growth.observe(tokens, vocabulary);
+        }
+        documents += counts.document_tokens.size();
+    }
+    chunks.clear();
+    
+    timer.reset();
+    build_ranking();
+    double sort_ms = timer.elapsed_ms();
+    
+    std::cout << "Обработано документов: " << documents << std::endl;
+    std::cout << "Подсчёт в " << partitions << " поток(ах): " << total_timer.elapsed_ms() << " мс"
+              << " (разбор " << map_ms << " мс, слияние " << reduce_ms
+              << " мс, сортировка " << sort_ms << " мс)" << std::endl;
+}
+
+void ZipfAnalyzer::analyze_binary_corpus(const std::string& input_file) {
+    std::cout << "Анализ закона Ципфа (двоичный корпус)..." << std::endl;
+    
+    corpus::Reader reader;
+    if (!reader.open(input_file)) {
+        return;
+    }
+    
+    // Считаем по id словаря и переводим в строки один раз в конце
+    const auto& dictionary = reader.get_dictionary();
+    std::vector<uint64_t> counts(dictionary.size(), 0);
+    std::vector<uint32_t> ids;
+    uint64_t tokens = 0;
+    uint64_t vocabulary = 0;
+    
+    for (size_t i = 0; i < reader.size(); ++i) {
+        if (!reader.read_term_ids(i, ids)) continue;
+        
+        for (uint32_t id : ids) {
+            if (counts[id]++ == 0) vocabulary++;
+        }
+        tokens += ids.size();
+        vocabulary_growth.observe(tokens, vocabulary);
+        
+        if ((i + 1) % 1000 == 0) {
+            std::cout << "\rОбработано документов: " << (i + 1) << std::flush;
+        }
+    }
+    
+    for (size_t id = 0; id < counts.size(); ++id) {
+        if (counts[id] > 0) {
+            count_term(dictionary[id], counts[id]);
+        }
+    }
+    
+    std::cout << std::endl;
+    build_ranking();
     std::cout << "Анализ завершён" << std::endl;
+}
+
+bool ZipfAnalyzer::analyze_index(const std::string& index_file) {
+    std::cout << "Анализ закона Ципфа по статистике индекса..." << std::endl;
+    utils::Timer timer;
+    
+    // В оглавлении шардов только список файлов, статистика лежит в шардах
+    if (index_shards::is_manifest(index_file)) {
+        std::cerr << "Файл " << index_file << " — оглавление шардов, секции статистики в нём нет; "
+                  << "укажите файл шарда или индекс, собранный без --shards" << std::endl;
+        return false;
+    }
+    
+    collection = std::make_unique<index_stats::CollectionStatistics>();
+    if (!index_stats::read_from_index(index_file, *collection)) {
+        collection.reset();
+        return false;
+    }
     
-    in.close();
+    ranking.clear();
+    ranking.reserve(collection->terms.size());
+    for (const auto& term : collection->terms) {
+        ranking.push_back({term.term, term.collection_frequency, 0});
+    }
+    std::sort(ranking.begin(), ranking.end(), ranks_before);
+    vocabulary_growth.restore(collection->growth);
+    
+    std::cout << "Анализ завершён за " << timer.elapsed_ms() << " мс" << std::endl;
+    return true;
 }
 
 void ZipfAnalyzer::save_statistics(const std::string& output_file) {
     std::cout << "Сохранение статистики..." << std::endl;
     
-    std::vector<std::pair<std::string, int>> sorted_words(
-        word_frequencies.begin(), word_frequencies.end()
-    );
-    
-    std::sort(sorted_words.begin(), sorted_words.end(),
-              [](const auto& a, const auto& b) {
-                  return a.second > b.second;
-              });
-    
     std::ofstream out(output_file);
     if (!out.is_open()) {
         std::cerr << "Ошибка создания файла: " << output_file << std::endl;
@@ -61,14 +392,26 @@ void ZipfAnalyzer::save_statistics(const std::string& output_file) {
     }
     
     out << "# Статистика Ципфа\n";
-    out << "# Всего слов: " << total_words << "\n";
-    out << "# Уникальных слов: " << word_frequencies.size() << "\n";
-    out << "# Формат: ранг слово частота ранг*частота\n\n";
-    
-    int rank = 1;
-    for (const auto& [word, freq] : sorted_words) {
-        int product = rank * freq;
-        out << rank << " " << word << " " << freq << " " << product << "\n";
+    out << "# Всего слов: " << total_words() << "\n";
+    if (heavy_hitters) {
+        out << "# Уникальных слов (оценка HyperLogLog): " << unique_words()
+            << " ± " << unique_terms.standard_error() * 100.0 << "%\n";
+        out << "# Приближённый режим: " << heavy_hitters->get_capacity()
+            << " счётчиков Space-Saving, частота — верхняя оценка,"
+            << " истинная не меньше частоты минус погрешность\n";
+        out << "# Состав топа гарантирован для первых " << guaranteed_top() << " слов\n";
+        out << "# Формат: ранг слово частота ранг*частота погрешность\n\n";
+    } else {
+        out << "# Уникальных слов: " << unique_words() << "\n";
+        out << "# Формат: ранг слово частота ранг*частота\n\n";
+    }
+    
+    uint64_t rank = 1;
+    for (const auto& term : ranking) {
+        uint64_t product = rank * term.frequency;
+        out << rank << " " << term.word << " " << term.frequency << " " << product;
+        if (heavy_hitters) out << " " << term.error;
+        out << "\n";
         rank++;
     }
     
@@ -79,26 +422,29 @@ void ZipfAnalyzer::save_statistics(const std::string& output_file) {
 void ZipfAnalyzer::print_statistics() const {
     std::cout << "\nСТАТИСТИКА ЗАКОНА ЦИПФА:" << std::endl;
     std::cout << "==============================" << std::endl;
-    std::cout << "Всего слов: " << total_words << std::endl;
-    std::cout << "Уникальных слов: " << word_frequencies.size() << std::endl;
+    std::cout << "Всего слов: " << total_words() << std::endl;
     
-    int hapax = 0;
-    for (const auto& [word, freq] : word_frequencies) {
-        if (freq == 1) hapax++;
+    if (heavy_hitters) {
+        std::cout << "Уникальных слов: ≈" << unique_words()
+                  << " (± " << unique_terms.standard_error() * 100.0 << "%)" << std::endl;
+        std::cout << "Отслеживается слов: " << heavy_hitters->size()
+                  << ", погрешность частоты не больше " << heavy_hitters->max_error() << std::endl;
+        std::cout << "Состав топа гарантирован для первых " << guaranteed_top() << " слов" << std::endl;
+        std::cout << "Память скетчей: "
+                  << (heavy_hitters->memory_bytes() + unique_terms.memory_bytes()) / 1024
+                  << " КБ" << std::endl;
+    } else {
+        std::cout << "Уникальных слов: " << unique_words() << std::endl;
+        
+        int hapax = 0;
+        for (const auto& term : ranking) {
+            if (term.frequency == 1) hapax++;
+        }
+        
+        double hapax_percent = (static_cast<double>(hapax) / ranking.size()) * 100.0;
+        std::cout << "Hapax legomena: " << hapax << " (" << hapax_percent << "%)" << std::endl;
     }
     
-    double hapax_percent = (static_cast<double>(hapax) / word_frequencies.size()) * 100.0;
-    std::cout << "Hapax legomena: " << hapax << " (" << hapax_percent << "%)" << std::endl;
-    
-    std::vector<std::pair<std::string, int>> sorted_words(
-        word_frequencies.begin(), word_frequencies.end()
-    );
-    
-    std::sort(sorted_words.begin(), sorted_words.end(),
-              [](const auto& a, const auto& b) {
-                  return a.second > b.second;
-              });
-    
     std::cout << "\nТоп-10 слов (проверка закона Ципфа):" << std::endl;
     std::cout << std::left << std::setw(6) << "Ранг" 
               << std::setw(20) << "Слово" 
@@ -106,11 +452,12 @@ void ZipfAnalyzer::print_statistics() const {
               << std::setw(15) << "Ранг*Частота" << std::endl;
     std::cout << std::string(51, '-') << std::endl;
     
-    std::vector<int> products;
-    for (int i = 0; i < 10 && i < static_cast<int>(sorted_words.size()); ++i) {
-        int rank = i + 1;
-        const auto& [word, freq] = sorted_words[i];
-        int product = rank * freq;
+    std::vector<uint64_t> products;
+    for (int i = 0; i < 10 && i < static_cast<int>(ranking.size()); ++i) {
+        uint64_t rank = i + 1;
+        const auto& word = ranking[i].word;
+        uint64_t freq = ranking[i].frequency;
+        uint64_t product = rank * freq;
         products.push_back(product);
         
         std::cout << std::left << std::setw(6) << rank
@@ -121,11 +468,11 @@ void ZipfAnalyzer::print_statistics() const {
     
     if (!products.empty()) {
         double avg = 0;
-        for (int p : products) avg += p;
+        for (uint64_t p : products) avg += p;
         avg /= products.size();
         
         double variance = 0;
-        for (int p : products) {
+        for (uint64_t p : products) {
             variance += (p - avg) * (p - avg);
         }
         variance /= products.size();
@@ -140,22 +487,48 @@ void ZipfAnalyzer::print_statistics() const {
 }
 
 void ZipfAnalyzer::print_top_words(int n) const {
-    std::vector<std::pair<std::string, int>> sorted_words(
-        word_frequencies.begin(), word_frequencies.end()
-    );
-    
-    std::sort(sorted_words.begin(), sorted_words.end(),
-              [](const auto& a, const auto& b) {
-                  return a.second > b.second;
-              });
-    
     std::cout << "\nТоп-" << n << " самых частых слов:" << std::endl;
     std::cout << std::string(40, '-') << std::endl;
     
-    for (int i = 0; i < n && i < static_cast<int>(sorted_words.size()); ++i) {
-        const auto& [word, freq] = sorted_words[i];
+    for (int i = 0; i < n && i < static_cast<int>(ranking.size()); ++i) {
         std::cout << std::setw(3) << (i + 1) << ". " 
-                  << std::setw(25) << word 
-                  << std::setw(10) << freq << std::endl;
+                  << std::setw(25) << ranking[i].word 
+                  << std::setw(10) << ranking[i].frequency << std::endl;
+    }
+}
+
+void ZipfAnalyzer::print_fits() const {
+    std::cout << "\nПОДГОНКА ЗАКОНОВ:" << std::endl;
+    std::cout << "==============================" << std::endl;
+    
+    // Ранги берутся равномерно по логарифму, иначе длинный хвост
+    // редких слов перевешивает начало распределения
+    std::vector<std::pair<double, double>> zipf_points;
+    size_t limit = std::min(ranking.size(), guaranteed_top());
+    for (size_t rank = 1; rank <= limit; rank = std::max(rank + 1, rank * 11 / 10)) {
+        zipf_points.push_back({static_cast<double>(rank),
+                               static_cast<double>(ranking[rank - 1].frequency)});
+    }
+    PowerLawFit zipf = fit_power_law(zipf_points);
+    if (zipf.points >= 2) {
+        std::cout << "Ципф: f(r) = " << zipf.coefficient << " / r^" << -zipf.exponent
+                  << "  (R² = " << zipf.r_squared << ", точек: " << zipf.points << ")" << std::endl;
+    } else {
+        std::cout << "Ципф: недостаточно данных" << std::endl;
+    }
+    
+    std::vector<std::pair<double, double>> heaps_points;
+    for (const auto& point : vocabulary_growth.get_points()) {
+        heaps_points.push_back({static_cast<double>(point.tokens),
+                                static_cast<double>(point.vocabulary)});
     }
+    PowerLawFit heaps = fit_power_law(heaps_points);
+    if (heaps.points >= 2) {
+        std::cout << "Хипс: V(n) = " << heaps.coefficient << " * n^" << heaps.exponent
+                  << "  (R² = " << heaps.r_squared << ", точек: " << heaps.points << ")" << std::endl;
+    } else {
+        std::cout << "Хипс: нет данных о росте словаря" << std::endl;
+    }
+    
+    std::cout << "==============================\n" << std::endl;
 }
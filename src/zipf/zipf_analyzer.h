@@ -1,23 +1,77 @@
 #ifndef ZIPF_ANALYZER_H
 #define ZIPF_ANALYZER_H
 
+#include "common/frequency_counter.h"
+#include "common/heavy_hitters.h"
+#include "common/hyperloglog.h"
+#include "index/index_statistics.h"
+#include <memory>
 #include <string>
-#include <map>
+#include <string_view>
 #include <vector>
 
 class ZipfAnalyzer {
+public:
+    struct RankedTerm {
+        std::string_view word;
+        uint64_t frequency;
+        // В приближённом режиме frequency - error <= истинная частота <= frequency
+        uint64_t error;
+    };
+
 private:
-    std::map<std::string, int> word_frequencies;
-    size_t total_words = 0;
+    // Точные частоты, разбитые на разделы по хэшу слова: разделы не
+    // пересекаются, поэтому сливаются и сортируются в разных потоках без блокировок
+    std::vector<utils::FrequencyCounter> word_frequencies;
+    
+    // Приближённый режим: ограниченная память вместо полного словаря
+    std::unique_ptr<utils::SpaceSaving> heavy_hitters;
+    utils::HyperLogLog unique_terms;
+    
+    // Статистика, прочитанная из индекса; ranking ссылается на её строки
+    std::unique_ptr<index_stats::CollectionStatistics> collection;
+    
+    // Слова по убыванию частоты; сортируется один раз после анализа
+    std::vector<RankedTerm> ranking;
+    
+    index_stats::GrowthSampler vocabulary_growth;
+    
+    void count_term(std::string_view term, uint64_t n = 1);
+    void build_ranking();
+    
+    // Точный подсчёт текстового корпуса: файл режется на куски по границам
+    // строк, каждый кусок считается задачей общего пула в локальные таблицы
+    void count_text_parallel(std::string_view text);
+    void analyze_binary_corpus(const std::string& input_file);
+    
+    uint64_t total_words() const;
+    uint64_t unique_words() const;
+    
+    // Длина префикса ranking, который как множество гарантированно
+    // совпадает с точным топом той же длины
+    size_t guaranteed_top() const;
     
 public:
+    // Считать только top_k самых частых слов (Space-Saving), а число
+    // уникальных — оценкой HyperLogLog. Вызывается до analyze_corpus.
+    void enable_approximation(size_t top_k);
+    
+    bool is_approximate() const { return heavy_hitters != nullptr; }
+    
     void analyze_corpus(const std::string& input_file);
     
+    // Берёт частоты и рост словаря из секции статистики index.bin
+    bool analyze_index(const std::string& index_file);
+    
     void save_statistics(const std::string& output_file);
     
     void print_statistics() const;
     
     void print_top_words(int n = 50) const;
+    
+    // Подгонка законов Ципфа f(r) = C / r^s и Хипса V(n) = K * n^b
+    // методом наименьших квадратов в логарифмических координатах
+    void print_fits() const;
 };
 
 #endif
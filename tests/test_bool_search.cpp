@@ -0,0 +1,71 @@
+#include "search/bool_search.h"
+#include <iostream>
+#include <sstream>
+#include <cassert>
+
+int main() {
+    std::cout << "Тестирование BoolSearch..." << std::endl;
+
+    InvertedIndex index;
+    index.add_document(0, "Toyota", "avito", {"toyota", "с", "пробег", "в", "хорош", "состоян"});
+    index.add_document(1, "BMW", "avito", {"bmw", "без", "пробег", "с", "документ"});
+    index.add_document(2, "Lada", "drom", {"lada", "с", "пробег", "пробег", "с"});
+    index.add_document(3, "Audi", "drom", {"audi", "в", "хорош", "состоян", "с", "пробег"});
+
+    ParsedQuery parsed = BoolSearch::parse_query("\"с пробег\" AND toyota OR \"audi\" NOT \"в хорош");
+    assert(parsed.operands.size() == 4 && parsed.operators.size() == 3);
+    assert(parsed.operands[0].is_phrase() && parsed.operands[0].to_string() == "\"с пробег\"");
+    assert(!parsed.operands[2].is_phrase() && parsed.operands[2].terms[0] == "audi");
+    assert(parsed.operands[3].terms == std::vector<std::string>({"в", "хорош"}));
+
+    // Без множеств документов, с ними и с биграммами результат одинаковый
+    for (int mode = 0; mode < 3; ++mode) {
+        if (mode == 2) {
+            size_t bigrams_built = index.build_bigrams(2);
+            assert(bigrams_built > 0);
+        }
+        if (mode > 0) index.build_doc_sets();
+        BoolSearch search(index);
+
+        assert(search.execute_query("пробег").doc_ids == std::vector<int>({0, 1, 2, 3}));
+        assert(search.execute_query("с AND toyota").doc_ids == std::vector<int>({0}));
+        assert(search.execute_query("bmw OR lada").doc_ids == std::vector<int>({1, 2}));
+        assert(search.execute_query("пробег NOT без").doc_ids == std::vector<int>({0, 2, 3}));
+
+        // Фраза: термы подряд и в этом порядке
+        assert(search.execute_query("\"с пробег\"").doc_ids == std::vector<int>({0, 2, 3}));
+        assert(search.execute_query("\"пробег с\"").doc_ids == std::vector<int>({1, 2}));
+        assert(search.execute_query("\"в хорош состоян\"").doc_ids == std::vector<int>({0, 3}));
+        assert(search.execute_query("\"хорош в\"").total_found == 0);
+        assert(search.execute_query("\"с неизвестн\"").total_found == 0);
+        assert(search.execute_query("\"с пробег\" NOT audi").doc_ids == std::vector<int>({0, 2}));
+
+        QueryExplain explain;
+        SearchResult result = search.execute_query("\"с пробег\" AND lada", &explain);
+        assert(result.doc_ids == std::vector<int>({2}));
+        assert(explain.steps.size() == 2);
+        assert(explain.steps[0].operation == "phrase" && explain.steps[0].result_docs == 3);
+        assert(explain.steps[1].operation == "AND" && explain.steps[1].operand_docs == 1);
+        assert(explain.postings_scanned > 0);
+
+        std::ostringstream text;
+        explain.print(text);
+        assert(text.str().find("\"с пробег\"") != std::string::npos);
+        
+        // Фраза из частых термов читается из списка биграммы
+        bool bigram_used = explain.steps[0].plan == "[с пробег]";
+        assert(bigram_used == (mode == 2));
+    }
+    
+    // Пары «хорош в» нет среди биграмм частых термов: фраза пуста без поиска
+    QueryExplain explain;
+    BoolSearch search(index);
+    assert(search.execute_query("\"хорош в\"", &explain).total_found == 0);
+    assert(explain.postings_scanned == 0);
+    
+    search.set_bigrams(false);
+    assert(search.execute_query("\"в хорош состоян\"").doc_ids == std::vector<int>({0, 3}));
+
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}
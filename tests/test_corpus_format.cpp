@@ -0,0 +1,182 @@
+#include "common/corpus_format.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+
+static std::string read_file(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    std::ostringstream content;
+    content << in.rdbuf();
+    return content.str();
+}
+
+static void write_file(const std::string& filename, const std::string& content) {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out.write(content.data(), content.size());
+}
+
+static std::string with_uint64(std::string content, size_t offset, uint64_t value) {
+    std::memcpy(&content[offset], &value, sizeof(value));
+    return content;
+}
+
+static uint64_t get_uint64(const std::string& content, size_t offset) {
+    uint64_t value;
+    std::memcpy(&value, &content[offset], sizeof(value));
+    return value;
+}
+
+int main() {
+    std::cout << "Тестирование двоичного корпуса..." << std::endl;
+    
+    const std::string documents_file = "test_corpus_documents.bin";
+    const std::string terms_file = "test_corpus_terms.bin";
+    
+    assert(corpus::is_binary_name(documents_file));
+    assert(!corpus::is_binary_name("corpus.txt"));
+    
+    // '|' и переводы строк хранятся как есть
+    {
+        corpus::Writer writer(corpus::Kind::DOCUMENTS);
+        bool opened = writer.open(documents_file);
+        assert(opened);
+        writer.add_document({7, "wiki", "Toyota | Camry", "Седан\nбизнес-класса", "http://x/7"});
+        writer.add_document({300, "avito", "Lada", "", ""});
+        bool closed = writer.close();
+        assert(closed);
+    }
+    {
+        assert(corpus::is_binary_file(documents_file));
+        corpus::Reader reader;
+        bool opened = reader.open(documents_file);
+        assert(opened);
+        assert(reader.kind() == corpus::Kind::DOCUMENTS);
+        assert(reader.size() == 2);
+        
+        corpus::DocumentView doc;
+        assert(reader.read_document(1, doc));
+        assert(doc.doc_id == 300 && doc.title == "Lada" && doc.text.empty());
+        assert(reader.read_document(0, doc));
+        assert(doc.doc_id == 7);
+        assert(doc.title == "Toyota | Camry");
+        assert(doc.text == "Седан\nбизнес-класса");
+        assert(doc.url == "http://x/7");
+        assert(!reader.read_document(2, doc));
+        
+        corpus::TermsView terms;
+        assert(!reader.read_terms(0, terms));
+    }
+    
+    // Повторяющиеся термы получают один id
+    {
+        corpus::Writer writer(corpus::Kind::TERMS);
+        bool opened = writer.open(terms_file);
+        assert(opened);
+        std::vector<std::string> first = {"toyota", "седан", "toyota"};
+        writer.add_terms(1, "wiki", "Toyota", first);
+        
+        corpus::TermsBatch batch;
+        std::vector<std::string_view> second = {"седан", "lada"};
+        batch.add(2, "avito", "Lada", second);
+        batch.add(3, "avito", "Пусто", std::vector<std::string_view>());
+        writer.add_batch(batch);
+        bool closed = writer.close();
+        assert(closed);
+    }
+    {
+        corpus::Reader reader;
+        bool opened = reader.open(terms_file);
+        assert(opened);
+        assert(reader.kind() == corpus::Kind::TERMS);
+        assert(reader.size() == 3);
+        assert(reader.get_dictionary().size() == 3);
+        
+        corpus::TermsView doc;
+        assert(reader.read_terms(0, doc));
+        assert(doc.doc_id == 1 && doc.source == "wiki");
+        assert(doc.terms.size() == 3 && doc.terms[0] == "toyota" && doc.terms[2] == "toyota");
+        assert(reader.read_terms(1, doc));
+        assert(doc.terms.size() == 2 && doc.terms[0] == "седан" && doc.terms[1] == "lada");
+        assert(reader.read_terms(2, doc));
+        assert(doc.doc_id == 3 && doc.terms.empty());
+        
+        std::vector<uint32_t> ids;
+        assert(reader.read_term_ids(0, ids));
+        assert(ids.size() == 3 && ids[0] == ids[2]);
+    }
+    
+    // Обрезанный или повреждённый файл отвергается при открытии, битые
+    // смещения записей — при чтении, без выхода за отображение.
+    // Заголовок: магия 8, версия 4, вид 4, затем uint64 число документов,
+    // число термов, смещение словаря и смещение таблицы смещений
+    {
+        const std::string corrupt_file = "test_corpus_corrupt.bin";
+        const std::string valid = read_file(terms_file);
+        const size_t DOCUMENTS_COUNT = 16, TERMS_COUNT = 24, DICTIONARY = 32, OFFSETS = 40;
+        const uint64_t offsets_offset = get_uint64(valid, OFFSETS);
+        assert(offsets_offset + 3 * sizeof(uint64_t) == valid.size());
+        
+        std::vector<std::string> broken = {
+            valid.substr(0, 20),
+            valid.substr(0, valid.size() - 1),
+            with_uint64(valid, OFFSETS, valid.size() + 100),
+            with_uint64(valid, OFFSETS, ~0ull),
+            with_uint64(valid, DICTIONARY, valid.size() + 1),
+            with_uint64(valid, DICTIONARY, 8),
+            with_uint64(valid, DOCUMENTS_COUNT, ~0ull / 4),
+            with_uint64(valid, TERMS_COUNT, ~0ull),
+            with_uint64(valid, TERMS_COUNT, 4),
+        };
+        corpus::Reader reader;
+        for (const auto& content : broken) {
+            write_file(corrupt_file, content);
+            bool opened = reader.open(corrupt_file);
+            assert(!opened);
+        }
+        
+        corpus::TermsView doc;
+        const uint64_t bad_offsets[] = {0, 47, offsets_offset, ~0ull / 2};
+        for (uint64_t bad_offset : bad_offsets) {
+            write_file(corrupt_file, with_uint64(valid, offsets_offset, bad_offset));
+            bool opened = reader.open(corrupt_file);
+            assert(opened);
+            assert(!reader.read_terms(0, doc));
+            assert(reader.read_terms(2, doc) && doc.doc_id == 3);
+        }
+        
+        // Конец записи раньше её начала
+        uint64_t second_begin = get_uint64(valid, offsets_offset + 8);
+        write_file(corrupt_file, with_uint64(valid, offsets_offset, second_begin + 1));
+        bool opened = reader.open(corrupt_file);
+        assert(opened);
+        assert(!reader.read_terms(0, doc));
+        assert(reader.read_terms(1, doc) && doc.doc_id == 2);
+        
+        std::remove(corrupt_file.c_str());
+    }
+    
+    // Текстовая строка tokens.txt разбирается в те же view
+    corpus::TermsView line_doc;
+    assert(corpus::parse_terms_line("42|wiki|Toyota|toyota седан", line_doc));
+    assert(line_doc.doc_id == 42 && line_doc.title == "Toyota");
+    assert(line_doc.terms.size() == 2 && line_doc.terms[1] == "седан");
+    assert(!corpus::parse_terms_line("нет разделителей", line_doc));
+    
+    std::string line;
+    corpus::append_terms_line(line, 5, "wiki", "A|B", line_doc.terms);
+    assert(line == "5|wiki|A B|toyota седан\n");
+    
+    assert(!corpus::is_binary_file("test_corpus_missing.bin"));
+    
+    std::remove(documents_file.c_str());
+    std::remove(terms_file.c_str());
+    
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include "crawler/dedup.h"
+#include "common/thread_pool.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+// Текст из слов first..first+count-1; слова с номерами из replaced заменены другими
+static std::string make_text(int first, int count, const std::vector<int>& replaced = {}) {
+    std::string text;
+    for (int i = first; i < first + count; ++i) {
+        bool other = std::find(replaced.begin(), replaced.end(), i) != replaced.end();
+        if (!text.empty()) text += ' ';
+        text += (other ? "другое" : "слово") + std::to_string(i);
+    }
+    return text;
+}
+
+// Представители всех документов при обработке пакетами по batch_size
+static std::vector<int> run_batches(const std::vector<utils::Document>& docs, size_t batch_size) {
+    NearDuplicateFilter filter(NearDuplicateFilter::Options{});
+    std::vector<int> all;
+    std::vector<int> representatives;
+    for (size_t start = 0; start < docs.size(); start += batch_size) {
+        size_t stop = std::min(docs.size(), start + batch_size);
+        std::vector<utils::Document> batch(docs.begin() + start, docs.begin() + stop);
+        filter.filter(batch, representatives);
+        assert(representatives.size() == batch.size());
+        all.insert(all.end(), representatives.begin(), representatives.end());
+    }
+    return all;
+}
+
+int main() {
+    std::cout << "Тестирование NearDuplicateFilter..." << std::endl;
+    utils::ThreadPool::configure_shared(2);
+    
+    const std::string base = make_text(0, 80);
+    // Каждое четвёртое слово другое: общих шинглов из трёх слов почти нет
+    const std::string similar = make_text(0, 80, {1, 5, 9, 13, 17, 21, 25, 29, 33, 37, 41, 45, 49,
+                                                  53, 57, 61, 65, 69, 73, 77});
+    
+    std::vector<utils::Document> docs = {
+        {10, "avito", "Оригинал", base, ""},
+        // Точная копия
+        {11, "avito", "Копия", base, ""},
+        // Последнее слово другое: сходство шинглов около 0.97, выше порога 0.8
+        {12, "drom", "Почти копия", make_text(0, 80, {79}), ""},
+        // Ниже порога — остаётся
+        {13, "drom", "Похожий", similar, ""},
+        {14, "wiki", "Другой", make_text(1000, 80), ""},
+        // Копия почти-копии указывает на первый документ кластера:
+        // сам дубликат в принятые не попадает
+        {15, "wiki", "Ещё копия", make_text(0, 80, {79}), ""},
+        // Документ ниже порога сам стал представителем
+        {16, "wiki", "Копия похожего", similar, ""},
+        // Без слов — не сравнивается и не принимается
+        {17, "wiki", "Пусто", "... !!!", ""},
+        {18, "wiki", "Пусто", "... !!!", ""},
+    };
+    const std::vector<int> expected = {-1, 10, 10, -1, -1, 10, 13, -1, -1};
+    
+    NearDuplicateFilter filter(NearDuplicateFilter::Options{});
+    std::vector<int> representatives;
+    filter.filter(docs, representatives);
+    assert(representatives == expected);
+    assert(filter.get_statistics().checked == docs.size());
+    assert(filter.get_statistics().duplicates == 4);
+    
+    // Внутри пакета и между пакетами результат одинаковый
+    for (size_t batch_size : {1, 2, 3, 4, 100}) {
+        assert(run_batches(docs, batch_size) == expected);
+    }
+    
+    // Более строгий порог оставляет почти-копию, но не точную копию
+    NearDuplicateFilter::Options strict;
+    strict.threshold = 1.0;
+    NearDuplicateFilter strict_filter(strict);
+    std::vector<utils::Document> pair = {docs[0], docs[1], docs[2]};
+    strict_filter.filter(pair, representatives);
+    assert(representatives == std::vector<int>({-1, 10, -1}));
+    
+    // Порог из командной строки; разбор вне assert, он пишет в threshold
+    double threshold = 0.5;
+    bool parsed = NearDuplicateFilter::parse_threshold("0.9", threshold);
+    assert(parsed && threshold == 0.9);
+    parsed = NearDuplicateFilter::parse_threshold("1", threshold);
+    assert(parsed && threshold == 1.0);
+    for (const char* bad : {"0", "1.5", "-0.2", "abc", "0.8x", "nan", ""}) {
+        parsed = NearDuplicateFilter::parse_threshold(bad, threshold);
+        assert(!parsed);
+    }
+    assert(threshold == 1.0);
+    
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}
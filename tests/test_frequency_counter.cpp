@@ -0,0 +1,75 @@
+#include "common/frequency_counter.h"
+#include <iostream>
+#include <string>
+#include <cassert>
+
+int main() {
+    std::cout << "Тестирование FrequencyCounter..." << std::endl;
+    
+    utils::FrequencyCounter counter;
+    
+    for (int i = 0; i < 5000; ++i) {
+        counter.add("term" + std::to_string(i % 1000));
+    }
+    counter.add("toyota", 10);
+    counter.add("bmw", 10);
+    counter.add("автомобиль", 7);
+    
+    assert(counter.size() == 1003);
+    assert(counter.total() == 5027);
+    assert(counter.count("term42") == 5);
+    assert(counter.count(std::string("автомобиль")) == 7);
+    assert(counter.count("audi") == 0);
+    
+    auto top = counter.top_n(3);
+    assert(top.size() == 3);
+    assert(top[0].first == "bmw" && top[0].second == 10);
+    assert(top[1].first == "toyota");
+    assert(top[2].first == "автомобиль");
+    
+    assert(counter.sorted().size() == counter.size());
+    
+    utils::FrequencyCounter other;
+    other.add("toyota", 5);
+    other.add("lada");
+    counter.merge(other);
+    assert(counter.count("toyota") == 15);
+    assert(counter.count("lada") == 1);
+    assert(counter.size() == 1004);
+    assert(counter.top_n(1)[0].first == "toyota");
+    
+    uint32_t hash = utils::FrequencyCounter::hash_key("lada");
+    counter.add_hashed("lada", hash, 2);
+    assert(counter.count_hashed("lada", hash) == 3 && counter.count("lada") == 3);
+    
+    // После перемещения исходный счётчик пуст и снова заполняется,
+    // не задевая строки нового владельца
+    utils::FrequencyCounter moved(std::move(counter));
+    assert(moved.size() == 1004 && moved.total() == 5035);
+    assert(counter.size() == 0 && counter.total() == 0);
+    assert(counter.count("toyota") == 0 && counter.top_n(5).empty());
+    counter.add("audi", 4);
+    assert(counter.size() == 1 && counter.count("audi") == 4);
+    assert(moved.count("toyota") == 15 && moved.count("audi") == 0);
+    
+    utils::FrequencyCounter assigned;
+    assigned.add("kia");
+    assigned = std::move(moved);
+    assert(assigned.count("toyota") == 15 && assigned.count("kia") == 0);
+    assert(moved.size() == 0 && moved.total() == 0);
+    moved.add("kia");
+    assert(moved.count("kia") == 1 && assigned.count("kia") == 0);
+    
+    // Новая строка в исходном пуле не пишется в блок, который теперь чужой
+    utils::StringPool pool(64);
+    std::string_view first = pool.store("abc");
+    utils::StringPool taken(std::move(pool));
+    assert(pool.bytes_used() == 0 && taken.bytes_used() == 3);
+    pool.store("xyz");
+    assert(first == "abc");
+    std::string_view second = taken.store("def");
+    assert(first == "abc" && second == "def");
+    
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}
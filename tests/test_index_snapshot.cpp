@@ -0,0 +1,91 @@
+#include "search/index_snapshot.h"
+#include "search/bool_search.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <cassert>
+
+static void write_index(const std::string& filename, const std::vector<std::string>& brands) {
+    InvertedIndex index;
+    for (int doc = 0; doc < static_cast<int>(brands.size()); ++doc) {
+        index.add_document(doc, brands[doc], "avito", {brands[doc], "с", "пробег"});
+    }
+    // Как build_index: пишем рядом и подменяем файл целиком
+    index.save_to_file(filename + ".tmp");
+    std::rename((filename + ".tmp").c_str(), filename.c_str());
+}
+
+int main() {
+    std::cout << "Тестирование IndexSnapshotManager..." << std::endl;
+    
+    const std::string index_file = "test_index_snapshot.bin";
+    write_index(index_file, {"toyota", "lada"});
+    
+    IndexSnapshotManager snapshots(index_file);
+    bool loaded = snapshots.reload();
+    assert(loaded);
+    assert(snapshots.get_version() == 1);
+    
+    // Читатель держит первую версию
+    auto first = snapshots.snapshot();
+    assert(first->get_documents_count() == 2);
+    
+    // Битый файл не загружается, остаётся прежний снапшот
+    {
+        std::ofstream broken(index_file, std::ios::binary | std::ios::trunc);
+        broken << "не индекс";
+    }
+    bool reloaded = snapshots.reload();
+    assert(!reloaded);
+    assert(snapshots.get_version() == 1);
+    assert(snapshots.snapshot() == first);
+    
+    // Нет файла — тоже остаёмся на старой версии
+    std::remove(index_file.c_str());
+    reloaded = snapshots.reload();
+    assert(!reloaded);
+    assert(snapshots.snapshot() == first);
+    
+    // Новый индекс подменяет текущий, а удержанный снапшот продолжает отвечать по-старому
+    write_index(index_file, {"bmw", "audi", "bmw"});
+    reloaded = snapshots.reload();
+    assert(reloaded);
+    assert(snapshots.get_version() == 2);
+    
+    auto second = snapshots.snapshot();
+    assert(second != first);
+    assert(second->get_documents_count() == 3);
+    assert(BoolSearch(*second).execute_query("bmw").doc_ids == std::vector<int>({0, 2}));
+    assert(BoolSearch(*second).execute_query("toyota").total_found == 0);
+    
+    assert(first->get_documents_count() == 2);
+    assert(BoolSearch(*first).execute_query("toyota").doc_ids == std::vector<int>({0}));
+    assert(BoolSearch(*first).execute_query("bmw").total_found == 0);
+    
+    // Наблюдатель не печатает сам, а складывает сообщения для основного цикла
+    snapshots.start_watching(20);
+    write_index(index_file, {"lada"});
+    std::vector<std::string> messages;
+    for (int attempt = 0; attempt < 250 && messages.empty(); ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        messages = snapshots.take_messages();
+    }
+    snapshots.stop_watching();
+    
+    assert(messages.size() == 1);
+    assert(messages[0].find("Обнаружен новый индекс") != std::string::npos);
+    assert(messages[0].find("Индекс версии 3") != std::string::npos);
+    assert(snapshots.get_version() == 3);
+    assert(snapshots.snapshot()->get_documents_count() == 1);
+    assert(snapshots.take_messages().empty());
+    assert(second->get_documents_count() == 3);
+    
+    std::remove(index_file.c_str());
+    
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}
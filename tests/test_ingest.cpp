@@ -0,0 +1,105 @@
+#include "ingest/ingest_pipeline.h"
+#include "crawler/crawler.h"
+#include "tokenizer/tokenizer.h"
+#include "stemmer/stemmer.h"
+#include "common/thread_pool.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cassert>
+
+// Индексы совпадают по документам, термам, постингам и позициям
+static void assert_same_index(const InvertedIndex& a, const InvertedIndex& b) {
+    assert(a.get_documents_count() == b.get_documents_count());
+    for (const auto& [doc_id, meta] : a.get_documents()) {
+        const DocumentMeta* other = b.get_document_meta(doc_id);
+        assert(other != nullptr);
+        assert(other->doc_id == meta.doc_id);
+        assert(other->title == meta.title);
+        assert(other->source == meta.source);
+        assert(other->length == meta.length);
+    }
+    
+    assert(a.get_index_size() == b.get_index_size());
+    for (const auto& [term, postings] : a.get_terms()) {
+        const auto* other = b.get_postings_with_positions(term);
+        assert(other != nullptr && other->size() == postings.size());
+        for (size_t i = 0; i < postings.size(); ++i) {
+            assert((*other)[i].doc_id == postings[i].doc_id);
+            assert((*other)[i].positions == postings[i].positions);
+        }
+    }
+}
+
+int main() {
+    std::cout << "Тестирование IngestPipeline..." << std::endl;
+    
+    // Небольшой корпус: перевод строки в тексте, короткий текст, который
+    // crawler отклоняет, и объект без заголовка, который документом не считается
+    const std::string json_file = "test_ingest.json";
+    {
+        std::ofstream out(json_file);
+        out << R"([
+            {"title": "Toyota Camry", "source": "avito", "url": "http://x/1",
+             "text": "Продаётся Toyota Camry 2018 года, пробег 45000 км, один владелец.\nТорг уместен."},
+            {"title": "BMW X5", "source": "avito", "url": "http://x/2",
+             "text": "BMW X5 в отличном состоянии, полный привод, кожаный салон, пробег 80000 км."},
+            {"title": "Коротко", "source": "drom", "url": "http://x/3", "text": "Lada"},
+            {"source": "drom", "text": "Объявление без заголовка не считается документом корпуса."},
+            {"title": "Lada Vesta", "source": "drom", "url": "http://x/4",
+             "text": "Lada Vesta SW Cross, пробег небольшой, машина на гарантии, два комплекта резины."},
+            {"title": "Toyota RAV4", "source": "wiki", "url": "http://x/5",
+             "text": "Toyota RAV4 — компактный кроссовер японской компании Toyota, выпускается с 1994 года."},
+            {"title": "Audi A6", "source": "wiki", "url": "http://x/6",
+             "text": "Audi A6 — автомобиль бизнес-класса, выпускаемый немецкой компанией Audi с 1994 года."}
+        ])";
+    }
+    
+    // Цепочка отдельных стадий: crawler -> tokenizer -> stemmer -> build_index
+    const std::string corpus_file = "test_ingest_corpus.txt";
+    const std::string tokens_file = "test_ingest_tokens.txt";
+    const std::string stems_file = "test_ingest_stems.txt";
+    
+    utils::ThreadPool::configure_shared(2);
+    {
+        Crawler crawler;
+        std::ofstream corpus(corpus_file);
+        bool crawled = crawler.crawl_stream(json_file, [&corpus](utils::Document& doc) {
+            utils::write_document_line(corpus, doc);
+        });
+        assert(crawled);
+        assert(crawler.get_failed_count() == 1);
+    }
+    Tokenizer tokenizer;
+    tokenizer.tokenize_corpus(corpus_file, tokens_file);
+    Stemmer stemmer;
+    stemmer.stem_corpus(tokens_file, stems_file);
+    
+    InvertedIndex staged;
+    staged.build_from_file(stems_file);
+    assert(staged.get_documents_count() == 5);
+    
+    // Сквозная загрузка при разном числе потоков и размере пакета
+    for (int threads : {1, 4}) {
+        IngestPipeline::Options options;
+        options.threads = threads;
+        options.batch_size = 2;
+        options.max_batches_in_flight = 2;
+        
+        IngestPipeline pipeline(options);
+        InvertedIndex ingested;
+        bool ok = pipeline.run({json_file}, ingested);
+        assert(ok);
+        assert_same_index(staged, ingested);
+    }
+    
+    std::remove(json_file.c_str());
+    std::remove(corpus_file.c_str());
+    std::remove(tokens_file.c_str());
+    std::remove(stems_file.c_str());
+    
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}
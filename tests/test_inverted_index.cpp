@@ -0,0 +1,115 @@
+#include "index/inverted_index.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cassert>
+
+namespace {
+
+std::vector<int> external_ids(const InvertedIndex& index, const std::string& term) {
+    std::vector<int> ids;
+    for (int doc_id : index.get_postings(term)) {
+        ids.push_back(index.get_document_meta(doc_id)->doc_id);
+    }
+    return ids;
+}
+
+}
+
+int main() {
+    std::cout << "Тестирование индекса..." << std::endl;
+    
+    const std::string index_file = "test_inverted_index.bin";
+    
+    InvertedIndex index;
+    index.add_document(10, "Toyota Camry", "wiki", {"toyota", "camry", "седан", "toyota"});
+    index.add_document(11, "Lada Vesta", "avito", {"lada", "vesta", "седан"});
+    index.add_document(12, "Toyota Corolla", "avito", {"toyota", "corolla"});
+    index.add_document(13, "Lada Niva", "wiki", {"lada", "niva", "внедорожник"});
+    
+    // Внешние идентификаторы переживают перенумерацию
+    doc_reorder::Options options;
+    options.mode = doc_reorder::Mode::SOURCE_TITLE;
+    index.reorder_documents(options);
+    
+    assert(index.get_documents_count() == 4);
+    assert(index.get_document_meta(0)->doc_id == 11);
+    assert(index.get_document_meta(0)->source == "avito");
+    assert(index.get_document_meta(3)->doc_id == 10);
+    assert(index.get_postings("toyota") == std::vector<int>({1, 3}));
+    assert(external_ids(index, "седан") == std::vector<int>({11, 10}));
+    
+    index.save_to_file(index_file);
+    
+    InvertedIndex loaded;
+    bool load_ok = loaded.load_from_file(index_file);
+    assert(load_ok);
+    assert(loaded.get_documents_count() == 4);
+    assert(loaded.get_index_size() == index.get_index_size());
+    assert(external_ids(loaded, "toyota") == std::vector<int>({12, 10}));
+    
+    const auto* postings = loaded.get_postings_with_positions("toyota");
+    assert(postings && postings->size() == 2);
+    assert(postings->back().positions == std::vector<int>({0, 3}));
+    
+    const DocumentMeta* meta = loaded.get_document_meta(3);
+    assert(meta->title == "Toyota Camry" && meta->length == 4);
+    
+    // Секция статистики читается без загрузки остального индекса
+    index_stats::CollectionStatistics stats;
+    bool stats_read = index_stats::read_from_index(index_file, stats);
+    assert(stats_read);
+    assert(stats.documents == 4 && stats.tokens == 12);
+    assert(stats.terms.size() == loaded.get_index_size());
+    assert(stats.terms.front().term == "camry");
+    for (const auto& term : stats.terms) {
+        if (term.term == "toyota") {
+            assert(term.collection_frequency == 3 && term.document_frequency == 2);
+        }
+    }
+    assert(!stats.growth.empty());
+    assert(stats.growth.back().tokens == 12 && stats.growth.back().vocabulary == 8);
+    
+    // Перенумерация разбиением сохраняет содержимое постингов
+    InvertedIndex bisected;
+    for (int doc = 0; doc < 200; ++doc) {
+        std::string brand = doc % 2 ? "lada" : "toyota";
+        bisected.add_document(doc, brand, "wiki", {brand, "модель" + std::to_string(doc % 7)});
+    }
+    options.mode = doc_reorder::Mode::BISECTION;
+    bisected.reorder_documents(options);
+    std::vector<int> lada = external_ids(bisected, "lada");
+    assert(lada.size() == 100);
+    for (int doc_id : lada) assert(doc_id % 2 == 1);
+    
+    // Биграммы частых термов сохраняются отдельной секцией
+    size_t bigrams_built = bisected.build_bigrams(2);
+    assert(bigrams_built == 14);
+    assert(bisected.get_bigram_postings(InvertedIndex::bigram_key("модель1", "lada")) == nullptr);
+    bisected.save_to_file(index_file);
+    InvertedIndex with_bigrams;
+    load_ok = with_bigrams.load_from_file(index_file);
+    assert(load_ok);
+    assert(with_bigrams.get_bigrams_count() == 14 && with_bigrams.get_bigram_min_df() == 2);
+    postings = with_bigrams.get_bigram_postings(InvertedIndex::bigram_key("lada", "модель1"));
+    assert(postings && postings->size() == 15);
+    assert(postings->front().positions == std::vector<int>({0}));
+    
+    // Обрезанный файл не загружается
+    {
+        std::ifstream in(index_file, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(index_file, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), data.size() - 5);
+    }
+    InvertedIndex truncated;
+    load_ok = truncated.load_from_file(index_file);
+    assert(!load_ok);
+    assert(truncated.get_documents_count() == 0);
+    
+    std::remove(index_file.c_str());
+    
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}
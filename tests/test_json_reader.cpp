@@ -0,0 +1,65 @@
+#include "common/json_reader.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cassert>
+
+std::vector<utils::Document> read_all(const std::string& json, bool& ok) {
+    std::vector<utils::Document> docs;
+    utils::JsonCorpusReader reader;
+    ok = reader.read(json, [&docs](utils::Document& doc) {
+        docs.push_back(doc);
+    });
+    return docs;
+}
+
+int main() {
+    std::cout << "Тестирование JsonCorpusReader..." << std::endl;
+    
+    bool ok;
+    
+    // Кавычки и переводы строк внутри текста, поля в любом порядке,
+    // вложенные значения пропускаются
+    auto docs = read_all(R"([
+        {"title": "Toyota \"Camry\"", "source": "wiki",
+         "meta": {"tags": ["a", "}"], "rank": 1.5, "draft": false},
+         "text": "строка\nвторая \\ конец", "url": "http:\/\/x\/1"},
+        {"content": "Lada", "title": "ВАЗ", "extra": null}
+    ])", ok);
+    assert(ok);
+    assert(docs.size() == 2);
+    assert(docs[0].doc_id == 0);
+    assert(docs[0].title == "Toyota \"Camry\"");
+    assert(docs[0].source == "wiki");
+    assert(docs[0].text == "строка\nвторая \\ конец");
+    assert(docs[0].url == "http://x/1");
+    assert(docs[1].doc_id == 1);
+    assert(docs[1].text == "Lada");
+    assert(docs[1].source.empty());
+    
+    // \uXXXX, включая суррогатную пару и одиночный суррогат
+    docs = read_all(R"({"title": "Авто \ud83d\ude97 \udc00"})", ok);
+    assert(ok);
+    assert(docs.size() == 1);
+    assert(docs[0].title == "Авто \xF0\x9F\x9A\x97 \xEF\xBF\xBD");
+    
+    // JSON Lines и длинная строка, которая проходит блоками по 16 байт
+    std::string long_text(1000, 'x');
+    docs = read_all("{\"title\": \"a\"}\n{\"title\": \"" + long_text + "\\\"y\"}\n", ok);
+    assert(ok);
+    assert(docs.size() == 2);
+    assert(docs[1].title == long_text + "\"y");
+    
+    // Ошибка разбора: документы до неё уже отданы
+    utils::JsonCorpusReader reader;
+    size_t seen = 0;
+    ok = reader.read(R"([{"title": "ok"}, {"title": "broken)", [&seen](utils::Document&) {
+        seen++;
+    });
+    assert(!ok);
+    assert(seen == 1);
+    assert(!reader.get_error().empty());
+    
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}
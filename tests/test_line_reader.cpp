@@ -0,0 +1,65 @@
+#include "common/line_reader.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cassert>
+
+int main() {
+    std::cout << "Тестирование LineReader..." << std::endl;
+    
+    std::string_view fields[4];
+    assert(utils::split_fields("1|wiki|Toyota|toyota седан", '|', fields, 4) == 4);
+    assert(fields[0] == "1" && fields[2] == "Toyota" && fields[3] == "toyota седан");
+    
+    // Последнее поле забирает остаток вместе с разделителями
+    assert(utils::split_fields("a|b|c|d|e", '|', fields, 3) == 3);
+    assert(fields[2] == "c|d|e");
+    assert(utils::split_fields("a||", '|', fields, 4) == 3);
+    assert(fields[1].empty() && fields[2].empty());
+    assert(utils::split_fields("", '|', fields, 4) == 1);
+    
+    std::vector<std::string_view> terms;
+    utils::for_each_field("  toyota  седан lada ", ' ', [&terms](std::string_view term) {
+        terms.push_back(term);
+    });
+    assert(terms.size() == 3 && terms[0] == "toyota" && terms[1] == "седан");
+    
+    // Куски покрывают текст без пропусков и режутся только после '\n'
+    std::string_view text = "aaaa\nbb\ncccccc\nd\n";
+    auto chunks = utils::split_by_lines(text, 3);
+    std::string joined;
+    for (auto chunk : chunks) {
+        assert(!chunk.empty() && chunk.back() == '\n');
+        joined += chunk;
+    }
+    assert(joined == text && chunks.size() <= 3);
+    assert(utils::split_by_lines("one line", 4).size() == 1);
+    assert(utils::split_by_lines("", 4).empty());
+    
+    const std::string filename = "test_line_reader.txt";
+    {
+        std::ofstream out(filename);
+        out << "first\n\nthird|x\nlast without newline";
+    }
+    
+    utils::LineReader reader;
+    bool opened = reader.open(filename);
+    assert(opened);
+    
+    std::string_view line;
+    assert(reader.next(line) && line == "first");
+    assert(reader.next(line) && line.empty());
+    
+    std::vector<std::string_view> lines;
+    assert(reader.next_chunk(lines, 10, 1 << 20));
+    assert(lines.size() == 2 && lines[0] == "third|x" && lines[1] == "last without newline");
+    assert(!reader.next(line));
+    assert(!reader.next_chunk(lines, 10, 1 << 20));
+    
+    std::remove(filename.c_str());
+    
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include "common/ordered_pipeline.h"
+#include <iostream>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cassert>
+
+int main() {
+    std::cout << "Тестирование run_ordered_pipeline..." << std::endl;
+
+    const int CHUNKS = 500;
+    const size_t MAX_IN_FLIGHT = 8;
+
+    for (int threads : {1, 4}) {
+        utils::ThreadPool pool(threads);
+
+        int next_input = 0;
+        int max_in_flight = 0;
+        std::vector<int> written;
+        std::mutex finished_mutex;
+        std::vector<int> finished;
+
+        utils::run_ordered_pipeline<int, std::vector<int>>(
+            pool, MAX_IN_FLIGHT,
+            [&](int& input) {
+                if (next_input == CHUNKS) return false;
+                // Прочитанные, но ещё не записанные порции
+                int in_flight = next_input - static_cast<int>(written.size());
+                if (in_flight > max_in_flight) max_in_flight = in_flight;
+                input = next_input++;
+                return true;
+            },
+            [&](int, int& input, std::vector<int>& output) {
+                // Каждая десятая порция медленная: следующие за ней
+                // заканчиваются раньше и ждут в буфере
+                if (input % 10 == 0) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(input == 0 ? 20 : 1));
+                }
+                output.assign(input % 5 + 1, input);
+                std::lock_guard<std::mutex> lock(finished_mutex);
+                finished.push_back(input);
+            },
+            [&](std::vector<int>& output) {
+                assert(!output.empty());
+                for (int value : output) assert(value == output[0]);
+                written.push_back(output[0]);
+            });
+
+        // Запись строго в порядке чтения, каждая порция ровно один раз
+        assert(written.size() == static_cast<size_t>(CHUNKS));
+        for (int i = 0; i < CHUNKS; ++i) assert(written[i] == i);
+
+        // Без ограничения читатель ушёл бы вперёд, пока первая порция спит
+        assert(max_in_flight <= static_cast<int>(MAX_IN_FLIGHT));
+
+        // Порции действительно завершались не по порядку
+        bool reordered = false;
+        for (int i = 0; i < CHUNKS; ++i) {
+            if (finished[i] != i) reordered = true;
+        }
+        assert(reordered == (threads > 1));
+    }
+
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include "index/roaring.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <vector>
+#include <cassert>
+
+namespace {
+
+std::vector<int> random_ids(std::mt19937& rng, int limit, double density) {
+    std::bernoulli_distribution pick(density);
+    std::vector<int> ids;
+    for (int id = 0; id < limit; ++id) {
+        if (pick(rng)) ids.push_back(id);
+    }
+    return ids;
+}
+
+std::vector<int> range(int begin, int end) {
+    std::vector<int> ids;
+    for (int id = begin; id < end; ++id) ids.push_back(id);
+    return ids;
+}
+
+void check_operations(const std::vector<int>& a, const std::vector<int>& b) {
+    RoaringBitmap ra = RoaringBitmap::from_sorted(a);
+    RoaringBitmap rb = RoaringBitmap::from_sorted(b);
+    assert(ra.to_vector() == a);
+    assert(ra.cardinality() == a.size());
+    
+    // Префикс из первых limit номеров, через границы контейнеров
+    for (size_t limit : {size_t(1), size_t(100), a.size() / 2 + 1, a.size() + 5}) {
+        std::vector<int> prefix(a.begin(), a.begin() + std::min(limit, a.size()));
+        assert(ra.to_vector(limit) == prefix);
+    }
+
+    std::vector<int> expected;
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+    assert(RoaringBitmap::intersect(ra, rb).to_vector() == expected);
+
+    expected.clear();
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+    RoaringBitmap united = RoaringBitmap::unite(ra, rb);
+    assert(united.to_vector() == expected);
+    assert(united.cardinality() == expected.size());
+
+    expected.clear();
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expected));
+    assert(RoaringBitmap::subtract(ra, rb).to_vector() == expected);
+}
+
+}
+
+int main() {
+    std::cout << "Тестирование Roaring-множеств..." << std::endl;
+
+    std::mt19937 rng(42);
+    const int limit = 4 * 65536;
+
+    std::vector<int> sparse = random_ids(rng, limit, 0.01);
+    std::vector<int> dense = random_ids(rng, limit, 0.5);
+    std::vector<int> runs = range(1000, 90000);
+    std::vector<int> tail = range(150000, 150010);
+
+    // Контейнер выбирается по плотности блока
+    assert(RoaringBitmap::from_sorted(sparse).get_statistics().arrays == 4);
+    assert(RoaringBitmap::from_sorted(dense).get_statistics().bitmaps == 4);
+    RoaringBitmap::Statistics run_stats = RoaringBitmap::from_sorted(runs).get_statistics();
+    assert(run_stats.runs == 2 && run_stats.bytes == 8);
+
+    const std::vector<int>* sets[] = {&sparse, &dense, &runs, &tail};
+    for (const auto* a : sets) {
+        for (const auto* b : sets) {
+            check_operations(*a, *b);
+        }
+    }
+    check_operations(dense, std::vector<int>());
+    check_operations(std::vector<int>(), sparse);
+
+    RoaringBitmap set = RoaringBitmap::from_sorted(runs);
+    assert(set.contains(1000) && set.contains(65535) && set.contains(65536) && set.contains(89999));
+    assert(!set.contains(999) && !set.contains(90000));
+
+    // Повторы во входе не дублируются
+    assert(RoaringBitmap::from_sorted({3, 3, 5}).to_vector() == std::vector<int>({3, 5}));
+
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}
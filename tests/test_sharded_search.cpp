@@ -0,0 +1,120 @@
+#include "search/sharded_search.h"
+#include "common/thread_pool.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cassert>
+
+int main() {
+    std::cout << "Тестирование шардированного поиска..." << std::endl;
+    utils::ThreadPool::configure_shared(3);
+    
+    const std::string manifest = "test_sharded_search.bin";
+    const char* brands[] = {"toyota", "lada", "bmw"};
+    
+    InvertedIndex index;
+    for (int doc = 0; doc < 100; ++doc) {
+        std::string brand = brands[doc % 3];
+        std::vector<std::string> terms = {brand, "с", "пробег"};
+        if (doc % 4 == 0) terms = {"без", "пробег", brand};
+        index.add_document(doc, brand + " " + std::to_string(doc), "avito", terms);
+    }
+    
+    // Три диапазона документов, как их пишет build_index --shards
+    std::vector<index_shards::Shard> ranges = {{"", 0, 40}, {"", 40, 70}, {"", 70, 100}};
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        ranges[i].file = index_shards::shard_file_name(manifest, i);
+        InvertedIndex part = index.extract_documents(ranges[i].first_doc, ranges[i].end_doc);
+        assert(part.get_documents_count() == static_cast<size_t>(ranges[i].end_doc - ranges[i].first_doc));
+        
+        // Рост словаря шарда посчитан по его собственным документам
+        auto growth = part.get_collection_statistics().growth;
+        assert(!growth.empty());
+        assert(growth.back().tokens == part.get_documents_count() * 3);
+        assert(growth.back().vocabulary == part.get_index_size());
+        for (size_t k = 1; k < growth.size(); ++k) {
+            assert(growth[k].tokens > growth[k - 1].tokens);
+            assert(growth[k].vocabulary >= growth[k - 1].vocabulary);
+        }
+        part.build_bigrams(2);
+        part.save_to_file(index_shards::shard_path(manifest, ranges[i]));
+    }
+    bool written = index_shards::write_manifest(manifest, ranges);
+    assert(written);
+    assert(index_shards::is_manifest(manifest));
+    assert(!index_shards::is_manifest(index_shards::shard_path(manifest, ranges[0])));
+    
+    ShardedIndex shards;
+    bool loaded = shards.load(manifest);
+    assert(loaded);
+    assert(shards.size() == 3 && shards.get_documents_count() == 100);
+    assert(shards.get_document_meta(55)->title == "lada 55");
+    assert(shards.get_document_meta(100) == nullptr);
+    
+    // Склейка шардов совпадает с поиском по целому индексу
+    index.build_doc_sets();
+    BoolSearch single(index);
+    ShardedSearch search(shards);
+    const char* queries[] = {"пробег", "toyota OR bmw", "с AND lada", "пробег NOT без",
+                             "\"с пробег\"", "\"без пробег\" AND bmw", "\"пробег с\""};
+    for (const char* query : queries) {
+        SearchResult expected = single.execute_query(query);
+        SearchResult result = search.execute_query(query);
+        assert(result.doc_ids == expected.doc_ids);
+        assert(result.total_found == expected.total_found);
+        
+        const auto& timings = search.last_timings();
+        assert(timings.size() == 3);
+        size_t found = 0;
+        for (const auto& t : timings) found += t.found;
+        assert(found == static_cast<size_t>(expected.total_found));
+    }
+    
+    // С ограничением собираются только первые документы, число найденных полное
+    SearchResult top = search.execute_query("пробег", 5);
+    assert(top.total_found == 100);
+    assert(top.doc_ids == std::vector<int>({0, 1, 2, 3, 4}));
+    for (const char* query : queries) {
+        SearchResult expected = single.execute_query(query);
+        for (size_t limit : {1, 7, 45, 200}) {
+            SearchResult result = search.execute_query(query, limit);
+            size_t keep = std::min<size_t>(limit, expected.doc_ids.size());
+            assert(result.total_found == expected.total_found);
+            assert(result.doc_ids == std::vector<int>(expected.doc_ids.begin(),
+                                                      expected.doc_ids.begin() + keep));
+        }
+    }
+    
+    // Шард отдаёт не больше limit документов, но считает все
+    BoolSearch first_shard(shards.shard(0));
+    SearchResult shard_top = first_shard.search_parsed(BoolSearch::parse_query("пробег"), nullptr, 3);
+    assert(shard_top.total_found == 40);
+    assert(shard_top.doc_ids == std::vector<int>({0, 1, 2}));
+    
+    QueryExplain explain;
+    search.execute_query("\"с пробег\" AND lada", 0, &explain);
+    assert(explain.steps.size() == 2);
+    assert(explain.steps[0].result_docs == 75 && explain.steps[1].result_docs == 25);
+    
+    // Имена шардов с каталогами не принимаются: оглавление не должно
+    // указывать на файлы вне своего каталога
+    const std::string bad_manifest = "test_sharded_search_bad.bin";
+    for (const char* name : {"../test_sharded_search.bin.shard0", "/etc/passwd", "sub/x.shard0",
+                             "..\\x.shard0", "..", ""}) {
+        std::vector<index_shards::Shard> bad = {{name, 0, 100}};
+        written = index_shards::write_manifest(bad_manifest, bad);
+        assert(written);
+        std::vector<index_shards::Shard> read;
+        bool accepted = index_shards::read_manifest(bad_manifest, read);
+        assert(!accepted && read.empty());
+    }
+    std::remove(bad_manifest.c_str());
+    
+    std::remove(manifest.c_str());
+    for (const auto& range : ranges) std::remove(index_shards::shard_path(manifest, range).c_str());
+    
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}
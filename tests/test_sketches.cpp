@@ -0,0 +1,95 @@
+#include "common/heavy_hitters.h"
+#include "common/hyperloglog.h"
+#include "common/frequency_counter.h"
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <cassert>
+
+int main() {
+    std::cout << "Тестирование SpaceSaving и HyperLogLog..." << std::endl;
+    
+    // Поток по закону Ципфа: слово ранга r встречается ~ 1/r раз
+    std::mt19937 rng(7);
+    std::vector<double> weights;
+    for (int r = 1; r <= 20000; ++r) weights.push_back(1.0 / r);
+    std::discrete_distribution<int> zipf(weights.begin(), weights.end());
+    
+    utils::SpaceSaving sketch(500);
+    utils::HyperLogLog unique;
+    utils::FrequencyCounter exact;
+    
+    for (int i = 0; i < 300000; ++i) {
+        std::string word = "w" + std::to_string(zipf(rng));
+        sketch.add(word);
+        unique.add(word);
+        exact.add(word);
+    }
+    
+    assert(sketch.total() == exact.total());
+    assert(sketch.size() == 500);
+    
+    // Границы Space-Saving выполняются для каждого отслеживаемого слова
+    auto top = sketch.sorted();
+    for (const auto& entry : top) {
+        uint64_t truth = exact.count(entry.key);
+        assert(entry.count >= truth);
+        assert(entry.count - entry.error <= truth);
+        assert(entry.error <= sketch.max_error());
+    }
+    
+    // Частые слова не теряются и идут в точном порядке
+    auto exact_top = exact.top_n(10);
+    for (size_t i = 0; i < exact_top.size(); ++i) {
+        assert(top[i].key == exact_top[i].first);
+    }
+    
+    double error = std::abs(static_cast<double>(unique.estimate()) - exact.size()) / exact.size();
+    assert(error < 4 * unique.standard_error());
+    
+    // Малые мощности считаются почти точно
+    utils::HyperLogLog small;
+    for (int i = 0; i < 100; ++i) small.add("k" + std::to_string(i % 50));
+    assert(small.estimate() >= 49 && small.estimate() <= 51);
+    
+    utils::HyperLogLog other;
+    for (int i = 50; i < 100; ++i) other.add("k" + std::to_string(i));
+    small.merge(other);
+    assert(small.estimate() >= 97 && small.estimate() <= 103);
+    
+    // Веса и пустые ключи
+    utils::SpaceSaving weighted(2);
+    weighted.add("a", 5);
+    weighted.add("b", 3);
+    weighted.add("c", 1);
+    weighted.add("");
+    auto entries = weighted.sorted();
+    assert(entries.size() == 2 && weighted.total() == 9);
+    assert(entries[0].key == "a" && entries[0].count == 5 && entries[0].error == 0);
+    assert(entries[1].key == "c" && entries[1].count == 4 && entries[1].error == 3);
+    
+    // Ёмкость ограничена с обеих сторон, иначе размер таблицы переполняется
+    assert(utils::SpaceSaving(0).get_capacity() == 1);
+    utils::SpaceSaving huge(static_cast<size_t>(-1));
+    assert(huge.get_capacity() == utils::SpaceSaving::MAX_CAPACITY);
+    huge.add("a");
+    assert(huge.sorted().size() == 1);
+    
+    // --approx K из командной строки; разбор вне assert, он пишет в capacity
+    size_t capacity = 7;
+    bool parsed = utils::SpaceSaving::parse_capacity("1000", capacity);
+    assert(parsed && capacity == 1000);
+    for (const char* bad : {"0", "-1", "abc", "10x", " 5", "+5", "", "18446744073709551615",
+                            "99999999999999999999999"}) {
+        parsed = utils::SpaceSaving::parse_capacity(bad, capacity);
+        assert(!parsed);
+    }
+    parsed = utils::SpaceSaving::parse_capacity(std::to_string(utils::SpaceSaving::MAX_CAPACITY), capacity);
+    assert(parsed && capacity == utils::SpaceSaving::MAX_CAPACITY);
+    parsed = utils::SpaceSaving::parse_capacity(std::to_string(utils::SpaceSaving::MAX_CAPACITY + 1), capacity);
+    assert(!parsed && capacity == utils::SpaceSaving::MAX_CAPACITY);
+    
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include "stemmer/stem_cache.h"
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <cassert>
+
+int main() {
+    std::cout << "Тестирование StemCache..." << std::endl;
+    
+    StemCache cache(4);
+    std::string_view stem;
+    
+    assert(!cache.lookup("машины", stem));
+    cache.insert("машины", "машин");
+    assert(cache.lookup("машины", stem) && stem == "машин");
+    
+    cache.insert("a1", "a");
+    cache.insert("a2", "a");
+    cache.insert("a3", "a");
+    assert(cache.size() == 4);
+    
+    // "машины" недавно читали, CLOCK вытесняет кого-то из остальных
+    cache.insert("a4", "a");
+    assert(cache.size() == 4);
+    assert(cache.get_statistics().evictions == 1);
+    assert(cache.lookup("машины", stem) && stem == "машин");
+    assert(cache.lookup("a4", stem));
+    
+    cache.insert(std::string(70, 'x'), "x");
+    assert(cache.get_statistics().bypassed == 1);
+    
+    ConcurrentStemCache shared(1024, 4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&shared] {
+            std::string value;
+            for (int i = 0; i < 2000; ++i) {
+                std::string key = "token" + std::to_string(i % 300);
+                if (shared.lookup(key, value)) {
+                    assert(value == key.substr(0, 5));
+                } else {
+                    shared.insert(key, key.substr(0, 5));
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    
+    auto stats = shared.get_statistics();
+    assert(stats.hits + stats.misses == 8000);
+    assert(stats.hits > 0);
+    
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}
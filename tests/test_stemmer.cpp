@@ -1,7 +1,32 @@
 #include "stemmer/stemmer.h"
+#include "common/thread_pool.h"
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdio>
+#include <algorithm>
 #include <cassert>
 
+static std::string read_file(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    std::ostringstream content;
+    content << in.rdbuf();
+    return content.str();
+}
+
+// Стемминг корпуса при заданном числе потоков и ёмкости кэша
+static std::string stem_with(int threads, size_t cache_entries,
+                             const std::string& input, const std::string& output) {
+    utils::ThreadPool::configure_shared(threads);
+    Stemmer stemmer(cache_entries);
+    bool stemmed = stemmer.stem_corpus(input, output);
+    assert(stemmed);
+    std::string result = read_file(output);
+    std::remove(output.c_str());
+    return result;
+}
+
 int main() {
     std::cout << "Тестирование Stemmer..." << std::endl;
     
@@ -13,6 +38,48 @@ int main() {
     stem = stemmer.stem_token("машины");
     assert(!stem.empty());
     
+    assert(stemmer.stem_token("автомобиль") == "автомобил");
+    assert(stemmer.stem_token("АВТОМОБИЛЬ") == "автомобил");
+    assert(stemmer.stem_token("дорога") == "дорог");
+    assert(stemmer.stem_token("дороги") == "дорог");
+    assert(stemmer.stem_token("дорогой") == "дорог");
+    assert(stemmer.stem_token("красивейший") == "красив");
+    assert(stemmer.stem_token("toyota") == "toyota");
+    
+    // Несколько порций по 1024 строки: вывод с --threads N совпадает с
+    // однопоточным байт в байт, в том числе когда маленький кэш вытесняет
+    const std::string input = "test_stemmer_tokens.txt";
+    {
+        const char* words[] = {"автомобиль", "машины", "дорога", "дороги", "дорогой",
+                               "красивейший", "toyota", "running", "пробегом", "пробег"};
+        std::ofstream out(input);
+        for (int doc = 0; doc < 3000; ++doc) {
+            out << doc << "|avito|Объявление " << doc << "|";
+            for (int k = 0; k < 12; ++k) {
+                if (k > 0) out << ' ';
+                out << words[(doc * 7 + k * 3) % 10];
+                if ((doc + k) % 5 == 0) out << "ами" << doc % 97;
+            }
+            out << "\n";
+        }
+    }
+    
+    std::string single = stem_with(1, 65536, input, "test_stemmer_1.txt");
+    assert(!single.empty());
+    assert(std::count(single.begin(), single.end(), '\n') == 3000);
+    assert(stem_with(4, 65536, input, "test_stemmer_4.txt") == single);
+    assert(stem_with(3, 16, input, "test_stemmer_3.txt") == single);
+    assert(stem_with(4, 0, input, "test_stemmer_0.txt") == single);
+    
+    // Ошибки входа и записи выхода не выдаются за успех
+    bool stemmed = stemmer.stem_corpus("test_stemmer_missing.txt", "test_stemmer_x.txt");
+    assert(!stemmed);
+    if (std::ofstream("/dev/full").is_open()) {
+        stemmed = stemmer.stem_corpus(input, "/dev/full");
+        assert(!stemmed);
+    }
+    std::remove(input.c_str());
+    
     std::cout << "Все тесты пройдены!" << std::endl;
     return 0;
 }
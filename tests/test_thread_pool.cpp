@@ -0,0 +1,117 @@
+#include "common/thread_pool.h"
+#include "common/ordered_pipeline.h"
+#include <iostream>
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include <cassert>
+
+// Сумма 1..n рекурсивным делением пополам: проверяет вложенные группы
+uint64_t nested_sum(utils::ThreadPool& pool, uint64_t lo, uint64_t hi) {
+    if (hi - lo <= 1000) {
+        uint64_t sum = 0;
+        for (uint64_t i = lo; i < hi; ++i) sum += i;
+        return sum;
+    }
+    uint64_t mid = lo + (hi - lo) / 2;
+    uint64_t left = 0;
+    utils::TaskGroup group(pool);
+    group.run([&] { left = nested_sum(pool, lo, mid); });
+    uint64_t right = nested_sum(pool, mid, hi);
+    group.wait();
+    return left + right;
+}
+
+int main() {
+    std::cout << "Тестирование ThreadPool..." << std::endl;
+
+    for (int threads : {1, 4}) {
+        utils::ThreadPool pool(threads);
+        assert(pool.size() == static_cast<size_t>(threads));
+        assert(pool.current_worker() == pool.size());
+
+        // Каждый индекс обрабатывается ровно один раз
+        std::vector<int> hits(100000, 0);
+        pool.parallel_for(0, hits.size(), 64, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi; ++i) hits[i]++;
+        });
+        for (int h : hits) assert(h == 1);
+
+        pool.parallel_for(5, 5, 1, [](size_t, size_t) { assert(false); });
+
+        assert(nested_sum(pool, 0, 1000000) == 999999ull * 1000000 / 2);
+
+        // Номер потока внутри задачи — номер рабочего потока пула. Задачи,
+        // которые wait() выполнил в вызывающем потоке через run_pending,
+        // получают size(), как любой поток не из пула
+        std::atomic<int> bad_worker{0};
+        const std::thread::id caller = std::this_thread::get_id();
+        {
+            utils::TaskGroup group(pool);
+            for (int i = 0; i < 100; ++i) {
+                group.run([&] {
+                    size_t w = pool.current_worker();
+                    bool on_caller = std::this_thread::get_id() == caller;
+                    if (on_caller ? w != pool.size() : w >= pool.size()) bad_worker++;
+                });
+            }
+            group.wait();
+        }
+        assert(bad_worker == 0);
+        
+        // Вызывающий поток сам забирает задачу из очереди
+        {
+            std::atomic<bool> ran_on_caller{false};
+            utils::TaskGroup group(pool);
+            std::atomic<bool> release{false};
+            std::atomic<int> blocked{0};
+            // Все рабочие потоки заняты, следующую задачу может выполнить только вызывающий
+            for (int t = 0; t < threads; ++t) {
+                group.run([&] {
+                    blocked++;
+                    while (!release) std::this_thread::yield();
+                });
+            }
+            while (blocked < threads) std::this_thread::yield();
+            group.run([&] {
+                ran_on_caller = std::this_thread::get_id() == caller &&
+                                pool.current_worker() == pool.size();
+            });
+            while (!ran_on_caller) {
+                if (!pool.run_pending()) std::this_thread::yield();
+            }
+            release = true;
+            group.wait();
+        }
+
+        // Порядок записи совпадает с порядком чтения
+        int next_input = 0;
+        std::vector<int> written;
+        utils::run_ordered_pipeline<int, int>(
+            pool, 8,
+            [&](int& input) {
+                if (next_input == 1000) return false;
+                input = next_input++;
+                return true;
+            },
+            [&](int worker, int& input, int& output) {
+                assert(worker >= 0 && worker < static_cast<int>(pool.size()));
+                output = input * 2;
+            },
+            [&](int& output) { written.push_back(output); });
+        assert(written.size() == 1000);
+        for (int i = 0; i < 1000; ++i) assert(written[i] == 2 * i);
+
+        uint64_t tasks = 0;
+        for (const auto& stats : pool.get_statistics()) {
+            tasks += stats.tasks;
+            assert(stats.busy_ms >= 0 && stats.idle_ms >= 0);
+        }
+        // Порции конвейера выполняют только рабочие потоки
+        if (threads > 1) assert(tasks >= 1000);
+    }
+
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "tokenizer/token_scanner.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <random>
+#include <cassert>
+
+// Дифференциальная проверка: векторные варианты должны давать ровно тот же
+// текст в нижнем регистре и те же токены, что и скалярный
+static size_t check_same(const std::string& text, token_scanner::Backend backend) {
+    std::string expected_buf(text.size(), '\0');
+    std::string actual_buf(text.size(), '\0');
+    std::vector<std::string_view> expected;
+    std::vector<std::string_view> actual;
+    
+    token_scanner::scan(text, &expected_buf[0], expected, token_scanner::Backend::SCALAR);
+    token_scanner::scan(text, &actual_buf[0], actual, backend);
+    
+    assert(expected_buf == actual_buf);
+    assert(expected.size() == actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        assert(expected[i] == actual[i]);
+        assert(expected[i].data() - expected_buf.data() == actual[i].data() - actual_buf.data());
+    }
+    return expected.size();
+}
+
+static std::string random_text(std::mt19937& rng, size_t length) {
+    static const char* pieces[] = {
+        "a", "Z", "q", "7", "0", "-", "'", " ", " ", ".", ",", "|", "\n",
+        "BMW", "x5", "ж", "Ё", "Я", "ё", "é", "\xD0", "\x80", "\xFF", "€"
+    };
+    const size_t count = sizeof(pieces) / sizeof(pieces[0]);
+    
+    std::string text;
+    while (text.size() < length) {
+        text += pieces[rng() % count];
+    }
+    return text;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "Тестирование token_scanner..." << std::endl;
+    
+    const token_scanner::Backend backends[] = {
+        token_scanner::Backend::SSE2, token_scanner::Backend::AVX2
+    };
+    
+    std::mt19937 rng(42);
+    std::vector<std::string> inputs = {
+        "",
+        "a",
+        "ab",
+        "Toyota Camry 2.5 AT, 2019 -- пробег 45 000 км",
+        std::string(15, 'x') + "Ж" + std::string(40, 'y'),
+        std::string(31, ' ') + "AB" + std::string(31, 'c'),
+    };
+    for (size_t len = 0; len < 200; ++len) {
+        inputs.push_back(random_text(rng, len));
+    }
+    
+    std::string corpus_file = argc >= 2 ? argv[1] : "data/processed/stems.txt";
+    std::ifstream in(corpus_file);
+    std::string line;
+    size_t corpus_lines = 0;
+    while (std::getline(in, line)) {
+        inputs.push_back(line);
+        corpus_lines++;
+    }
+    
+    for (auto backend : backends) {
+        if (!token_scanner::is_supported(backend)) {
+            std::cout << "  " << token_scanner::backend_name(backend) << ": не поддерживается" << std::endl;
+            continue;
+        }
+        
+        size_t tokens = 0;
+        for (const auto& text : inputs) {
+            tokens += check_same(text, backend);
+        }
+        std::cout << "  " << token_scanner::backend_name(backend) << ": " << inputs.size()
+                  << " строк (" << corpus_lines << " из корпуса), " << tokens << " токенов совпали" << std::endl;
+    }
+    
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}
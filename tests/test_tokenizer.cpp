@@ -13,6 +13,15 @@ int main() {
     tokens = tokenizer.tokenize("BMW X5 2023");
     assert(tokens.size() >= 2);
     
+    tokens = tokenizer.tokenize("АВТОМОБИЛЬ Ёлка Mercedes-Benz");
+    assert(tokens.size() == 3);
+    assert(tokens[0] == "автомобиль");
+    assert(tokens[1] == "ёлка");
+    assert(tokens[2] == "mercedes-benz");
+    
+    tokens = tokenizer.tokenize("я в BMW");
+    assert(tokens.size() == 1 && tokens[0] == "bmw");
+    
     std::cout << "Все тесты пройдены!" << std::endl;
     return 0;
 }
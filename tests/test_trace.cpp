@@ -0,0 +1,67 @@
+#include "common/trace.h"
+#include "common/thread_pool.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdio>
+#include <cassert>
+
+int main() {
+    std::cout << "Тестирование trace..." << std::endl;
+
+    // Корзины: до 16 точные, дальше погрешность не больше 1/16
+    for (uint64_t v = 0; v < 16; ++v) {
+        assert(trace::Histogram::bucket_of(v) == v);
+    }
+    for (uint64_t v : {16ull, 17ull, 31ull, 32ull, 1000ull, 123456789ull, ~0ull}) {
+        size_t b = trace::Histogram::bucket_of(v);
+        uint64_t upper = trace::Histogram::bucket_upper(b);
+        assert(b < trace::Histogram::BUCKETS);
+        assert(upper >= v && upper - v <= v / 16);
+        if (b > 0) assert(trace::Histogram::bucket_upper(b - 1) < v);
+    }
+
+    trace::Histogram& latency = trace::histogram("test_latency_us", "Тестовая задержка");
+    for (uint64_t v = 1; v <= 1000; ++v) latency.record(v);
+    assert(latency.count() == 1000 && latency.sum() == 500500 && latency.max() == 1000);
+    uint64_t median = latency.percentile(0.5);
+    assert(median >= 500 && median <= 500 + 500 / 16);
+    assert(latency.percentile(1.0) == 1000);
+    assert(&trace::histogram("test_latency_us") == &latency);
+
+    trace::Counter& events = trace::counter("test_events_total");
+    utils::ThreadPool pool(4);
+    trace::set_enabled(true);
+    pool.parallel_for(0, 4000, 1, [&](size_t lo, size_t hi) {
+        trace::Span span("test_piece");
+        events.add(hi - lo);
+    });
+    {
+        trace::Span span("test_outer");
+        assert(span.elapsed_ms() >= 0);
+    }
+    trace::set_enabled(false);
+    { trace::Span span("test_disabled"); }
+    assert(events.get() == 4000);
+
+    std::ostringstream metrics;
+    trace::write_metrics(metrics);
+    std::string text = metrics.str();
+    assert(text.find("# TYPE test_events_total counter\ntest_events_total 4000\n") != std::string::npos);
+    assert(text.find("test_latency_us_bucket{le=\"+Inf\"} 1000\n") != std::string::npos);
+    assert(text.find("test_latency_us_count 1000\n") != std::string::npos);
+
+    const std::string filename = "test_trace.json";
+    assert(trace::write_chrome_trace(filename));
+    std::ifstream in(filename);
+    std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    assert(json.find("\"traceEvents\"") != std::string::npos);
+    assert(json.find("\"test_piece\"") != std::string::npos);
+    assert(json.find("\"test_outer\"") != std::string::npos);
+    assert(json.find("\"test_disabled\"") == std::string::npos);
+    std::remove(filename.c_str());
+
+    std::cout << "Все тесты пройдены!" << std::endl;
+    return 0;
+}